@@ -2688,7 +2688,7 @@ void analysis( bool mc )
 									catch { cd $path_res } \
 								}" );
 
-							cmd( "set lab [ tk_getOpenFile -parent .da -title \"Load Results File%s\" -multiple yes -initialdir \"$path_res\" -defaultextension .res.gz -filetypes { %s { {All files} {*} } } -typevariable defaultFileType ]", mc ? "s" : "(s)", platform == _MAC_ ? "" : "{ {LSD result files} {.res.gz .res} } { {LSD total files} {.tot .tot.gz} }" );
+							cmd( "set lab [ tk_getOpenFile -parent .da -title \"Load Results File%s\" -multiple yes -initialdir \"$path_res\" -defaultextension .res.gz -filetypes { %s { {All files} {*} } } -typevariable defaultFileType ]", mc ? "s" : "(s)", platform == _MAC_ ? "" : "{ {LSD result files} {.res.gz .res ." RES_BIN_EXT "} } { {LSD total files} {.tot .tot.gz} }" );
 							cmd( "if { ! [ fn_spaces \"$lab\" .da 1 ] } { set choice [ llength $lab ] } { set choice 0 }" );
 							h = choice;		// number of files
 
@@ -4534,8 +4534,7 @@ void count_labels_mem( object *r, int *count, const char *lab )
 				count_labels_mem( cur, count, lab );
 
 	if ( r->up == NULL && lab == NULL )
-		for ( cv = cemetery; cv != NULL; cv = cv->next )
-			++( *count );
+		*count += cemetery.graves.size( );
 }
 
 
@@ -4582,15 +4581,18 @@ void insert_labels_mem( object *r, int *num_v, const char *lab )
 				insert_labels_mem( cur, num_v, lab );
 
 	if ( r->up == NULL && lab == NULL )
-		for ( cv = cemetery; cv != NULL && ! stop; cv = cv->next )
+		for ( auto &cg : cemetery.graves )
 		{
-			cmd( "add_series \"%s %s (%d-%d) #%d\" %s", cv->label, cv->lab_tit, cv->start, cv->end, *num_v, par_map[ cv->label ].c_str( ) );
+			if ( stop )
+				break;
 
-			if ( cv->end > num_c )
-				num_c = cv->end;
+			cmd( "add_series \"%s %s (%d-%d) #%d\" %s", cg.label, cg.lab_tit, cg.start, cg.end, *num_v, par_map[ cg.label ].c_str( ) );
 
-			if ( cv->start < first_c )
-				first_c = cv->start;
+			if ( cg.end > num_c )
+				num_c = cg.end;
+
+			if ( cg.start < first_c )
+				first_c = cg.start;
 
 			if ( ++( *num_v ) % PROG_SERIES == 0 )
 				cmd( "prgboxupdate .da.ser %d", *num_v - 1 );
@@ -4632,9 +4634,9 @@ void insert_store_mem( object *r, int max_v, int *num_v, const char *lab )
 			strcpyn( vs[ *num_v ].label, cv->label, MAX_ELEM_LENGTH );
 			snprintf( vs[ *num_v ].tag, MAX_ELEM_LENGTH, "%s%s", tag_pref, cv->lab_tit );
 			vs[ *num_v ].start = cv->start;
-			vs[ *num_v ].end = cv->end;
+			vs[ *num_v ].end = running ? min( cv->end, t - 1 ) : cv->end;	// if paused
 			vs[ *num_v ].rank = *num_v;
-			vs[ *num_v ].data = cv->data;
+			vs[ *num_v ].data = cv->data_ptr( );
 			++( *num_v );
 		}
 
@@ -4644,19 +4646,130 @@ void insert_store_mem( object *r, int max_v, int *num_v, const char *lab )
 				insert_store_mem( cur, max_v, num_v, lab );
 
 	if ( r->up == NULL && lab == NULL )
-		for ( cv = cemetery; cv != NULL && *num_v < max_v; cv = cv->next )
+		for ( auto &cg : cemetery.graves )
 		{
-			strcpyn( vs[ *num_v ].label, cv->label, MAX_ELEM_LENGTH );
-			strcpyn( vs[ *num_v ].tag, cv->lab_tit, MAX_ELEM_LENGTH );
-			vs[ *num_v ].start = cv->start;
-			vs[ *num_v ].end = cv->end;
+			if ( *num_v >= max_v )
+				break;
+
+			strcpyn( vs[ *num_v ].label, cg.label, MAX_ELEM_LENGTH );
+			strcpyn( vs[ *num_v ].tag, cg.lab_tit, MAX_ELEM_LENGTH );
+			vs[ *num_v ].start = cg.start;
+			vs[ *num_v ].end = cg.end;
 			vs[ *num_v ].rank = *num_v;
-			vs[ *num_v ].data = cv->data;
+			vs[ *num_v ].data = cg.data_ptr( );
 			++( *num_v );
 		}
 }
 
 
+/***************************************************
+INSERT_DATA_BIN
+Load a binary columnar results file (memory mapped)
+****************************************************/
+void insert_data_bin( int *num_v, vector < string > *var_names, bool keep_vars )
+{
+	char *tag;
+	int i, j, n, new_v, new_c;
+	const res_bin_ser *ser;
+	res_bin rb( filename );
+	store *app;
+
+	if ( ! rb.ok( ) )
+	{
+		plog( "\nError: invalid binary results file, aborting file load\n" );
+		return;
+	}
+
+	new_v = rb.series( );
+	new_c = rb.last( ) + 1;
+
+	plog( "\nResults data from file %s (F_%d) ", filename, file_counter );
+	plog( "%d series",	new_v );
+	cmd( ".da.pas.main.p2.scale configure -maximum %d", new_v );
+
+	if ( *num_v == 0 )
+		vs = new store[ new_v ];
+	else
+	{
+		app = new store[ new_v + *num_v ];
+		for ( i = 0; i < *num_v; ++i )
+		{
+			app[ i ] = vs[ i ];
+			strcpy( app[ i ].label, vs[ i ].label );
+			strcpy( app[ i ].tag, vs[ i ].tag );
+		}
+
+		delete [ ] vs;
+		vs = app;
+	}
+
+	for ( first_c = 1, i = *num_v, j = 0; j < new_v && ! stop; ++i, ++j )
+	{
+		ser = rb.info( j );
+		n = max( ser->end - ser->start + 1, 0 );
+
+		strcpyn( vs[ i ].label, rb.label( j ), MAX_ELEM_LENGTH );
+		vs[ i ].start = ser->start;
+		vs[ i ].end = ser->start + n - 1;
+		vs[ i ].rank = i;
+
+		tag = new char [ strlen( rb.tag( j ) ) + 10 ];
+		sprintf( tag, "F_%d_%s", file_counter, rb.tag( j ) );
+		strcpyn( vs[ i ].tag, tag, MAX_ELEM_LENGTH );
+		delete [ ] tag;
+
+		vs[ i ].data = new double[ max( n, 1 ) ];
+
+		if ( ! rb.read( j, vs[ i ].data ) )
+		{
+			plog( "\nWarning: invalid data in series %s %s, values not available", rb.label( j ), rb.tag( j ) );
+			fill( vs[ i ].data, vs[ i ].data + n, NAN );
+		}
+
+		if ( vs[ i ].start <= 0 && vs[ i ].end >= 0 && ! is_nan( vs[ i ].data[ - vs[ i ].start ] ) )
+			first_c = 0;				// at least one lagged variable
+
+		snprintf( da_tmp, MAX_BUFF_SIZE, "%s %s (%d-%d) #%d", vs[ i ].label, vs[ i ].tag, vs[ i ].start, vs[ i ].end, i );
+		var_names->push_back( da_tmp );
+
+		if ( keep_vars )
+		{
+			cmd( "if { ! [ dict exists serDescrDict %s ] } { \
+					dict set serDescrDict %s \"Loaded from file\n[ file nativename %s ]\" \
+				}", vs[ i ].label, vs[ i ].label, filename );
+
+			if ( par_map.find( vs[ i ].label ) == par_map.end( ) )
+				cmd( "add_series \"%s\" %s", da_tmp, filename );
+			else
+				cmd( "add_series \"%s\" %s", da_tmp, par_map[ vs[ i ].label ].c_str( ) );
+		}
+
+		if ( ( j + 2 ) % 1000 == 0 )
+			cmd( "prgboxupdate .da.pas \"\" %d", j + 1 );
+	}
+
+	cmd( "prgboxupdate .da.pas \"\" %d", j );
+
+	if ( stop )
+	{
+		new_v = j;
+		stop = false;
+	}
+
+	*num_v += new_v;
+
+	--new_c;
+
+	if ( new_c > num_c )
+		num_c = new_c;
+
+	if ( new_c > max_c )
+		max_c = new_c;
+
+	min_c = max( first_c, showInit ? 0 : 1 );
+}
+
+
 /***************************************************
 INSERT_DATA_FILE
 ****************************************************/
@@ -4670,6 +4783,12 @@ void insert_data_file( bool gz, int *num_v, vector < string > *var_names, bool k
 	long linsiz = 1;
 	store *app;
 
+	if ( strlen( filename ) > strlen( "." RES_BIN_EXT ) && ! strcmp( &filename[ strlen( filename ) - strlen( "." RES_BIN_EXT ) ], "." RES_BIN_EXT ) )
+	{
+		insert_data_bin( num_v, var_names, keep_vars );
+		return;
+	}
+
 	if ( ! gz )
 		f = fopen( filename, "rt" );
 	else
@@ -8268,7 +8387,7 @@ int numcol = 16;
 
 void save_datazip( void )
 {
-	char **str, **tag, delimiter[ 10 ], misval[ 10 ], labprefix[ MAX_ELEM_LENGTH ];
+	char **str, **tag, delimiter[ 10 ], misval[ 10 ], labprefix[ MAX_ELEM_LENGTH ], num[ MAX_ELEM_LENGTH ];
 	const char *desc, *ext;
 	double **data;
 	int i, j, fr, typelab, del, type_res, *start, *end, *id, headprefix = 0;
@@ -8638,7 +8757,10 @@ void save_datazip( void )
 				for ( i = 0; i < nv; ++i )
 				{
 					if ( j >= start[ i ] && j <= end[ i ] && ! is_nan( data[ i ][ j - start[ i ] ] ) )		// write NaN as n/a
-						gzprintf( fsavez, "%.*G", SIG_DIG, data[ i ][ j - start[ i ] ] );
+					{
+						strnum( num, data[ i ][ j - start[ i ] ], SIG_DIG, 'G', MAX_ELEM_LENGTH );
+						gzputs( fsavez, num );
+					}
 					else
 						gzprintf( fsavez, "%s", misval );
 
@@ -8656,7 +8778,10 @@ void save_datazip( void )
 				for ( i = 0; i < nv; ++i )
 				{
 					if ( j >= start[ i ] && j <= end[ i ] && ! is_nan( data[ i ][ j - start[ i ] ] ) )		// write NaN as n/a
-						fprintf( fsave, "%.*G", SIG_DIG, data[ i ][ j - start[ i ] ] );
+					{
+						strnum( num, data[ i ][ j - start[ i ] ], SIG_DIG, 'G', MAX_ELEM_LENGTH );
+						fputs( num, fsave );
+					}
 					else
 						fprintf( fsave, "%s", misval );
 
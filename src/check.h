@@ -155,6 +155,12 @@ double bad_ptr_dbl( object *ptr, const char *file, int line )
 	return 0.;
 }
 
+double *bad_ptr_arr( object *ptr, const char *file, int line )
+{
+	bad_ptr_dbl( ptr, file, line );
+	return NULL;
+}
+
 char *bad_ptr_chr( object *ptr, const char *file, int line )
 {
 	bad_ptr_dbl( ptr, file, line );
@@ -1495,6 +1495,380 @@ int kill_system( int id )
 
 #endif
 
+/****************************************************
+ RES_BIN
+ Memory-mapped reader of binary columnar results
+ files: a header, each series values in chunks of
+ RES_BIN_CHUNK values (optionally compressed), each
+ followed by its chunk table, and at the end the
+ series directory (label, tag, start, end, table)
+ and the table of (null-terminated) names;
+ compressed chunks have the values bytes grouped by
+ position (all first bytes, then all second...)
+ ****************************************************/
+res_bin::res_bin( const char *fname )
+{
+	size_t i, n;
+
+	map = NULL;
+	len = 0;
+	names = NULL;
+	head = NULL;
+	dir = NULL;
+
+#ifdef _WIN32
+	HANDLE fh, mh;
+	LARGE_INTEGER sz;
+
+	fh = CreateFileA( fname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( fh == INVALID_HANDLE_VALUE )
+		return;
+
+	if ( GetFileSizeEx( fh, & sz ) && sz.QuadPart >= ( LONGLONG ) sizeof( res_bin_head ) )
+	{
+		mh = CreateFileMappingA( fh, NULL, PAGE_READONLY, 0, 0, NULL );
+		if ( mh != NULL )
+		{
+			map = ( char * ) MapViewOfFile( mh, FILE_MAP_READ, 0, 0, 0 );
+			len = map != NULL ? ( size_t ) sz.QuadPart : 0;
+			CloseHandle( mh );			// view keeps the mapping alive
+		}
+	}
+
+	CloseHandle( fh );
+#else
+	int fd;
+	struct stat st;
+	void *p;
+
+	fd = open( fname, O_RDONLY );
+	if ( fd < 0 )
+		return;
+
+	if ( fstat( fd, & st ) == 0 && st.st_size >= ( off_t ) sizeof( res_bin_head ) )
+	{
+		p = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		if ( p != MAP_FAILED )
+		{
+			map = ( char * ) p;
+			len = st.st_size;
+		}
+	}
+
+	close( fd );
+#endif
+
+	if ( map == NULL )
+		return;
+
+	head = ( const res_bin_head * ) map;
+	n = ( size_t ) head->series * sizeof( res_bin_ser );
+
+	if ( memcmp( head->magic, RES_BIN_MAGIC, sizeof( head->magic ) ) || head->version != RES_BIN_VER ||
+		 head->order != RES_BIN_ORDER || head->chunk == 0 || head->dir % 8 != 0 ||
+		 head->last < head->first - 1 ||
+		 head->dir > len || n > len - head->dir || head->names > len ||
+		 head->names_size == 0 || head->names_size > len - head->names ||
+		 map[ head->names + head->names_size - 1 ] != '\0' )
+	{
+		head = NULL;					// not a valid file
+		return;
+	}
+
+	dir = ( const res_bin_ser * ) ( map + head->dir );
+	names = map + head->names;
+
+	for ( i = 0; i < head->series; ++i )
+		if ( dir[ i ].label >= head->names_size || dir[ i ].tag >= head->names_size ||
+			 dir[ i ].start < head->first || dir[ i ].end > head->last ||
+			 dir[ i ].end < dir[ i ].start - 1 )
+		{
+			head = NULL;
+			return;
+		}
+}
+
+
+res_bin::~res_bin( void )
+{
+	if ( map == NULL )
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile( map );
+#else
+	munmap( map, len );
+#endif
+}
+
+
+/****************************************************
+ READ
+ read all the values of series i into data, which
+ must hold end - start + 1 values
+ ****************************************************/
+bool res_bin::read( int i, double *data ) const
+{
+	int b, c, chunks, j, m, n;
+	uLongf sz;
+	vector < Bytef > buf;
+	const res_bin_chk *tab;
+	const res_bin_ser *s;
+
+	if ( head == NULL || i < 0 || i >= ( int ) head->series )
+		return false;
+
+	s = & dir[ i ];
+	n = max( s->end - s->start + 1, 0 );
+	chunks = ( n + head->chunk - 1 ) / head->chunk;
+
+	if ( s->chunks % 8 != 0 || s->chunks > len || chunks * sizeof( res_bin_chk ) > len - s->chunks )
+		return false;
+
+	tab = ( const res_bin_chk * ) ( map + s->chunks );
+
+	for ( c = 0; c < chunks; ++c, data += m )
+	{
+		m = min( ( int ) head->chunk, n - c * ( int ) head->chunk );
+		sz = m * sizeof( double );
+
+		if ( tab[ c ].pos > len || tab[ c ].size > len - tab[ c ].pos )
+			return false;
+
+		if ( tab[ c ].zip )
+		{
+			buf.resize( sz );
+
+			if ( uncompress( buf.data( ), & sz, ( const Bytef * ) map + tab[ c ].pos, tab[ c ].size ) != Z_OK || sz != m * sizeof( double ) )
+				return false;
+
+			// regroup the bytes of each value
+			for ( j = 0; j < m; ++j )
+				for ( b = 0; b < ( int ) sizeof( double ); ++b )
+					( ( Bytef * ) ( data + j ) )[ b ] = buf[ b * m + j ];
+		}
+		else
+		{
+			if ( tab[ c ].size != sz )
+				return false;
+
+			memcpy( data, map + tab[ c ].pos, sz );
+		}
+	}
+
+	return true;
+}
+
+
+/****************************************************
+ SAVE_MAP
+ Temporary file in directory dir, mapped into
+ memory in segments of (at least) SAVE_MAP_SEG bytes,
+ to hold the saved series of a simulation run, so
+ the operating system can page them out to disk;
+ space is just reserved and never reused, the file
+ is deleted when closed
+ ****************************************************/
+save_map::save_map( const char *dir )
+{
+	next = NULL;
+	left = len = 0;
+
+#ifdef _WIN32
+	char fname[ MAX_PATH ];
+
+	fh = INVALID_HANDLE_VALUE;
+
+	if ( GetTempFileNameA( dir, "lsd", 0, fname ) == 0 )
+		return;
+
+	fh = CreateFileA( fname, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL );
+#else
+	string fname = string( dir ) + "/lsdXXXXXX";
+
+	fd = mkstemp( & fname[ 0 ] );
+
+	if ( fd >= 0 )
+		unlink( fname.c_str( ) );		// removed when closed
+#endif
+}
+
+
+save_map::~save_map( void )
+{
+	vector < pair < char *, size_t > >::iterator it;
+
+	for ( it = segs.begin( ); it != segs.end( ); ++it )
+#ifdef _WIN32
+		UnmapViewOfFile( it->first );
+
+	if ( fh != INVALID_HANDLE_VALUE )
+		CloseHandle( fh );
+#else
+		munmap( it->first, it->second );
+
+	if ( fd >= 0 )
+		close( fd );
+#endif
+}
+
+
+bool save_map::ok( void ) const
+{
+#ifdef _WIN32
+	return fh != INVALID_HANDLE_VALUE;
+#else
+	return fd >= 0;
+#endif
+}
+
+
+/****************************************************
+ ALLOC
+ reserve size bytes in the file, extending it by a
+ new segment when the current one is exhausted
+ ****************************************************/
+void *save_map::alloc( size_t size )
+{
+	size_t seg;
+	char *p;
+
+	if ( ! ok( ) || size == 0 )
+		return NULL;
+
+	size = ( size + SAVE_MAP_ALIGN - 1 ) / SAVE_MAP_ALIGN * SAVE_MAP_ALIGN;
+
+#ifndef _NP_
+	lock_guard < mutex > lck( lock );
+#endif
+
+	if ( size > left )
+	{
+		seg = ( size + SAVE_MAP_SEG - 1 ) / SAVE_MAP_SEG * SAVE_MAP_SEG;
+
+#ifdef _WIN32
+		HANDLE mh;
+		uint64_t end = ( uint64_t ) len + seg;
+
+		// the mapping object extends the file to its size
+		mh = CreateFileMappingA( fh, NULL, PAGE_READWRITE, ( DWORD ) ( end >> 32 ), ( DWORD ) end, NULL );
+		if ( mh == NULL )
+			return NULL;
+
+		p = ( char * ) MapViewOfFile( mh, FILE_MAP_WRITE, ( DWORD ) ( ( uint64_t ) len >> 32 ), ( DWORD ) len, seg );
+		CloseHandle( mh );				// view keeps the mapping alive
+
+		if ( p == NULL )
+			return NULL;
+#else
+		void *m;
+
+		// reserve the disk space to avoid failing when pages are written
+#ifdef __linux__
+		if ( posix_fallocate( fd, len, seg ) != 0 )
+#else
+		if ( ftruncate( fd, len + seg ) != 0 )
+#endif
+			return NULL;
+
+		m = mmap( NULL, seg, PROT_READ | PROT_WRITE, MAP_SHARED, fd, len );
+		if ( m == MAP_FAILED )
+			return NULL;
+
+		p = ( char * ) m;
+#endif
+		segs.push_back( make_pair( p, seg ) );
+		len += seg;
+		next = p;
+		left = seg;
+	}
+
+	p = next;
+	next += size;
+	left -= size;
+
+	return p;
+}
+
+
+#ifndef _NP_
+
+/****************************************************
+ PRG_MAP
+ Shared-memory segment with the progress of each run
+ in a set of parallel runs, created by the process
+ launching the runs and opened by each run instance
+ using the same (unique) base name, so the runs can
+ be monitored without reading the log files
+ ****************************************************/
+prg_map::prg_map( const char *base, int runs, bool create )
+{
+	map = NULL;
+	len = ( size_t ) max( runs, 1 ) * sizeof( run_prg );
+	owner = false;
+
+#ifdef _WIN32
+	HANDLE mh;
+
+	name = string( "Local\\" ) + base;
+
+	if ( create )
+		mh = CreateFileMappingA( INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, ( DWORD ) len, name.c_str( ) );
+	else
+		mh = OpenFileMappingA( FILE_MAP_WRITE, FALSE, name.c_str( ) );
+
+	if ( mh == NULL )
+		return;
+
+	map = ( run_prg * ) MapViewOfFile( mh, FILE_MAP_WRITE, 0, 0, len );
+	CloseHandle( mh );					// view keeps the mapping alive
+#else
+	int fd;
+	void *m;
+
+	name = string( "/" ) + base;
+
+	fd = shm_open( name.c_str( ), create ? O_CREAT | O_EXCL | O_RDWR : O_RDWR, 0600 );
+	if ( fd < 0 )
+		return;
+
+	owner = create;
+
+	if ( create && ftruncate( fd, len ) != 0 )
+	{
+		close( fd );
+		return;
+	}
+
+	m = mmap( NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	close( fd );						// mapping stays valid
+
+	if ( m != MAP_FAILED )
+		map = ( run_prg * ) m;
+#endif
+
+	if ( map != NULL && create )
+		memset( map, 0, len );
+}
+
+
+prg_map::~prg_map( void )
+{
+#ifdef _WIN32
+	if ( map != NULL )
+		UnmapViewOfFile( map );
+#else
+	if ( map != NULL )
+		munmap( map, len );
+
+	if ( owner )
+		shm_unlink( name.c_str( ) );
+#endif
+}
+
+#endif
+
+
 /****************************************************
  CLEAN_FILE
  remove any path prefixes to filename, if present
@@ -2071,3 +2445,148 @@ void exception_handler( int signum, const char *what )
 
 	myexit( -signum );				// abort program
 }
+
+
+/***************************************************
+ STRNUM
+ format a number like printf's '%.<prec>g', '%.<prec>G'
+ or '%.<prec>f' conversions (conv = 'g', 'G' or 'f'),
+ scaling by an exact power of 10 and rounding the
+ integer digits directly, falling back to snprintf
+ when the value is out of range or too close to a
+ rounding tie to be decided safely
+ ***************************************************/
+int strnum( char *out, double val, int prec, char conv, int outSz )
+{
+	static const double p10[ ] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	char dig[ 24 ], fmt[ 8 ], *p = out;
+	double a, s, fl;
+	int i, k, e, x, n, tries;
+	uint64_t d;
+
+	if ( outSz < 32 || prec < 0 || prec > 15 || ! isfinite( val ) )
+		goto fallback;
+
+	if ( signbit( val ) )
+		*p++ = '-';
+
+	a = fabs( val );
+
+	if ( conv == 'f' )
+	{
+		s = a * p10[ prec ];
+		if ( s >= 1e15 )
+			goto fallback;
+
+		fl = floor( s );
+		if ( fabs( s - fl - 0.5 ) <= s * 5e-16 )
+			goto fallback;
+
+		d = ( uint64_t ) fl + ( s - fl > 0.5 ? 1 : 0 );
+
+		for ( n = 0; d > 0 || n <= prec; d /= 10 )
+			dig[ n++ ] = '0' + d % 10;
+
+		for ( i = n - 1; i >= prec; --i )
+			*p++ = dig[ i ];
+
+		if ( prec > 0 )
+		{
+			*p++ = '.';
+			for ( ; i >= 0; --i )
+				*p++ = dig[ i ];
+		}
+
+		*p = '\0';
+		return p - out;
+	}
+
+	if ( prec == 0 )
+		prec = 1;
+
+	if ( a == 0 )
+	{
+		*p++ = '0';
+		*p = '\0';
+		return p - out;
+	}
+
+	// estimate the decimal exponent and correct it after rounding
+	e = ( int ) floor( log10( a ) );
+
+	for ( tries = 0; ; ++tries )
+	{
+		k = prec - 1 - e;
+		if ( tries > 2 || k > 22 || k < -22 )
+			goto fallback;
+
+		s = k >= 0 ? a * p10[ k ] : a / p10[ - k ];
+		fl = floor( s );
+		if ( fabs( s - fl - 0.5 ) <= s * 5e-16 )
+			goto fallback;
+
+		d = ( uint64_t ) fl + ( s - fl > 0.5 ? 1 : 0 );
+
+		if ( d >= ( uint64_t ) p10[ prec ] )
+			++e;
+		else
+			if ( d < ( uint64_t ) p10[ prec - 1 ] )
+				--e;
+			else
+				break;
+	}
+
+	for ( i = prec - 1; i >= 0; --i, d /= 10 )
+		dig[ i ] = '0' + d % 10;
+
+	for ( n = prec; n > 1 && dig[ n - 1 ] == '0'; --n );	// significant digits
+
+	if ( e < -4 || e >= prec )
+	{
+		*p++ = dig[ 0 ];
+		if ( n > 1 )
+		{
+			*p++ = '.';
+			for ( i = 1; i < n; ++i )
+				*p++ = dig[ i ];
+		}
+
+		*p++ = conv == 'G' ? 'E' : 'e';
+		*p++ = e < 0 ? '-' : '+';
+		x = abs( e );
+		if ( x >= 100 )
+			*p++ = '0' + x / 100;
+		*p++ = '0' + x / 10 % 10;
+		*p++ = '0' + x % 10;
+	}
+	else
+		if ( e >= 0 )
+		{
+			for ( i = 0; i <= e; ++i )
+				*p++ = dig[ i ];
+
+			if ( n > e + 1 )
+			{
+				*p++ = '.';
+				for ( ; i < n; ++i )
+					*p++ = dig[ i ];
+			}
+		}
+		else
+		{
+			*p++ = '0';
+			*p++ = '.';
+			for ( i = e + 1; i < 0; ++i )
+				*p++ = '0';
+			for ( i = 0; i < n; ++i )
+				*p++ = dig[ i ];
+		}
+
+	*p = '\0';
+	return p - out;
+
+	fallback:
+	snprintf( fmt, sizeof( fmt ), "%%.*%c", conv );
+	n = snprintf( out, outSz, fmt, prec, val );
+	return min( n, outSz - 1 );
+}
@@ -32,6 +32,7 @@
 #define _LSD_DATE_ "May 2 2022"	 // __DATE__
 
 // standard libraries used
+#include <cstdint>
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
@@ -45,6 +46,7 @@
 #include <functional>
 #include <unordered_map>
 #include <unordered_set>
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
@@ -60,6 +62,8 @@
 #include <unistd.h>
 #include <signal.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/wait.h>
 #include <wordexp.h>
 #endif
@@ -91,6 +95,39 @@
 #define MODEL_INFO "modelinfo.txt"
 #define DESCRIPTION "description.txt"
 
+// binary results files details
+#define RES_BIN_EXT "lrb"				// binary columnar results file extension
+#define RES_BIN_MAGIC "LSDRESB"			// file type signature
+#define RES_BIN_VER 1					// format version
+#define RES_BIN_ORDER 0x01020304		// byte order mark
+#define RES_BIN_CHUNK 8192				// values per series chunk
+
+// configuration values sidecar file details
+#define CFG_BIN_EXT "lsb"				// binary values file extension
+#define CFG_BIN_MAGIC "LSDCFGB"			// file type signature
+#define CFG_BIN_VER 1					// format version
+#define CFG_BIN_ORDER 0x01020304		// byte order mark
+#define CFG_BIN_MIN 10000				// min element values to use the file
+
+// run checkpoint files details
+#define CKPT_EXT "lck"					// checkpoint file extension
+#define CKPT_MAGIC "LSDCKPT"			// file type signature
+#define CKPT_VER 1						// format version
+#define CKPT_ORDER 0x01020304			// byte order mark
+
+// Monte Carlo statistics partial files details
+#define MC_AGG_EXT "lma"				// partial statistics file extension
+#define MC_AGG_MAGIC "LSDMCAG"			// file type signature
+#define MC_AGG_VER 2					// format version
+#define MC_AGG_ORDER 0x01020304			// byte order mark
+
+// saved series spill file details
+#define SAVE_MAP_SEG ( 64 << 20 )		// bytes per mapped file segment
+#define SAVE_MAP_ALIGN 64				// allocation alignment (bytes)
+
+// deleted objects series store details
+#define GRAVE_BLOCK ( 1 << 20 )			// bytes per store memory block
+
 // user defined signals
 #define SIGMEM NSIG + 1					// out of memory signal
 #define SIGSTL NSIG + 2					// standard library exception signal
@@ -150,6 +187,9 @@
 using namespace std;
 
 // classes pre-definitions
+class cfg_reader;
+struct eq_vec;
+struct layout;
 struct object;
 struct variable;
 struct bridge;
@@ -159,20 +199,75 @@ struct netLink;
 
 // special types used for fast equation, object and variable lookup
 typedef function < double( object *caller, variable *var ) > eq_funcT;
-typedef pair < string, bridge * > b_pairT;
+typedef void ( *eq_vec_funcT )( eq_vec &vec );
 typedef pair < double, object * > o_pairT;
-typedef pair < string, variable * > v_pairT;
+typedef vector < bridge * > b_vecT;
 typedef vector < object * > o_vecT;
+typedef vector < variable * > v_vecT;
 typedef unordered_map < string, eq_funcT > eq_mapT;
-typedef unordered_map < string, bridge * > b_mapT;
+typedef unordered_map < string, layout * > l_mapT;
 typedef unordered_map < double, object * > o_mapT;
 typedef unordered_map < string, string > p_mapT;
-typedef unordered_map < string, variable * > v_mapT;
+typedef unordered_map < string, int > s_mapT;
 typedef unordered_set < object * > o_setT;
 
 #ifndef _NP_
-typedef lock_guard < recursive_mutex > rec_lguardT;
-typedef unique_lock < recursive_mutex > rec_uniqlT;
+/*
+	Mutex allocated only when first locked in parallel mode, as most
+	objects and variables are never computed concurrently.
+	Locking is a no-op when not running multi-threaded.
+*/
+template < class M > class lazy_mutex
+{
+	atomic < M * > mtx;
+
+	M *get( void )
+	{
+		M *m = mtx.load( memory_order_acquire ), *n;
+
+		if ( m == NULL )
+		{
+			n = new M;
+			if ( mtx.compare_exchange_strong( m, n, memory_order_acq_rel ) )
+				m = n;
+			else
+				delete n;				// other thread allocated it first
+		}
+
+		return m;
+	}
+
+  public:
+	lazy_mutex( void ) : mtx( NULL ) { }
+	lazy_mutex( const lazy_mutex & ) = delete;
+	~lazy_mutex( void ) { delete mtx.load( ); }
+
+	bool try_lock( void )
+	{
+		extern bool parallel_mode;
+		return parallel_mode ? get( )->try_lock( ) : true;
+	}
+
+	void lock( void )
+	{
+		extern bool parallel_mode;
+		if ( parallel_mode )
+			get( )->lock( );
+	}
+
+	void unlock( void )
+	{
+		extern bool parallel_mode;
+		if ( parallel_mode )
+			mtx.load( memory_order_acquire )->unlock( );
+	}
+};
+
+typedef lazy_mutex < mutex > lazy_mtxT;
+typedef lazy_mutex < recursive_mutex > lazy_rec_mtxT;
+typedef lock_guard < lazy_mtxT > obj_lguardT;
+typedef lock_guard < lazy_rec_mtxT > rec_lguardT;
+typedef unique_lock < lazy_rec_mtxT > rec_uniqlT;
 #endif
 
 #ifdef _WIN32
@@ -182,9 +277,18 @@ typedef pid_t handleT;
 #endif
 
 // classes definitions
+struct layout							// per-type data shared by all instances
+{
+	char *label;						// object type name
+	s_mapT b_slot;						// son object name to bridge slot index
+	s_mapT v_slot;						// element name to variable slot index
+
+	layout( const char *lab );			// constructor
+};
+
 struct object
 {
-	char *label;
+	char *label;						// points to the type layout label
 	bool deleting;						// indicate deletion in process
 	bool to_compute;
 	int acounter;
@@ -194,23 +298,26 @@ struct object
 	object *up;
 	variable *v;
 	object *hook;
+	layout *lay;						// per-type shared layout
 	netNode *node;						// pointer to network node data structure
 	void *cext;							// pointer to a C++ object extension to the LSD object
 	bool *del_flag;						// address of flag to signal deletion
 
 	o_vecT hooks;
-	b_mapT b_map;						// fast lookup map to object bridges
-	v_mapT v_map;						// fast lookup map to variables
+	b_vecT b_map;						// fast lookup bridges, by layout slot
+	v_vecT v_map;						// fast lookup variables, by layout slot
 
 #ifndef _NP_
-	mutex parallel_comp;				// mutex lock for parallel computations
+	lazy_mtxT parallel_comp;			// mutex lock for parallel computations
 #endif
 
-	bool load_param( const char *file_name, int repl, FILE *f );
-	bool load_struct( FILE *f );
+	bool load_param( cfg_reader &in, o_vecT &heads );
+	bool load_struct( cfg_reader &in );
 	bool under_computation( void );
 	bool under_comput_var( const char *lab );
+	bridge *lookup_bridge( const char *lab );
 	bridge *search_bridge( const char *lab, bool no_error = false );
+	double arr_dim( const char *lab, bool cols = false );
 	double av( const char *lab1, int lag = 0, bool cond = false, const char *lab2 = "", const char *lop = "", double value = NAN );
 	double cal( const char *l, int lag = 0 );
 	double cal( object *caller, const char *l, int lag = 0 );
@@ -218,6 +325,7 @@ struct object
 	double count( const char *lab1, int lag = 0, bool cond = false, const char *lab2 = "", const char *lop = "", double value = NAN );
 	double count_all( const char *lab1, int lag = 0, bool cond = false, const char *lab2 = "", const char *lop = "", double value = NAN );
 	double increment( const char *lab, double value );
+	double initcolumns( const char *lab );
 	double initturbo( const char *label, double num );
 	double initturbo_cond( const char *label );
 	double init_stub_net( const char *lab, const char* gen, long numNodes = 0, long par1 = 0, double par2 = 0.0 );
@@ -236,6 +344,7 @@ struct object
 	double recal( const char *l );
 	double sd( const char *lab1, int lag = 0, bool cond = false, const char *lab2 = "", const char *lop = "", double value = NAN );
 	double search_inst( object *obj = NULL, bool fun = true );
+	double set_dim( const char *lab, int rows, int cols );
 	double stat( const char *lab1, double *v = NULL, int lag = 0, bool cond = false, const char *lab2 = "", const char *lop = "", double value = NAN );
 	double stats_net( const char *lab, double *r );
 	double sum( const char *lab1, int lag = 0, bool cond = false, const char *lab2 = "", const char *lop = "", double value = NAN );
@@ -243,6 +352,7 @@ struct object
 	double whg_av( const char *lab1, const char *lab2, int lag = 0, bool cond = false, const char *lab3 = "", const char *lop = "", double value = NAN );
 	double write( const char *lab, double value, int time, int lag = 0 );
 	double write_file_net( const char *lab, const char *dir = "", const char *base_name = "net", int serial = 1, bool append = false );
+	double *cal_arr( object *caller, const char *lab, int lag = 0, int *rows = NULL, int *cols = NULL );
 	long init_circle_net( const char *lab, long numNodes, long outDeg );
 	long init_connect_net( const char *lab, long numNodes );
 	long init_discon_net( const char *lab, long numNodes );
@@ -280,6 +390,7 @@ struct object
 	object *turbosearch( const char *label, double tot, double num );
 	object *turbosearch_cond( const char *label, double value );
 	variable *add_empty_var( const char *str );
+	variable *lookup_var( const char *lab );
 	variable *search_var( object *caller, const char *label, bool no_error = false, bool no_search = false, bool search_sons = false );
 	variable *search_var_err( object *caller, const char *label, bool no_search, bool search_sons, const char *errmsg );
 	void add_obj( const char *label, int num, int propagate );
@@ -293,17 +404,43 @@ struct object
 	void delete_obj( variable *caller = NULL );
 	void delete_var( const char *lab );
 	void empty( void );
+	void emptycolumns( void );			// remove columnar storage
 	void emptyturbo( void );			// remove turbo search structure
 	void init( object *_up, const char *_label, bool _to_compute = true );
+	void map_bridge( const char *lab, bridge *cb );
+	void map_var( const char *lab, variable *cv );
 	void name_node_net( const char *nodeName );
 	void recreate_maps( void );
 	void replicate( int num, bool propagate = false );
 	void save_param( FILE *f );
 	void save_struct( FILE *f, const char *tab );
 	void search_inst( object *obj, long *pos, long *checked );
+	void set_layout( const char *lab );
 	void update( bool recurse, bool user );
 };
 
+class save_zip							// compressed saved data, in blocks
+{
+	int size;							// number of values stored
+	int wblk;							// block being written, uncompressed
+	int version;						// changes when a block is rewritten
+	uint64_t id;						// unique store identifier
+	bool flt;							// values in single precision
+	vector < double > wbuf;				// values of the block being written
+	vector < string > blks;				// compressed blocks (empty if unused)
+
+	void pack( int blk, const double *vals, int n );	// compress a block
+	void unpack( int blk, double *vals, int n ) const;	// decompress a block
+
+	public:
+
+	save_zip( int _size, bool _flt );	// constructor
+
+	double get( int pos );				// read value in position
+	void set( int pos, double val );	// write value in position
+	void shrink( void );				// compress the block being written
+};
+
 struct variable
 {
 	char *label;
@@ -311,12 +448,18 @@ struct variable
 	char data_loaded;
 	char debug;
 	bool dummy;
+	bool in_arena;						// lags stored in the compaction arena
+	bool in_column;						// lags stored in the bridge columns
+	bool in_map;						// saved data stored in the spill file
 	bool observe;
 	bool parallel;
 	bool plot;
 	bool save;
 	bool savei;
 	bool under_computation;
+	int cols;							// array columns (0 if not array)
+	int data_size;						// saved data length (circular if shorter)
+	int data_step;						// saved data time steps interval
 	int deb_cond;
 	int delay;
 	int delay_range;
@@ -327,26 +470,68 @@ struct variable
 	int param;
 	int period;
 	int period_range;
+	int rows;							// array rows (0 if not array)
+	int save_every;						// save every n time steps
+	int save_fmt;						// saved data storage (SAVE_FLT/SAVE_ZIP)
+	int save_from;						// first time step to save (0=first)
+	int save_last;						// keep last n saved values (0=all)
+	int save_to;						// last time step to save (0=last)
+	int serial;							// saved series serial number in the run
 	int start;
-	double *data;
+	int vec_time;						// time of pending vector equation result
+	double *arr;						// array values, current and lags (column-major)
+	double *arr_data;					// saved array values
+	double *data;						// saved data (double precision)
+	float *data_flt;					// saved data (single precision)
 	double *val;
 	double deb_cnd_val;
+	double vec_res;						// pending vector equation result
 	object *up;
+	save_zip *data_zip;					// saved data (compressed)
 	variable *next;
 
 #ifndef _NP_
-	recursive_mutex parallel_comp;		// mutex lock for parallel computation
+	lazy_rec_mtxT parallel_comp;		// mutex lock for parallel computation
 #endif
 
-	eq_funcT eq_func;					// pointer to equation function for fast look-up
+	eq_funcT *eq_func;					// pointer to equation function for fast look-up
 
 	variable( void );					// empty constructor
 	variable( const variable &v );		// copy constructor
 
+	static void *operator new( size_t sz );	// arena-aware allocation
+	static void operator delete( void *p );
+
 	double cal( object *caller, int lag );
+	double *arr_out( void );
+	double *cal_arr( object *caller, int lag );
 	double fun( object *caller );
+	double fun_vec( object *caller, eq_vec_funcT kernel );
+	bool alloc_data( int fmt );
+	double *data_ptr( void );
+	double get_data( int time );
+	int data_pos( int time );
+	bool in_data( int time );
 	void empty( bool no_lock = false );
+	void free_data( void );
 	void init( object *_up, const char *_label, int _num_lag, double *val, int _save );
+	void save_arr( int time );
+	void set_data( int time, double value );
+	void set_dim( int _rows, int _cols, int _num_lag = -1 );
+	void shift_arr( const double *cur );
+	void trim_data( void );
+};
+
+struct eq_vec							// vector equation evaluation context
+{
+	bool full;							// all instances computed at once
+	int n;								// number of instances computed
+	double *res;						// results for all instances
+	object **obj;						// instances being computed
+	object *caller;						// object requesting the computation
+	vector < vector < double > > vals;	// gathered input values
+
+	const double *in( const char *lab, int lag = 0 );
 };
 
 struct bridge
@@ -354,11 +539,14 @@ struct bridge
 	char *blabel;
 	bool copy;							// just a temporary copy
 	bool counter_updated;
+	int col_num;						// instances in columns (0 if outdated)
 	bridge *next;
 	mnode *mn;
 	object *head;
 	char *search_var;					// current initialized search variable
 
+	vector < double * > cols;			// values columns, by variable slot
+
 	o_mapT o_map;						// fast lookup map to objects
 
 	bridge( const char *lab );			// constructor
@@ -468,24 +656,379 @@ struct lsdstack
 };
 
 
+struct res_bin_head						// binary results file header
+{
+	char magic[ 8 ];					// RES_BIN_MAGIC
+	uint32_t version;					// RES_BIN_VER
+	uint32_t order;						// RES_BIN_ORDER
+	int32_t first;						// first time step in file
+	int32_t last;						// last time step in file
+	uint32_t series;					// number of series
+	uint32_t chunk;						// values per chunk
+	uint64_t dir;						// series directory position
+	uint64_t names;						// names table position
+	uint64_t names_size;				// names table size (bytes)
+};
+
+struct res_bin_ser						// binary results series directory entry
+{
+	uint32_t label;						// label position in names table
+	uint32_t tag;						// tag position in names table
+	int32_t start;						// first time step of series
+	int32_t end;						// last time step of series
+	uint64_t chunks;					// chunk table position
+};
+
+struct res_bin_chk						// binary results chunk table entry
+{
+	uint64_t pos;						// chunk data position
+	uint32_t size;						// stored chunk size (bytes)
+	uint32_t zip;						// compressed chunk flag
+};
+
+class res_bin							// memory-mapped binary results file
+{
+	char *map;							// file contents
+	size_t len;							// file length
+	const char *names;
+	const res_bin_head *head;
+	const res_bin_ser *dir;
+
+	public:
+
+	res_bin( const char *fname );		// constructor
+	~res_bin( void );					// destructor
+
+	bool ok( void ) const { return head != NULL; };
+	int first( void ) const { return head->first; };
+	int last( void ) const { return head->last; };
+	int series( void ) const { return head->series; };
+	const res_bin_ser *info( int i ) const { return & dir[ i ]; };
+	const char *label( int i ) const { return names + dir[ i ].label; };
+	const char *tag( int i ) const { return names + dir[ i ].tag; };
+	bool read( int i, double *data ) const;	// read series values
+};
+
+class save_map							// memory-mapped temporary file for saved series
+{
+	char *next;							// next free byte in current segment
+	size_t left;						// free bytes in current segment
+	size_t len;							// file length
+	vector < pair < char *, size_t > > segs;// mapped segments (address, length)
+#ifdef _WIN32
+	HANDLE fh;							// file handle
+#else
+	int fd;								// file descriptor
+#endif
+#ifndef _NP_
+	mutex lock;							// lock for parallel allocation
+#endif
+
+	public:
+
+	save_map( const char *dir );		// constructor
+	~save_map( void );					// destructor
+
+	bool ok( void ) const;				// file created
+	size_t size( void ) const { return len; };
+	void *alloc( size_t size );			// reserve space in file
+};
+
+struct run_prg							// progress of a parallel run (shared memory)
+{
+	int32_t run;						// current run in the instance (0=not started)
+	int32_t runs;						// number of runs in the instance
+	int32_t step;						// last time step started
+	int32_t max_step;					// time steps to perform
+	double start;						// run start wall time (seconds)
+};
+
+#ifndef _NP_
+class prg_map							// shared-memory progress of a set of parallel runs
+{
+	run_prg *map;						// progress of each run
+	size_t len;							// mapped length
+	bool owner;							// shared segment created here
+	string name;						// shared segment name
+
+	public:
+
+	prg_map( const char *base, int runs, bool create );	// constructor
+	~prg_map( void );					// destructor
+
+	bool ok( void ) const { return map != NULL; };
+	run_prg *run( int i ) const { return map != NULL && i >= 0 && ( size_t ) ( i + 1 ) * sizeof( run_prg ) <= len ? map + i : NULL; };
+};
+#endif
+
+struct grave							// saved series of a deleted object variable
+{
+	char *label;						// variable label (shared in store)
+	char *lab_tit;						// object instance tag (in store)
+	bool in_store;						// saved data in the store or spill file
+	int cols;							// array columns (0 if not array)
+	int data_size;						// saved data length (circular if streaming)
+	int data_step;						// saved data time steps interval
+	int end;
+	int rows;							// array rows (0 if not array)
+	int serial;							// saved series serial number in the run
+	int start;
+	double *arr_data;					// saved array values
+	double *data;						// saved data (double precision)
+	float *data_flt;					// saved data (single precision)
+	save_zip *data_zip;					// saved data (compressed)
+
+	double *data_ptr( void );			// saved data in all time steps
+	double get_arr( int time, int k );	// read array element in time step
+	double get_data( int time );		// read value in time step
+	int data_pos( int time );			// position of time step in saved data
+	bool in_data( int time );			// time step in saved data
+	void free_data( void );				// release saved data
+};
+
+class graveyard							// compact store of deleted objects series
+{
+	char *next;							// next free byte in current block
+	size_t left;						// free bytes in current block
+	vector < char * > blks;				// memory blocks
+	unordered_map < string, char * > labels;	// variable labels, stored once
+#ifndef _NP_
+	mutex lock;							// lock for parallel deletion
+#endif
+
+	char *copy( const char *text );		// store a string
+
+	public:
+
+	vector < grave > graves;			// series index, in deletion order
+
+	graveyard( void );					// constructor
+	~graveyard( void );					// destructor
+
+	void *alloc( size_t size );			// reserve space in store
+	void bury( variable *cv );			// move a variable series to store
+	void clear( void );					// release all series
+};
+
+class cfg_reader							// configuration file text parser
+{
+	long base;							// file position of text start
+	const char *pos;					// next character to parse
+	vector < char > text;				// file text (null terminated)
+	FILE *bin;							// binary values sidecar file
+	string bin_name;					// sidecar file name
+	size_t bin_pos;						// next sidecar value to read
+	vector < double > bin_vals;			// sidecar values being read
+
+	void blank( void );					// skip white space
+
+	public:
+
+	cfg_reader( void ) : bin( NULL ), bin_pos( 0 ) { };
+	~cfg_reader( void ) { if ( bin != NULL ) fclose( bin ); };
+
+	bool read( FILE *f );				// read file from current position
+	bool read_bin( long expect );		// read sidecar values after '<bin:'
+	bool bin_left( void ) const { return bin_pos < bin_vals.size( ); };
+	void set_bin( const string &name ) { bin_name = name; };
+	bool get( char *c );				// read next non-blank character
+	bool get( double *x );				// read number
+	bool get( int *n );					// read integer
+	bool tag( const char *lit );		// match literal (after blanks)
+	bool word( char *str, int size );	// read non-blank word
+	long tell( void ) const { return base + ( pos - text.data( ) ); };
+	void skip( const char *set );		// skip characters in set
+};
+
+struct snap_var							// variable in a configuration snapshot
+{
+	string label;
+	char data_loaded;
+	char debug;
+	bool parallel;
+	bool plot;
+	bool save;
+	bool savei;
+	int cols;							// array columns (0 if not array)
+	int delay;
+	int delay_range;
+	int num_lag;
+	int param;
+	int period;
+	int period_range;
+	int rows;							// array rows (0 if not array)
+	int save_every;
+	int save_fmt;
+	int save_from;
+	int save_last;
+	int save_to;
+};
+
+struct snap_type						// object type in a configuration snapshot
+{
+	string label;
+	bool to_compute;
+	vector < snap_var > vars;			// variables, in object order
+	vector < int > sons;				// descendant types, in bridges order
+};
+
+class snapshot							// initial configuration state in memory
+{
+	size_t cnt_pos;						// next instance count to restore
+	size_t val_pos;						// next value to restore
+	vector < int > counts;				// instances per bridge, in tree order
+	vector < double > vals;				// variables values, in tree order
+	vector < snap_type > types;			// object types, root first
+
+	void get_obj( object *r, int type );// restore object (recursively)
+	void put_obj( object *r, int type );// store object (recursively)
+	int put_type( object *r );			// store object type (recursively)
+
+	public:
+
+	bool ready( void ) const { return types.size( ) > 0; };
+	void clear( void );					// discard snapshot
+	void restore( object *r );			// rebuild the tree under root r
+	void take( object *r );				// store the tree under root r
+};
+
+struct mc_cell							// cross-run statistics of a series in a time step
+{
+	double n;							// number of (valid) values
+	double mean;
+	double m2;							// sum of squared deviations from mean
+	double max;
+	double min;
+};
+
+class mc_stats							// cross-run Monte Carlo statistics
+{
+	int last;							// last time step (first is 1)
+	vector < string > names;			// series names, in columns order
+	vector < string > heads;			// series .csv header names, in columns order
+	unordered_map < string, size_t > cols;	// series name column
+	unordered_map < string, int > seen;	// header names count in current run
+	vector < vector < mc_cell > > cells;// statistics per column, per time step
+
+	size_t col( const string &name, const string &head );	// series column (add if new)
+	void add_obj( object *r, int endtstep );	// add objects series (recursively)
+	void add_series( const string &head, int start, int end, function < double ( int ) > val );
+										// add a series values
+
+	public:
+
+	int runs;							// number of runs included
+
+	mc_stats( void ) : last( 0 ), runs( 0 ) { };
+
+	void add( object *root, int endtstep );	// add current run saved series
+	void clear( void );					// remove all runs
+	bool load( const char *fname );		// merge partial statistics file
+	bool save( const char *fname );		// write partial statistics file
+	bool save_csv( const char *base );	// write statistics .csv files
+};
+
+class checkpoint						// simulation run state file
+{
+	FILE *f;							// file being read or written
+	bool ok;							// no failure so far
+	o_vecT objs;						// objects, in tree order
+	unordered_map < object *, long > obj_pos;	// objects tree order position
+
+	template < class T > void get( T &x ) { ok = ok && fread( & x, sizeof( T ), 1, f ) == 1; };
+	template < class T > void put( const T &x ) { ok = ok && fwrite( & x, sizeof( T ), 1, f ) == 1; };
+	void get_arr( double *x, size_t n );// read values (skip if x is NULL)
+	void get_data( variable *cv );		// read variable saved data
+	void get_graves( void );			// read deleted objects series
+	void get_links( void );				// read objects pointers and networks
+	void get_obj( object *r );			// read object (recursively)
+	mnode *get_mn( void );				// read turbo search tree
+	object *get_ptr( void );			// read object pointer
+	void get_str( string &s );			// read text
+	void get_var( object *r, variable *cv );	// read variable
+	void put_arr( const double *x, size_t n );	// write values
+	void put_data( variable *cv );		// write variable saved data
+	void put_graves( void );			// write deleted objects series
+	void put_links( void );				// write objects pointers and networks
+	void put_obj( object *r );			// write object (recursively)
+	void put_mn( mnode *m );			// write turbo search tree
+	void put_ptr( object *o );			// write object pointer
+	void put_str( const char *s );		// write text
+	void put_var( variable *cv );		// write variable
+
+	public:
+
+	int run;							// run in the set of runs
+	int step;							// last time step done (0=run not started)
+	unsigned run_seed;					// random generator seed, as in seed
+
+	checkpoint( void ) : f( NULL ), ok( false ), run( 0 ), step( 0 ), run_seed( 0 ) { };
+
+	bool load( FILE *file, bool head_only = false );	// read open file and restore run
+	bool load( const char *fname, bool head_only = false );	// read file and restore run
+	bool save( FILE *file );			// write current run state to open file
+	bool save( const char *fname );		// write current run state to file
+	static bool savable( object *r );	// check if objects state can be restored
+};
+
+struct gz_block							// results text block being compressed
+{
+	string in;							// text to compress
+	string out;							// compressed gzip member
+#ifndef _NP_
+	thread worker;						// compressing thread
+#endif
+};
+
 class result							// results file object
 {
-	FILE *f;							// uncompressed file pointer
+	FILE *f;							// file pointer
+	bool dobin;							// binary columnar .lrb format
 	bool docsv;							// comma separated .csv text format
 	bool dozip;							// compressed file flag
 	bool firstCol;						// flag for first column in line
-	gzFile fz;							// compressed file pointer
-
-	void title_recursive( object *r, int i );	// write file header (recursively)
-	void data_recursive( object *r, int i );	// save a single time step (recursively)
+	int zipped;							// number of compressed blocks
+	string zbuf;						// text to write or compress
+	vector < gz_block * > zblocks;		// blocks being compressed, in order
+	int bin_first;						// first time step in binary file
+	int bin_last;						// last time step in binary file
+	uint64_t bin_pos;					// binary file write position
+	string bin_names;					// binary file names table
+	unordered_map < string, uint32_t > bin_name_pos;	// names in table
+	vector < res_bin_ser > bin_dir;		// binary file series directory
+	object *plan_root;					// root of the saved variables list
+	int plan_dead;						// number of deleted objects series
+	vector < variable * > plan;			// saved variables alive, in columns order
+
+	uint32_t bin_name( const char *name );	// add name to binary file table
+	void bin_series( const char *lab, const char *tag, int start, int end, const double *data );
+										// write a binary file series
+	void bin_stream( object *root, int endtstep );	// write streamed binary data
+	void bin_var( const char *lab, const char *tag, int rows, int cols, int start, int end, vector < vector < double > > &vals );
+										// write a binary file variable series
+	void data_bin( object *root, int initstep, int endtstep );	// write binary data
+	void title_bin( object *root );	// prepare binary series tags
+	void title_var( const char *lab, const char *tag, int rows, int cols, int start, int end, bool single, int header );
+										// write variable (and array elements) header
+	void data_arr( variable *cv, int i );		// save array elements in a time step
+	void data_value( double val );		// save a single value
+	void gz_flush( void );				// compress buffered text
+	void gz_write( void );				// write oldest compressed block
+	void plan_tree( object *r );		// add saved variables (recursively)
+	void print( const char *fmt, ... );	// write formatted text
+	void put( const char *text, size_t len );	// write text to buffer
+	void save_plan( object *root );		// list saved variables once
 
 	public:
 
-	result( const char *fname, const char *fmode, bool dozip = false, bool docsv = false );
+	result( const char *fname, const char *fmode, bool dozip = false, bool docsv = false, bool dobin = false );
 										// constructor
 	~result( void );					// destructor
 
 	void data( object *root, int initstep, int endtstep = 0 );	// write data
+	void series( const char *lab, const char *tag, int rows, int cols, int start, int end, vector < vector < double > > &vals );
+										// write a variable saved on its own
+	void stream( object *root, int endtstep );	// write streamed data
 	void title( object *root, int flag );	// write file header
 };
 
@@ -589,6 +1132,7 @@ int kill_system( int id );
 int lsdmain( int argn, const char **argv );
 int strcln( char *out, const char *str, int outSz );
 int strlf( char *out, const char *str, int outSz );
+int strnum( char *out, double val, int prec, char conv, int outSz );
 int strtrim( char *out, const char *str, int outSz );
 int strwrap( char *out, const char *str, int outSz, int wid );
 int run_system( const char *cmd, int id = -1 );
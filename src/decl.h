@@ -37,6 +37,7 @@ Relevant flags (when defined):
 #include <list>
 #include <map>
 #include <set>
+#include <sstream>
 #include <atomic>
 #include <exception>
 
@@ -63,6 +64,11 @@ Relevant flags (when defined):
 #define NOLH_TABS 7						// number of defined NOLH tables
 #define PROG_SERIES 10000				// AoR progress bar when loading series limit
 #define FILE_BUF_SIZE 1000000			// buffer size for file reading
+#define GZ_BLOCK_SIZE 1000000			// text block size for parallel compression
+#define SAVE_BLOCK 256					// values per compressed saved data block
+#define SAVE_FLT 1						// saved data storage flag: single precision
+#define SAVE_ZIP 2						// saved data storage flag: compressed
+#define FRAG_DIST 1024					// max. bytes between elements not counted as fragmented
 #define T_CLEVS 10						// number of defined t distribution confidence levels
 #define Z_CLEVS 7						// number of defined normal distr. confidence levels
 #define SIG_DIG 10						// number of significant digits in data files
@@ -169,8 +175,11 @@ extern bool use_nan;					// flag to allow using Not a Number value
 extern char *path;						// folder where the configuration is
 extern char *simul_name;				// configuration name being run (for saving networks)
 extern const bool no_pointer_check;		// user pointer checking static disable
+extern double compact_frag;				// fragmentation share to trigger compaction
 extern double def_res;					// default equation result
 extern eq_mapT eq_map;					// map to fast equation look-up
+extern int bin_values;					// save large initial values to binary file (bool)
+extern int compact_steps;				// time steps between compaction checks (0=none)
 extern int cur_sim;
 extern int debug_flag;
 extern int max_step;
@@ -204,6 +213,7 @@ bool alloc_save_mem( object *r );
 bool alloc_save_var( variable *v );
 bool check_cond( double val1, int lopc, double val2 );
 bool check_res_dir( const char *path, const char *sim_name = NULL );
+bool cmp_init_val( vector < pair < string, double > > &base, vector < pair < string, double > > &vals, map < string, double > &pars );
 bool contains( FILE *f, const char *lab, int len );
 bool create_maverag( void );
 bool create_res_dir( const char *path );
@@ -219,8 +229,11 @@ bool save_sensitivity( FILE *f );
 bool search_parallel( object *r );
 bool sensitivity_clean_dir( const char *path );
 bool sensitivity_too_large( long numSaPts );
+bool set_random_state( const string &state );
+bool single_lab_tit( variable *var );
 bool sort_listbox( int box, int order, object *r );
 bool stop_parallel( void );
+bool stream_open( void );
 bool unsaved_change( bool );
 bool unsaved_change( void );
 char *NOLH_valid_tables( int k, char *out, int sz );
@@ -233,6 +246,8 @@ double lower_bound( double a, double b, double marg, double marg_eq, int dig = 1
 double upper_bound( double a, double b, double marg, double marg_eq, int dig = 16 );
 double t_star( int df, double cl );
 double z_star( double cl );
+double fragmentation( object *r );
+double *column( variable *cv, int *n, int *stride );
 double *log_data( double *data, int start, int end, int ser, const char *err_msg );
 int browse( object *r );
 int check_label( const char *lab, object *r );
@@ -240,6 +255,7 @@ int check_affected( object *c, object *pivot, int level, int affected[ ] );
 int compute_copyfrom( object *c, const char *parWnd );
 int count_lines( const char *fname, bool dozip = false );
 int entry_new_objnum( object *c, const char *tag );
+int get_slot( s_mapT &slots, const char *lab, bool add );
 int hyper_count( const char *lab );
 int hyper_count_var( const char *lab );
 int load_configuration( bool reload, int quick = 0 );
@@ -249,9 +265,11 @@ int min_hborder( int pdigits, double miny, double maxy );
 int monitor_logs( void );
 int num_sensitivity_variables( sense *rsens );
 int rnd_int( int min, int max );
+int run_forked( const char *simname, int fseed, int runs, int parruns );
 int run_parallel( bool nw, const char *exec, const char *simname, int fseed, int runs, int thrrun, int parruns );
 int shrink_gnufile( void );
 int uniform_int_0( int max );
+layout *get_layout( const char *lab );
 long num_sensitivity_points( sense *rsens );
 object *check_net_struct( object *caller, const char *nodeLab, bool noErr = false );
 object *go_brother( object *c );
@@ -260,6 +278,7 @@ object *restore_pos( object * );
 object *sensitivity_parallel( object *o, sense *s );
 object *skip_next_obj( object *t );
 object *skip_next_obj( object *t, int *count );
+string get_random_state( void );
 void NOLH_clear( void );
 void add_cemetery( variable *v );
 void add_da_plot_tab( const char *w, int id_plot );
@@ -312,6 +331,7 @@ void fill_list_par( object *r, bool show_all );
 void fill_list_var( object *r, bool show_all, bool lag_only );
 void find_lags( object *r );
 void find_using( object *r, variable *v, FILE *frep, bool *found );
+void get_init_val( object *r, vector < pair < string, double > > &vals );
 void get_sa_limits( object *r, FILE *out, const char *sep );
 void get_saved( object *n, FILE *out, const char *sep, bool all_var = false );
 void get_var_descr( const char *lab, char *desc, int descr_len );
@@ -320,6 +340,7 @@ void histograms_cs( void );
 void init_map( void );
 void init_math_error( void );
 void init_plot( int i, int id_sim );
+void insert_data_bin( int *num_v, vector < string > *var_names, bool keep_vars );
 void insert_data_file( bool gz, int *num_v, vector < string > *var_names, bool keep_vars );
 void insert_data_mem( object *r, int *num_v, const char *lab = NULL );
 void insert_labels_mem( object *r, int *num_v, const char *lab = NULL );
@@ -328,6 +349,7 @@ void insert_object( const char *w, object *r, bool netOnly = false, object *abov
 void insert_store_mem( object *r, int max_v, int *num_v, const char *lab = NULL );
 void link_cells( object *root, const char *lab );
 void log_parallel( bool nw );
+void mc_parallel( const char *simname, int fseed, int runs );
 void monitor_parallel( bool nw );
 void move_obj( const char *lab, const char *dest );
 void plog_backend( const char *cm, const char *tag, va_list arg );
@@ -348,13 +370,14 @@ void put_line( int x1, int y1, int x2 );
 void put_node( int x, int y, const char *str, bool sel );
 void put_text( const char *str, const char *num, int x, int y, const char *str2 );
 void read_eq_filename( char *s, int sz );
+void relocate_vars( object *r, bool compact );
 void report( object *r );
 void reset_blueprint( object *r );
 void reset_description( object *r );
 void reset_end( object *r );
 void reset_plot( void );
 void run( void );
-void run_parallel_exec( bool nw, int id, string cmd );
+void run_parallel_exec( bool nw, int id );
 void save_cells( object *r, const char *lab );
 void save_data1( void );
 void save_datazip( void );
@@ -375,6 +398,7 @@ void set_buttons_run( bool enable );
 void set_cs_data( void );
 void set_lab_tit( variable *var );
 void set_obj_number( object *r );
+void set_par_init( object *r, map < string, double > &pars );
 void set_shortcuts( const char *window );
 void set_shortcuts_run( const char *window );
 void set_title( object *c, const char *lab, const char *tag, int *incr );
@@ -400,16 +424,21 @@ void show_report( const char *par_wnd );
 void show_save( object *n );
 void show_special_updat( object *n );
 void show_tmp_vars( object *r, bool update );
+void single_close( void );
+void single_open( const char *fname, bool zip );
 void sort_cs_asc( char **s, char **t, double **v, int nv, int nt, int c );
 void sort_cs_desc( char **s, char **t, double **v, int nv, int nt, int c );
 void statistics( void );
 void statistics_cross( void );
+void stream_block( object *root, int last );
+void stream_close( void );
 void tex_report_end( FILE *f );
 void tex_report_head( FILE *f, bool table = true );
 void tex_report_init( object *r, FILE *f, bool table = true );
 void tex_report_initall( object *r, FILE *f, bool table = true );
 void tex_report_observe( object *r, FILE *f, bool table = true );
 void tex_report_struct( object *r, FILE *f, bool table = true );
+void uncolumn( variable *cv );
 void uncover_browser( void );
 void unload_configuration ( bool full );
 void unlink_cells( object *r, const char *lab );
@@ -431,6 +460,7 @@ void parallel_update( variable *v, object* p, object *caller = NULL );
 
 // global internal variables (not visible to the users)
 extern FILE *log_file;			// log file, if any
+extern FILE *stream_file;		// streamed results spool file, if any
 extern bool brCovered;			// browser cover currently covered
 extern bool eq_dum;				// current equation is dummy
 extern bool error_hard_thread;	// flag to error_hard() called in worker thread
@@ -472,6 +502,7 @@ extern double z_dist_cl[ Z_CLEVS ];// normal distribution table confidence level
 extern double z_dist_st[ Z_CLEVS ];// normal distribution table statistics
 extern double ymax;				// runtime plot max limit
 extern double ymin;				// runtime plot min limit
+extern graveyard cemetery;		// LSD saved data from deleted objects
 extern int NOLH_1[ ][ 7 ];		// near-orthogonal Latin hypercube tables
 extern int NOLH_2[ ][ 11 ];
 extern int NOLH_3[ ][ 16 ];
@@ -484,6 +515,7 @@ extern int choice;				// Tcl menu control variable (main window)
 extern int choice_g;			// Tcl menu control variable ( structure window)
 extern int cur_plt;				// current graph plot number
 extern int dobar;				// output a progress bar to the log/standard output
+extern int dobin;				// produce binary columnar .lrb results files (bool)
 extern int docsv;				// produce .csv text results files (bool)
 extern int doover;				// overwrite results folder (bool)
 extern int dozip;				// compressed results file flag (bool)
@@ -503,6 +535,8 @@ extern int saveConf;			// save configuration on results saving (bool)
 extern int series_saved;		// number of series saved
 extern int stack;				// LSD stack call level
 extern int stack_info;			// LSD stack control
+extern int stream_done;			// last time step streamed to results file
+extern int stream_steps;		// time steps per streamed results block (0=none)
 extern int strWindowOn;			// control the presentation of the model structure window (bool)
 extern int watch;				// allow for graph generation interruption (bool)
 extern int when_debug;			// next debug stop time step (0 for none )
@@ -515,9 +549,9 @@ extern object *blueprint;		// LSD blueprint (effective model in use )
 extern object *currObj;			// pointer to current object in browser
 extern object *wait_delete;		// LSD object waiting for deletion
 extern o_setT obj_list;			// list with all existing LSD objects
+extern save_map *spill_map;		// saved series spill file, if any
 extern sense *rsense;			// LSD sensitivity analysis structure
-extern variable *cemetery;		// LSD saved data from deleted objects
-extern variable *last_cemetery;	// LSD last saved data from deleted objects
+extern snapshot init_state;		// initial configuration state for next runs
 extern vector < string > res_list;// list of results files last saved
 extern void *random_engine;		// current random number generator engine
 
@@ -31,20 +31,22 @@ Calls the save_struct for all the descendant type.
 Save the numerical values for the object (one digit
 for each group of object of this type) and the initial values for variables.
 It save also option information, that is whether to save, plot or debug the
-variables.
+variables. If enabled in the configuration, elements with many values (all
+instances) have them written to a binary sidecar file (.lsb), referenced by
+position from the text file.
 It calls the save_param for all the descendant type.
 It is called in the browser, INTERF.CPP, immediately after save_struct, by the
 root of the model.
 
-- void object::load_struct( FILE *f )
+- void object::load_struct( cfg_reader &in )
 Initialize a model by creating	one as defined
 in the data file. The model, after this stage, has only one instance for each
 object type and variables and parameters are simply labels.
 
-- int object::load_param( const char *file_name, int repl )
-It loads from the file named as specified the data
-for the object. It is made in specular way in respect of save_param.
-Called from browser in INTERF.CPP immediately after load_struct.
+- int object::load_param( cfg_reader &in, o_vecT &heads )
+It loads from the file text the data for all the instances of the object
+type, in a single pass. It is made in specular way in respect of save_param.
+Called by load_configuration immediately after load_struct.
 *************************************************************/
 
 #include "decl.h"
@@ -92,17 +94,99 @@ void object::save_struct( FILE *f, const char *tab )
 }
 
 
+/****************************************************
+SAVE_NUM
+Writes a tab separated number with 15 significant
+digits, as in '%.15g'
+****************************************************/
+static void save_num( FILE *f, double val )
+{
+	char buf[ MAX_LINE_SIZE ];
+
+	buf[ 0 ] = '\t';
+	strnum( buf + 1, val, 15, 'g', sizeof( buf ) - 1 );
+	fputs( buf, f );
+}
+
+
+/****************************************************
+Binary values sidecar
+
+When enabled in the configuration (bin_values),
+elements with at least CFG_BIN_MIN initial values
+(all instances together) have them written in bulk
+to a binary file next to the configuration file,
+and the text file just records their position
+there. Smaller elements are kept as text.
+****************************************************/
+
+static FILE *cfg_bin = NULL;			// sidecar file, once opened
+static string cfg_bin_name;				// sidecar file name (empty if none)
+
+/****************************************************
+CFG_BIN_PUT
+Write values to the sidecar, opening it if needed
+Returns: file position of values, -1 if failure
+****************************************************/
+static long cfg_bin_put( const vector < double > &vals )
+{
+	int order = CFG_BIN_ORDER, ver = CFG_BIN_VER;
+	long pos;
+
+	if ( cfg_bin_name.empty( ) )
+		return -1;
+
+	if ( cfg_bin == NULL )
+	{
+		cfg_bin = fopen( cfg_bin_name.c_str( ), "wb" );
+		if ( cfg_bin == NULL )
+		{
+			cfg_bin_name.clear( );		// don't try again
+			return -1;
+		}
+
+		fwrite( CFG_BIN_MAGIC, 1, strlen( CFG_BIN_MAGIC ) + 1, cfg_bin );
+		fwrite( & ver, sizeof( int ), 1, cfg_bin );
+		fwrite( & order, sizeof( int ), 1, cfg_bin );
+	}
+
+	pos = ftell( cfg_bin );
+	if ( pos < 0 || fwrite( vals.data( ), sizeof( double ), vals.size( ), cfg_bin ) != vals.size( ) )
+		return -1;
+
+	return pos;
+}
+
+
+/****************************************************
+CFG_BIN_FILE
+Build the sidecar file name from the configuration
+file name
+****************************************************/
+static string cfg_bin_file( const char *conf_file )
+{
+	string name( conf_file );
+
+	if ( name.size( ) > 4 && name.compare( name.size( ) - 4, 4, ".lsd" ) == 0 )
+		name.erase( name.size( ) - 4 );
+
+	return name + "." CFG_BIN_EXT;
+}
+
+
 /****************************************************
 OBJECT::SAVE_PARAM
 ****************************************************/
 void object::save_param( FILE *f )
 {
 	int i, count = 0;
+	long pos;
 	char ch, ch1, ch2;
 	bridge *cb;
 	description *cd;
 	object *cur;
 	variable *cv, *cv1;
+	vector < double > vals;
 
 	fprintf( f, "\nObject: %s", label );
 
@@ -151,26 +235,55 @@ void object::save_param( FILE *f )
 		if ( cv->param == 2 )
 			fprintf( f, "Func: %s %d %c %c %c %c", cv->label, cv->num_lag, ch1, ch, cv->debug, ch2 );
 
+		// add optional array dimensions, values follow by lag, column and row
+		if ( cv->arr != NULL )
+			fprintf( f, "\t<dim: %d %d>", cv->rows, cv->cols );
+
+		// collect the values of all instances, in instance order
+		vals.clear( );
 		for ( cur = this; cur != NULL; cur = cur->hyper_next( label ) )
 		{
 			cv1 = cur->search_var( NULL, cv->label );
-			if ( cv1->param == 1 )
-				if ( cv1->data_loaded == '+' )
-					fprintf( f, "\t%.15g", cv1->val[ 0 ] );
-				else
-					fprintf( f, "\t%c", '0' );
+			if ( cv->arr != NULL )
+				for ( i = 0; i < ( cv->param == 1 ? 1 : cv->num_lag ) * cv->rows * cv->cols; ++i )
+					if ( cv1->data_loaded == '+' && cv1->rows == cv->rows && cv1->cols == cv->cols )
+						vals.push_back( cv1->arr[ i ] );
+					else
+						vals.push_back( 0 );
 			else
-				for ( i = 0; i < cv->num_lag; ++i )
+				if ( cv1->param == 1 )
 					if ( cv1->data_loaded == '+' )
-						fprintf( f, "\t%.15g", cv1->val[ i ] );
+						vals.push_back( cv1->val[ 0 ] );
 					else
-						fprintf( f, "\t%c", '0' );
+						vals.push_back( 0 );
+				else
+					for ( i = 0; i < cv->num_lag; ++i )
+						if ( cv1->data_loaded == '+' )
+							vals.push_back( cv1->val[ i ] );
+						else
+							vals.push_back( 0 );
 		}
 
+		// large sets go to the sidecar file, if possible
+		pos = vals.size( ) >= CFG_BIN_MIN ? cfg_bin_put( vals ) : -1;
+		if ( pos >= 0 )
+			fprintf( f, "\t<bin: %ld %ld>", pos, ( long ) vals.size( ) );
+		else
+			for ( auto val : vals )
+				save_num( f, val );
+
 		// add optional special updating data
 		if ( cv->param == 0 && ( cv->delay > 0 || cv->delay_range > 0 || cv->period > 1 || cv->period_range > 0 ) )
 			fprintf( f, "\t<upd: %d %d %d %d>", cv->delay, cv->delay_range, cv->period, cv->period_range );
 
+		// add optional saved data storage format
+		if ( cv->save_fmt != 0 )
+			fprintf( f, "\t<sto: %d>", cv->save_fmt );
+
+		// add optional saving policy
+		if ( cv->save_every > 1 || cv->save_from > 0 || cv->save_to > 0 || cv->save_last > 0 )
+			fprintf( f, "\t<sav: %d %d %d %d>", cv->save_every, cv->save_from, cv->save_to, cv->save_last );
+
 		fprintf( f, "\n" );
 	}
 
@@ -180,56 +293,227 @@ void object::save_param( FILE *f )
 }
 
 
+/****************************************************
+CFG_READER
+Configuration file text parser, reading the whole
+file at once and parsing it in place, with the
+same rules of the scanf( ) formats used before
+****************************************************/
+bool cfg_reader::read( FILE *f )
+{
+	long len;
+
+	base = ftell( f );
+	fseek( f, 0, SEEK_END );
+	len = ftell( f ) - base;
+	fseek( f, base, SEEK_SET );
+
+	if ( base < 0 || len < 0 )
+		return false;
+
+	text.resize( len + 1 );
+	len = fread( text.data( ), 1, len, f );
+	text[ len ] = '\0';
+	pos = text.data( );
+
+	return true;
+}
+
+/****************************************************
+CFG_READER::READ_BIN
+Read in bulk the values in the sidecar file at the
+position and count following a '<bin:' tag, which
+are then returned by get( double * ) in order,
+failing if the count is not the expected one
+****************************************************/
+bool cfg_reader::read_bin( long expect )
+{
+	char magic[ sizeof( CFG_BIN_MAGIC ) ];
+	int order, ver;
+	long start, count;
+	char *end;
+
+	start = strtol( pos, & end, 10 );
+	count = strtol( end, & end, 10 );
+	pos = end;
+
+	if ( ! tag( ">" ) || start <= 0 || count < 0 || count != expect || bin_left( ) )
+		return false;
+
+	if ( bin == NULL )
+	{
+		if ( bin_name.empty( ) || ( bin = fopen( bin_name.c_str( ), "rb" ) ) == NULL )
+			return false;
+
+		if ( fread( magic, 1, sizeof( magic ), bin ) != sizeof( magic ) || memcmp( magic, CFG_BIN_MAGIC, sizeof( magic ) ) || fread( & ver, sizeof( int ), 1, bin ) != 1 || ver != CFG_BIN_VER || fread( & order, sizeof( int ), 1, bin ) != 1 || order != CFG_BIN_ORDER )
+		{
+			fclose( bin );
+			bin = NULL;
+			bin_name.clear( );			// don't try again
+			return false;
+		}
+	}
+
+	bin_vals.resize( count );
+	bin_pos = 0;
+
+	if ( fseek( bin, start, SEEK_SET ) || fread( bin_vals.data( ), sizeof( double ), count, bin ) != ( size_t ) count )
+	{
+		bin_vals.clear( );
+		return false;
+	}
+
+	return true;
+}
+
+void cfg_reader::blank( void )
+{
+	while ( isspace( ( unsigned char ) *pos ) )
+		++pos;
+}
+
+void cfg_reader::skip( const char *set )
+{
+	while ( *pos != '\0' && strchr( set, *pos ) != NULL )
+		++pos;
+}
+
+bool cfg_reader::word( char *str, int size )
+{
+	int n;
+
+	blank( );
+
+	for ( n = 0; n < size - 1 && *pos != '\0' && ! isspace( ( unsigned char ) *pos ); ++n )
+		str[ n ] = *pos++;
+
+	str[ n ] = '\0';
+
+	return n > 0;
+}
+
+bool cfg_reader::get( char *c )
+{
+	blank( );
+
+	if ( *pos == '\0' )
+		return false;
+
+	*c = *pos++;
+	return true;
+}
+
+bool cfg_reader::get( int *n )
+{
+	char *end;
+	long val = strtol( pos, & end, 10 );
+
+	if ( end == pos )
+		return false;
+
+	*n = val;
+	pos = end;
+	return true;
+}
+
+bool cfg_reader::get( double *x )
+{
+	char *end;
+	double val;
+
+	if ( bin_left( ) )
+	{
+		*x = bin_vals[ bin_pos++ ];
+		return true;
+	}
+
+	val = strtod( pos, & end );
+
+	if ( end == pos )
+		return false;
+
+	*x = val;
+	pos = end;
+	return true;
+}
+
+bool cfg_reader::tag( const char *lit )
+{
+	const char *p = pos;
+
+	while ( isspace( ( unsigned char ) *p ) )
+		++p;
+
+	if ( strncmp( p, lit, strlen( lit ) ) )
+		return false;
+
+	pos = p + strlen( lit );
+	return true;
+}
+
+
 /****************************************************
 OBJECT::LOAD_PARAM
+Load the instances numbers and the elements data of
+all the instances of this object type, in a single
+pass, from the first instance in each group (heads)
 ****************************************************/
-bool object::load_param( const char *file_name, int repl, FILE *f )
+bool object::load_param( cfg_reader &in, o_vecT &heads )
 {
 	char str[ MAX_ELEM_LENGTH ], ch, ch1, ch2;
-	int num, i;
-	double app;
-	fpos_t pos;
+	int i, j, num, rows, cols, upd[ 4 ], sav[ 4 ], sto = 0;
+	bool has_upd, has_sav, has_sto;
 	bridge *cb;
 	object *cur;
 	variable *cv, *cv1;
+	o_vecT inst, sons;
+	v_vecT vars;
 
-	if ( f == NULL )
-		f = search_data_str( file_name, "DATA", label );
-	else
-	{
-		fscanf( f, "%99s", str );		// skip the 'Object: '
-		fscanf( f, " %99s", str );		// skip the 'label'
-	}
-
-	if ( f == NULL )
-		return false;
+	in.word( str, MAX_ELEM_LENGTH );	// skip the 'Object: '
+	in.word( str, MAX_ELEM_LENGTH );	// skip the 'label'
 
-	if ( fscanf( f, " %c", &ch ) != 1 )
+	if ( ! in.get( & ch ) )
 		return false;
 
-	if ( ch == 'C' )
-		to_compute = true;
-	else
-		to_compute = false;
+	to_compute = ( ch == 'C' ) ? true : false;
 
-	for ( cur = this; cur != NULL; cur = cur->hyper_next( cur->label ) )
+	// create the instances of each group and list all of them
+	for ( auto head : heads )
 	{
-		if ( fscanf( f, "\t%d", &num ) != 1 )
+		if ( ! in.get( & num ) )
 			return false;
-		cur->to_compute = to_compute;
-		cur->replicate( num );
-		for ( ; go_brother( cur ) != NULL; cur = cur->next );
+
+		head->to_compute = to_compute;
+		head->replicate( num );
+
+		for ( cur = head; cur != NULL; cur = go_brother( cur ) )
+		{
+			inst.push_back( cur );
+			vars.push_back( cur->v );
+		}
 	}
 
 	for ( cv = v; cv != NULL; cv = cv->next )
 	{
-		fscanf( f, "%99s ", str );		// skip the 'Element: '
-		fscanf( f, "%99s ", str );		// skip the 'label'
+		in.word( str, MAX_ELEM_LENGTH );	// skip the 'Element: '
+		in.word( str, MAX_ELEM_LENGTH );	// skip the 'label'
 
-		if ( f == NULL )
+		if ( ! in.get( & cv->num_lag ) || ! in.get( & ch1 ) || ! in.get( & ch ) || ! in.get( & cv->debug ) || ! in.get( & ch2 ) )
 			return false;
 
-		if ( fscanf( f, "%d %c %c %c %c", &( cv->num_lag ), &ch1, &ch, &( cv->debug ), &ch2	  ) != 5 )
+		// check for array dimensions
+		if ( in.tag( "<dim:" ) )
+		{
+			if ( ! in.get( & rows ) || ! in.get( & cols ) || rows <= 0 || cols <= 0 )
+				return false;
+
+			in.tag( ">" );
+		}
+		else
+			rows = cols = 0;
+
+		// check for values in the sidecar file
+		if ( in.tag( "<bin:" ) && ! in.read_bin( ( long ) inst.size( ) * ( cv->param == 1 ? 1 : cv->num_lag ) * ( rows > 0 ? ( long ) rows * cols : 1 ) ) )
 			return false;
 
 		cv->save = ( tolower( ch1 ) == 's' ) ? true : false;
@@ -237,9 +521,15 @@ bool object::load_param( const char *file_name, int repl, FILE *f )
 		cv->plot = ( tolower( ch2 ) == 'p' ) ? true : false;
 		cv->parallel = ( ch2 == 'P' || ch2 == 'N' ) ? true : false;
 
-		for ( cur = this; cur != NULL; repl == 1 ? cur = cur->hyper_next( label ) : cur = NULL )
+		for ( j = 0; j < ( int ) inst.size( ); ++j )
 		{
-			cv1 = cur->search_var( NULL, cv->label );
+			// variables are in the same order in all instances
+			cv1 = vars[ j ];
+			if ( cv1 == NULL || strcmp( cv1->label, cv->label ) )
+				cv1 = inst[ j ]->search_var( NULL, cv->label );
+
+			vars[ j ] = cv1->next;
+
 			cv1->val = new double[ cv->num_lag + 1 ];
 			cv1->num_lag = cv->num_lag;
 			cv1->save = cv->save;
@@ -250,54 +540,107 @@ bool object::load_param( const char *file_name, int repl, FILE *f )
 			cv1->debug = cv->debug;
 			cv1->data_loaded = ch;
 
-			if ( cv1->param == 1 )
+			if ( rows > 0 )
 			{
-				if ( fscanf( f, "%lf", &app ) != 1 )
-					return false;
-				else
-					cv1->val[ 0 ] = app;
+				cv1->set_dim( rows, cols );
+
+				for ( i = 0; i <= cv->num_lag; ++i )
+					cv1->val[ i ] = 0;
+
+				for ( i = 0; i < ( cv1->param == 1 ? 1 : cv->num_lag ) * rows * cols; ++i )
+					if ( ! in.get( & cv1->arr[ i ] ) )
+						return false;
 			}
 			else
-			{
-				for ( i = 0; i < cv->num_lag; ++i )
-					if ( fscanf( f, "\t%lf", &app ) != 1 )
+				if ( cv1->param == 1 )
+				{
+					if ( ! in.get( & cv1->val[ 0 ] ) )
 						return false;
-					else
-						// place values shifted one position, since they are "time 0" values
-						cv1->val[ i ] = app;
+				}
+				else
+				{
+					// place values shifted one position, since they are "time 0" values
+					for ( i = 0; i < cv->num_lag; ++i )
+						if ( ! in.get( & cv1->val[ i ] ) )
+							return false;
 
-				cv1->val[ cv->num_lag ] = 0;
-			}
+					cv1->val[ cv->num_lag ] = 0;
+				}
 		}
 
+		if ( in.bin_left( ) )				// sidecar values mismatch
+			return false;
+
 		// check for non-default updating scheme
-		if ( cv->param == 0 )
+		has_upd = cv->param == 0 && in.tag( "<upd:" );
+		if ( has_upd )
 		{
-			fgetpos( f, & pos );
-			num = fscanf( f, "\t<upd: %d %d %d %d>", & cv->delay, & cv->delay_range, & cv->period, & cv->period_range );
+			for ( i = 0; i < 4; ++i )
+				if ( ! in.get( & upd[ i ] ) )
+					return false;
 
-			if ( num > 0 && num < 4 )
+			in.tag( ">" );
+		}
+
+		// check for non-default saved data storage
+		has_sto = in.tag( "<sto:" );
+		if ( has_sto )
+		{
+			if ( ! in.get( & sto ) )
 				return false;
 
-			if ( num > 0 )
-				for ( cur = this; cur != NULL; repl == 1 ? cur = cur->hyper_next( label ) : cur = NULL )
+			in.tag( ">" );
+		}
+
+		// check for non-default saving policy
+		has_sav = in.tag( "<sav:" );
+		if ( has_sav )
+		{
+			for ( i = 0; i < 4; ++i )
+				if ( ! in.get( & sav[ i ] ) )
+					return false;
+
+			in.tag( ">" );
+		}
+
+		if ( has_upd || has_sto || has_sav )
+			for ( auto obj : inst )
+			{
+				cv1 = obj->search_var( NULL, cv->label );
+
+				if ( has_upd )
 				{
-					cv1 = cur->search_var( NULL, cv->label );
-					cv1->delay = cv->delay;
-					cv1->delay_range = cv->delay_range;
-					cv1->period = cv->period;
-					cv1->period_range = cv->period_range;
+					cv1->delay = upd[ 0 ];
+					cv1->delay_range = upd[ 1 ];
+					cv1->period = upd[ 2 ];
+					cv1->period_range = upd[ 3 ];
 				}
-			else
-				fsetpos( f, & pos );
-		}
+
+				if ( has_sto )
+					cv1->save_fmt = sto;
+
+				if ( has_sav )
+				{
+					cv1->save_every = sav[ 0 ];
+					cv1->save_from = sav[ 1 ];
+					cv1->save_to = sav[ 2 ];
+					cv1->save_last = sav[ 3 ];
+				}
+			}
 	}
 
+	// descendants are loaded from the first instance in each instance of this
 	for ( cb = b; cb != NULL; cb = cb->next )
 	{
-		if ( cb->head == NULL || ! cb->head->load_param( file_name, repl, f ) )
+		if ( cb->head == NULL )
+			return false;
+
+		sons.clear( );
+		for ( auto obj : inst )
+			sons.push_back( obj->search_bridge( cb->blabel )->head );
+
+		if ( ! cb->head->load_param( in, sons ) )
 			return false;
-		num = 0;
 	}
 
 	if ( up == NULL )	// this is the root, and therefore the end of the loading
@@ -310,47 +653,45 @@ bool object::load_param( const char *file_name, int repl, FILE *f )
 /****************************************************
 OBJECT::LOAD_STRUCT
 ****************************************************/
-bool object::load_struct( FILE *f )
+bool object::load_struct( cfg_reader &in )
 {
 	int i = 0;
 	char ch[ MAX_ELEM_LENGTH ];
 	bridge *cb;
 	variable *cv;
 
-	fscanf( f, "%99s", ch );
+	in.word( ch, MAX_ELEM_LENGTH );
 	while ( strcmp( ch, "Label" ) && ++i < MAX_FILE_TRY )
-		fscanf( f,"%99s", ch );
+		in.word( ch, MAX_ELEM_LENGTH );
 
 	if ( i >= MAX_FILE_TRY )
 		return false;
 
-	fscanf( f, "%99s", ch );
+	in.word( ch, MAX_ELEM_LENGTH );
 	if ( label == NULL )
-	{
-		label = new char[ strlen( ch ) + 1 ];
-		strcpy( label, ch );
-	}
+		set_layout( ch );
 
 	i = 0;
-	fscanf( f, "%*[{\r\t\n]%99s", ch );
+	in.skip( "{\r\t\n" );
+	in.word( ch, MAX_ELEM_LENGTH );
 	while ( strcmp( ch, "}" ) && ++i < MAX_FILE_TRY )
 	{
 		if ( ! strcmp( ch, "Son:" ) )
 		{
-			fscanf( f, "%*[ ]%99s", ch );
+			in.word( ch, MAX_ELEM_LENGTH );
 			add_obj( ch, 1, 0 );
 			cmd( "lappend modObj %s", ch );
 
 			// find the bridge which contains the object
 			cb = search_bridge( ch );
 
-			if ( cb->head == NULL || ! cb->head->load_struct( f ) )
+			if ( cb->head == NULL || ! cb->head->load_struct( in ) )
 				return false;
 		}
 
 		if ( ! strcmp( ch, "Var:" ) )
 		{
-			fscanf( f, "%*[ ]%99s", ch );
+			in.word( ch, MAX_ELEM_LENGTH );
 			add_empty_var( ch );
 			cmd( "lappend modElem %s", ch );
 			cmd( "lappend modVar %s", ch );
@@ -358,7 +699,7 @@ bool object::load_struct( FILE *f )
 
 		if ( ! strcmp( ch, "Param:" ) )
 		{
-			fscanf( f, "%*[ ]%99s", ch );
+			in.word( ch, MAX_ELEM_LENGTH );
 			cv = add_empty_var( ch );
 			cv->param = 1;
 			cmd( "lappend modElem %s", ch );
@@ -367,14 +708,15 @@ bool object::load_struct( FILE *f )
 
 		if ( ! strcmp( ch, "Func:" ) )
 		{
-			fscanf( f, "%*[ ]%99s", ch );
+			in.word( ch, MAX_ELEM_LENGTH );
 			cv = add_empty_var( ch );
 			cv->param = 2;
 			cmd( "lappend modElem %s", ch );
 			cmd( "lappend modFun %s", ch );
 		}
 
-		fscanf( f, "%*[{\r\t\n]%99s", ch );
+		in.skip( "{\r\t\n" );
+		in.word( ch, MAX_ELEM_LENGTH );
 	}
 
 	if ( i >= MAX_FILE_TRY )
@@ -601,6 +943,8 @@ int load_configuration( bool reload, int quick )
 	object *cur;
 	variable *cv, *cv1;
 	description *cd;
+	cfg_reader in;
+	o_vecT heads;
 	FILE *f, *g;
 
 	unload_configuration( false );				// unload current
@@ -608,6 +952,14 @@ int load_configuration( bool reload, int quick )
 	if ( strlen( simul_name ) == 0 )
 		return 1;
 
+	if ( reload && quick == 2 && init_state.ready( ) )
+	{											// restore from memory, if possible
+		init_state.restore( root );
+		struct_loaded = true;
+		t = 0;
+		return 0;
+	}
+
 	if ( ! reload || strlen( struct_file ) == 0 )
 	{
 		delete [ ] struct_file;
@@ -619,7 +971,15 @@ int load_configuration( bool reload, int quick )
 	if ( f == NULL )
 		return 1;
 
-	struct_loaded = root->load_struct( f );
+	if ( ! in.read( f ) )
+	{
+		load = 2;
+		goto endLoad;
+	}
+
+	in.set_bin( cfg_bin_file( struct_file ) );
+	heads.push_back( root );
+	struct_loaded = root->load_struct( in );
 	if ( ! struct_loaded )
 	{
 		load = 2;
@@ -627,13 +987,15 @@ int load_configuration( bool reload, int quick )
 	}
 
 	strcpy( msg, "" );
-	fscanf( f, "%999s", msg );					// should be DATA
-	if ( ! ( ! strcmp( msg, "DATA" ) && root->load_param( struct_file, 1, f ) ) )
+	in.word( msg, MAX_LINE_SIZE );				// should be DATA
+	if ( ! ( ! strcmp( msg, "DATA" ) && root->load_param( in, heads ) ) )
 	{
 		load = 3;
 		goto endLoad;
 	}
 
+	fseek( f, in.tell( ), SEEK_SET );			// continue after the data
+
 	if ( reload && quick == 2 )					// just quick reload?
 		goto endLoad;
 
@@ -655,7 +1017,7 @@ int load_configuration( bool reload, int quick )
 
 	max_step = 100;
 	when_debug = stack_info = prof_min_msecs = 0;
-	prof_obs_only = prof_aggr_time = no_ptr_chk = parallel_disable = 0;
+	prof_obs_only = prof_aggr_time = no_ptr_chk = parallel_disable = bin_values = 0;
 	fscanf( f, "%999s", msg );					// should be MAX_STEP
 	if ( strcmp( msg, "MAX_STEP" ) )
 	{
@@ -663,15 +1025,15 @@ int load_configuration( bool reload, int quick )
 		goto endLoad;
 	}
 
-	if ( fgets( msg, MAX_LINE_SIZE, f ) == NULL )// should be 1 to 8 values
+	if ( fgets( msg, MAX_LINE_SIZE, f ) == NULL )// should be 1 to 9 values
 	{
 		load = 6;
 		goto endLoad;
 	}
 
-	i = sscanf( msg, "%d %d %d %d %d %d %d %d", & max_step, & when_debug, & stack_info, & prof_min_msecs, & prof_obs_only, & prof_aggr_time, & no_ptr_chk, & parallel_disable );
+	i = sscanf( msg, "%d %d %d %d %d %d %d %d %d", & max_step, & when_debug, & stack_info, & prof_min_msecs, & prof_obs_only, & prof_aggr_time, & no_ptr_chk, & parallel_disable, & bin_values );
 
-	if ( i < 1 || max_step <= 0 || when_debug < 0 || stack_info < 0 || prof_min_msecs < 0 || prof_obs_only < 0 || prof_obs_only > 1 || prof_aggr_time < 0 || prof_aggr_time > 1 || no_ptr_chk < 0 || no_ptr_chk > 1 || parallel_disable < 0 || parallel_disable > 1 )
+	if ( i < 1 || max_step <= 0 || when_debug < 0 || stack_info < 0 || prof_min_msecs < 0 || prof_obs_only < 0 || prof_obs_only > 1 || prof_aggr_time < 0 || prof_aggr_time > 1 || no_ptr_chk < 0 || no_ptr_chk > 1 || parallel_disable < 0 || parallel_disable > 1 || bin_values < 0 || bin_values > 1 )
 	{
 		load = 6;
 		goto endLoad;
@@ -894,844 +1256,3252 @@ void unload_configuration ( bool full )
 }
 
 
+/***************************************************
+Configuration snapshot
+
+The structure and the initial values of a loaded
+configuration, kept in memory to set up the next
+runs of a set of simulations without reading and
+parsing the configuration file again. Each object
+type (and its variables settings) is stored once,
+as the loading process makes them equal among the
+instances, followed by the instance counts and the
+variables values, in tree order.
+***************************************************/
+
 /*********************************
-SAVE_SINGLE
+SNAPSHOT::TAKE
+Store the tree under root r
 *********************************/
-void save_single( variable *v )
+void snapshot::take( object *r )
 {
-	char fn[ MAX_PATH_LENGTH ];
-	int i;
-	FILE *f;
+	clear( );
+	put_type( r );
+	put_obj( r, 0 );
+}
 
-#ifndef _NP_
-	// prevent concurrent use by more than one thread
-	rec_lguardT lock( v->parallel_comp );
-#endif
 
-	set_lab_tit( v );
-	snprintf( fn, MAX_PATH_LENGTH, "%s_%s-%d_%d_seed-%d.res", v->label, v->lab_tit, v->start, v->end, seed - 1 );
-	f = fopen( fn, "wt" );			// use text mode for Windows better compatibility
+/*********************************
+SNAPSHOT::PUT_TYPE
+*********************************/
+int snapshot::put_type( object *r )
+{
+	int son, type = types.size( );
+	bridge *cb;
+	variable *cv;
+	snap_var sv;
 
-	fprintf( f, "%s %s (%d %d)\t\n", v->label, v->lab_tit, v->start, v->end );
+	types.emplace_back( );
+	types[ type ].label = r->label;
+	types[ type ].to_compute = r->to_compute;
 
-	for ( i = 0; i <= t - 1; ++i )
-		if ( i >= v->start && i <= v->end && ! is_nan( v->data[ i - v->start ] ) )	// save NaN as n/a
-			fprintf( f,"%lf\t\n", v->data[ i - v->start ] );
-		else
-			fprintf( f,"%s\t\n", nonavail );
+	for ( cv = r->v; cv != NULL; cv = cv->next )
+	{
+		sv.label = cv->label;
+		sv.data_loaded = cv->data_loaded;
+		sv.debug = cv->debug;
+		sv.parallel = cv->parallel;
+		sv.plot = cv->plot;
+		sv.save = cv->save;
+		sv.savei = cv->savei;
+		sv.rows = cv->arr != NULL ? cv->rows : 0;
+		sv.cols = cv->arr != NULL ? cv->cols : 0;
+		sv.delay = cv->delay;
+		sv.delay_range = cv->delay_range;
+		sv.num_lag = cv->num_lag;
+		sv.param = cv->param;
+		sv.period = cv->period;
+		sv.period_range = cv->period_range;
+		sv.save_every = cv->save_every;
+		sv.save_fmt = cv->save_fmt;
+		sv.save_from = cv->save_from;
+		sv.save_last = cv->save_last;
+		sv.save_to = cv->save_to;
+		types[ type ].vars.push_back( sv );
+	}
 
-	fclose( f );
+	for ( cb = r->b; cb != NULL; cb = cb->next )
+	{
+		son = put_type( cb->head != NULL ? cb->head : blueprint->search( cb->blabel ) );
+		types[ type ].sons.push_back( son );
+	}
+
+	return type;
 }
 
 
-/*****************************************************************************
-SAVE_CONFIGURATION
-	Save current defined configuration (adding tag index if appropriate)
-	If quick is true, just the structure and the parameters is saved
-	Returns: true: save ok, false: save failure
-******************************************************************************/
-bool save_configuration( int findex, const char *dest_path, bool quick )
+/*********************************
+SNAPSHOT::PUT_OBJ
+*********************************/
+void snapshot::put_obj( object *r, int type )
 {
-	bool save_ok = false;
-	int delta, indexDig, save_len;
-	char ch[ MAX_PATH_LENGTH ], *save_file, *bak_file = NULL;
-	const char *save_path;
-	description *cd;
-	FILE *f;
+	int n;
+	size_t cnt;
+	bridge *cb;
+	object *cur;
+	variable *cv;
 
-	delta = ( findex > 0 ) ? sim_num * ( findex - 1 ) : 0;
-	indexDig = ( findex > 0 ) ? ( int ) floor( log10( findex ) + 2 ) : 0;
+	for ( cv = r->v; cv != NULL; cv = cv->next )
+	{
+		vals.insert( vals.end( ), cv->val, cv->val + cv->num_lag + 1 );
 
-	if ( dest_path == NULL )
-		save_path = path;
-	else
-		save_path = dest_path;
+		if ( cv->arr != NULL )
+			vals.insert( vals.end( ), cv->arr, cv->arr + ( cv->num_lag + 1 ) * cv->rows * cv->cols );
+	}
 
-	if ( strlen( simul_name ) == 0 )
+	for ( n = 0, cb = r->b; cb != NULL; cb = cb->next, ++n )
 	{
-		delete [ ] simul_name;
-		simul_name = new char[ strlen( DEF_CONF_FILE ) + 1 ];
-		strcpy( simul_name, DEF_CONF_FILE );
-	}
+		cnt = counts.size( );
+		counts.push_back( 0 );
 
-	if ( strlen( name_rep ) == 0 )
-		snprintf( name_rep, MAX_PATH_LENGTH, "report_%s.html", simul_name );
-
-	if ( strlen( path ) > 0 )
-	{
-		save_len = strlen( save_path ) + strlen( simul_name ) + 6 + indexDig;
-		save_file = new char[ save_len ];
-		sprintf( save_file, "%s/%s", save_path, simul_name );
+		for ( cur = cb->head; cur != NULL; cur = cur->next )
+		{
+			++counts[ cnt ];
+			put_obj( cur, types[ type ].sons[ n ] );
+		}
 	}
-	else
+}
+
+
+/*********************************
+SNAPSHOT::RESTORE
+Rebuild the tree under the empty
+root r, as load_configuration
+*********************************/
+void snapshot::restore( object *r )
+{
+	cnt_pos = val_pos = 0;
+	get_obj( r, 0 );
+
+#ifndef _NW_
+	for ( auto &ty : types )
 	{
-		save_len = strlen( simul_name ) + 6 + indexDig;
-		save_file = new char[ save_len ];
-		sprintf( save_file, "%s", simul_name );
+		if ( &ty != &types[ 0 ] )
+			cmd( "lappend modObj %s", ty.label.c_str( ) );
+
+		for ( auto &sv : ty.vars )
+			cmd( "lappend modElem %s; lappend %s %s", sv.label.c_str( ), sv.param == 1 ? "modPar" : sv.param == 2 ? "modFun" : "modVar", sv.label.c_str( ) );
 	}
+#endif
 
-	if ( findex > 0 )
+	set_blueprint( blueprint, r );
+}
+
+
+/*********************************
+SNAPSHOT::GET_OBJ
+*********************************/
+void snapshot::get_obj( object *r, int type )
+{
+	int i, n;
+	bridge *cb, *last_b = NULL;
+	object *cur, *last;
+	variable *cv, *last_v = NULL;
+	snap_type *ty = & types[ type ];
+
+	r->to_compute = ty->to_compute;
+
+	for ( auto &sv : ty->vars )
 	{
-		snprintf( ch, MAX_PATH_LENGTH, "_%d.lsd", findex );
-		strcatn( save_file, ch, save_len );
+		cv = new variable;
+		if ( last_v == NULL )
+			r->v = cv;
+		else
+			last_v->next = cv;
+		last_v = cv;
+
+		cv->init( r, sv.label.c_str( ), sv.num_lag, vals.data( ) + val_pos, sv.save );
+		val_pos += sv.num_lag + 1;
+
+		cv->savei = sv.savei;
+		cv->plot = sv.plot;
+		cv->parallel = sv.parallel;
+		cv->param = sv.param;
+		cv->debug = sv.debug;
+		cv->data_loaded = sv.data_loaded;
+		cv->delay = sv.delay;
+		cv->delay_range = sv.delay_range;
+		cv->period = sv.period;
+		cv->period_range = sv.period_range;
+		cv->save_fmt = sv.save_fmt;
+		cv->save_every = sv.save_every;
+		cv->save_from = sv.save_from;
+		cv->save_to = sv.save_to;
+		cv->save_last = sv.save_last;
+
+		if ( sv.rows > 0 )
+		{
+			cv->set_dim( sv.rows, sv.cols );
+			n = ( sv.num_lag + 1 ) * sv.rows * sv.cols;
+			memcpy( cv->arr, vals.data( ) + val_pos, n * sizeof( double ) );
+			val_pos += n;
+		}
+
+		r->map_var( cv->label, cv );
 	}
-	else
+
+	for ( auto son : ty->sons )
 	{
-		// create backup file when not indexed saving
-		bak_file = new char[ strlen( save_file ) + 5 ];
-		sprintf( bak_file, "%s.bak", save_file );
+		cb = new bridge( types[ son ].label.c_str( ) );
+		if ( last_b == NULL )
+			r->b = cb;
+		else
+			last_b->next = cb;
+		last_b = cb;
 
-		strcatn( save_file, ".lsd", save_len );
+		r->map_bridge( cb->blabel, cb );
 
-		f = fopen( save_file, "r" );
-		if ( f != NULL )
+		for ( last = NULL, i = 0, n = counts[ cnt_pos++ ]; i < n; ++i, last = cur )
 		{
-			fclose( f );
+			cur = new object;
+			cur->init( r, cb->blabel, types[ son ].to_compute );
 
-			f = fopen( bak_file, "r" );
-			if ( f != NULL )
-			{
-				fclose( f );
-				if( remove( bak_file ) )
-					goto error;
-			}
+			if ( last == NULL )
+				cb->head = cur;
+			else
+				last->next = cur;
 
-			if ( rename( save_file, bak_file ) )
-				goto error;
+			get_obj( cur, son );
 		}
 	}
+}
 
-	f = fopen( save_file, "wb" );
-	if ( f == NULL )
-		goto error;
 
-	root->save_struct( f, "" );
-	fprintf( f, "\nDATA\n" );
-	root->save_param( f );
+/*********************************
+SNAPSHOT::CLEAR
+*********************************/
+void snapshot::clear( void )
+{
+	types.clear( );
+	counts.clear( );
+	vals.clear( );
+	counts.shrink_to_fit( );
+	vals.shrink_to_fit( );
+}
 
-	fprintf( f, "\nSIM_NUM %d\nSEED %d\nMAX_STEP %d", sim_num, seed + delta, max_step );
 
-	if ( when_debug > 0 || stack_info > 0 || prof_min_msecs > 0 || prof_obs_only || prof_aggr_time || no_ptr_chk || parallel_disable )
-		fprintf( f, " %d %d %d %d %d %d %d", when_debug, stack_info, prof_min_msecs, prof_obs_only ? 1 : 0, prof_aggr_time ? 1 : 0, no_ptr_chk ? 1 : 0, parallel_disable ? 1 : 0 );
+/***************************************************
+Monte Carlo statistics
+
+Cross-run statistics of the saved series (mean,
+standard error, maximum and minimum), per series
+and time step, accumulated as each run ends, so
+the per-run results files are not needed. Each
+run value and the partial statistics of parallel
+runs, saved to binary files, are merged pairwise
+(Chan et al.) by the same update, so sequential
+and parallel runs merged in seed order produce
+the same statistics. Series are named as the
+columns of the .csv results files read by
+lsd_mcstats (label_tag, or just label in single
+instance objects), and identified by the name and
+its repetition count in the run, so a column of a
+deleted object is not mixed with the same named
+column of a new one, in order of first appearance.
+***************************************************/
 
-	fprintf( f, "\nEQUATION %s\nMODELREPORT %s\n", equation_name, name_rep );
+/*********************************
+MC_MERGE
+Merge the statistics of cell b
+into cell a
+*********************************/
+static void mc_merge( mc_cell &a, const mc_cell &b )
+{
+	double d, nn;
 
-	if ( ! quick )
+	if ( b.n == 0 )
+		return;
+
+	if ( a.n == 0 )
 	{
-		fprintf( f, "\nDESCRIPTION\n\n" );
-		save_description( root, f );
+		a = b;
+		return;
+	}
 
-		fprintf( f, "\nDOCUOBSERVE\n" );
-		for ( cd = descr; cd != NULL; cd = cd->next )
-			if ( cd->observe == 'y' )
-				fprintf( f, "%s\n", cd->label );
-		fprintf( f, "\nEND_DOCUOBSERVE\n\n" );
+	nn = a.n + b.n;
+	d = b.mean - a.mean;
+	a.mean += d * b.n / nn;
+	a.m2 += b.m2 + d * d * a.n * b.n / nn;
+	a.max = max( a.max, b.max );
+	a.min = min( a.min, b.min );
+	a.n = nn;
+}
 
-		fprintf( f, "\nDOCUINITIAL\n" );
-		for ( cd = descr; cd != NULL; cd = cd->next )
-			if ( cd->initial == 'y' )
-				fprintf( f, "%s\n", cd->label );
-		fprintf( f, "\nEND_DOCUINITIAL\n\n" );
 
-		save_eqfile( f );
-	}
+/*********************************
+MC_STATS::COL
+Get the column of a series,
+adding it if new
+*********************************/
+size_t mc_stats::col( const string &name, const string &head )
+{
+	auto it = cols.find( name );
 
-	if ( ! ferror( f ) )
-	{
-		save_ok = true;
+	if ( it != cols.end( ) )
+		return it->second;
 
-#ifndef _NW_
-		cmd( "set lastConf [ string map -nocase { \"%s/\" \"\" } [ file normalize \"%s\" ] ]", exec_path, struct_file );
-#endif
-	}
+	names.push_back( name );
+	heads.push_back( head );
+	cells.push_back( vector < mc_cell > ( ) );
+	cols[ name ] = names.size( ) - 1;
 
-	fclose( f );
+	return names.size( ) - 1;
+}
 
-	error:
 
-	delete [ ] save_file;
-	delete [ ] bak_file;
+/*********************************
+MC_STATS::ADD_SERIES
+Add the values of a series in
+a period, skipping n/a values
+*********************************/
+void mc_stats::add_series( const string &head, int start, int end, function < double ( int ) > val )
+{
+	double x;
+	int i;
+	vector < mc_cell > &c = cells[ col( head + "#" + to_string( seen[ head ]++ ), head ) ];
 
-	return save_ok;
+	if ( ( int ) c.size( ) < end )
+		c.resize( end, mc_cell { 0, 0, 0, 0, 0 } );
+
+	for ( i = max( start, 1 ); i <= end; ++i )
+	{
+		x = val( i );
+		if ( ! isfinite( x ) )
+			continue;
+
+		mc_merge( c[ i - 1 ], mc_cell { 1, x, 0, x, x } );
+	}
 }
 
 
-/*****************************************************************************
-LOAD_SENSITIVITY
-	Load defined sensitivity analysis configuration
-	Returns: 0: load ok, 1,2,3,4,...: load failure
-******************************************************************************/
-int load_sensitivity( FILE *f )
+/*********************************
+MC_STATS::ADD
+Add the saved series of the
+current run, alive or deleted
+*********************************/
+void mc_stats::add( object *root, int endtstep )
 {
-	int i;
-	char cc, lab[ MAX_ELEM_LENGTH ];
-	variable *cv;
-	sense *cs = rsense;
+	char elem[ MAX_ELEM_LENGTH ];
+	int k;
 
-	// read data from file (1 line per element, '#' indicate comment)
-	while ( ! feof( f ) )
-	{	// read element by element, skipping comments
-		fscanf( f, "%99s", lab );			// read string
-		while ( lab[ 0 ] == '#' )			// start of a comment
+	seen.clear( );
+	add_obj( root, endtstep );
+
+	for ( grave &cg : cemetery.graves )
+	{
+		add_series( string( cg.label ) + "_" + cg.lab_tit, cg.start, min( cg.end, endtstep ), [ & cg ]( int i ) { return cg.get_data( i ); } );
+
+		for ( k = 0; k < cg.rows * cg.cols; ++k )
 		{
-			do								// jump to next line
-				cc = fgetc( f );
-			while ( ! feof( f ) && cc != '\n' );
-			fscanf( f, "%99s", lab );		// try again
+			if ( cg.cols == 1 )
+				snprintf( elem, MAX_ELEM_LENGTH, "%s_%d_%s", cg.label, k + 1, cg.lab_tit );
+			else
+				snprintf( elem, MAX_ELEM_LENGTH, "%s_%d_%d_%s", cg.label, k % cg.rows + 1, k / cg.rows + 1, cg.lab_tit );
+
+			add_series( elem, cg.start, min( cg.end, endtstep ), [ & cg, k ]( int i ) { return cg.get_arr( i, k ); } );
 		}
+	}
 
-		if ( feof( f ) )					// ended too early?
-			break;
+	last = max( last, endtstep );
+	++runs;
+}
 
-		cv = root->search_var( root, lab );
-		if ( cv == NULL || ( cv->param != 1 && cv->num_lag == 0 ) )
-			goto error1;					// and not parameter or lagged variable
+void mc_stats::add_obj( object *r, int endtstep )
+{
+	bool single = false;
+	char elem[ MAX_ELEM_LENGTH ];
+	int k, n;
+	bridge *cb;
+	object *cur;
+	variable *cv;
 
-		// create memory allocation for new variable
-		if ( rsense == NULL )				// allocate first element
-			rsense = cs = new sense;
-		else								// allocate next ones
+	for ( cv = r->v; cv != NULL; cv = cv->next )
+		if ( cv->save == 1 )
 		{
-			cs->next = new sense;
-			cs = cs->next;
+			set_lab_tit( cv );
+			single = single || single_lab_tit( cv );	// no suffix, as in .csv results
+			add_series( single ? string( cv->label ) : string( cv->label ) + "_" + cv->lab_tit, cv->start, min( cv->end, endtstep ), [ cv ]( int i ) { return cv->get_data( i ); } );
+
+			if ( cv->arr == NULL )
+				continue;
+
+			for ( n = cv->rows * cv->cols, k = 0; k < n; ++k )
+			{
+				if ( cv->cols == 1 )
+					snprintf( elem, MAX_ELEM_LENGTH, "%s_%d%s%s", cv->label, k + 1, single ? "" : "_", single ? "" : cv->lab_tit );
+				else
+					snprintf( elem, MAX_ELEM_LENGTH, "%s_%d_%d%s%s", cv->label, k % cv->rows + 1, k / cv->rows + 1, single ? "" : "_", single ? "" : cv->lab_tit );
+
+				add_series( elem, cv->start, min( cv->end, endtstep ), [ cv, k, n ]( int i ) { return ( cv->arr_data != NULL && cv->in_data( i ) ) ? cv->arr_data[ cv->data_pos( i ) * n + k ] : NAN; } );
+			}
 		}
-		cs->v = NULL;						// initialize struct pointers
-		cs->next = NULL;
 
-		cs->label = new char[ strlen( lab ) + 1 ];	// save element name
-		strcpy( cs->label, lab );
+	for ( cb = r->b; cb != NULL; cb = cb->next )
+		if ( cb->head != NULL && cb->head->to_compute )
+			for ( cur = cb->head; cur != NULL; cur = cur->next )
+				add_obj( cur, endtstep );
+}
 
-		// get lags and # of values to test
-		if ( fscanf( f, "%d %d ", &cs->lag, &cs->nvalues ) < 2 )
-			goto error2;
 
-		// get variable type (newer versions)
-		if ( fscanf( f, "%c ", &cc ) < 1 )
-			goto error3;
+/*********************************
+MC_STATS::CLEAR
+Remove all the runs statistics
+*********************************/
+void mc_stats::clear( void )
+{
+	names.clear( );
+	heads.clear( );
+	cols.clear( );
+	seen.clear( );
+	cells.clear( );
+	last = runs = 0;
+}
 
-		if ( cc == 'i' || cc == 'd' || cc == 'f' )
-		{
-			cs->integer = ( cc == 'i' ) ? true : false;
-			fscanf( f, ": " );				// remove separator
-		}
-		else
-			if ( cc == ':' )
-				cs->integer = false;
-			else
-				goto error4;
 
-		if ( cs->lag == 0 )					// adjust type and lag #
-			cs->param = 1;
-		else
-		{
-			cs->param = 0;
-			cs->lag = abs( cs->lag ) - 1;
-		}
+/*********************************
+MC_STATS::SAVE
+Write the partial statistics to
+a binary file
+*********************************/
+bool mc_stats::save( const char *fname )
+{
+	bool ok;
+	int n, order = MC_AGG_ORDER, ver = MC_AGG_VER;
+	size_t c;
+	FILE *f = fopen( fname, "wb" );
 
-		cs->v = new double[ cs->nvalues ];	// get values
-		for ( i = 0; i < cs->nvalues; ++i )
-			if ( ! fscanf( f, "%lf", &cs->v[ i ] ) )
-				goto error5;
-			else
-				if ( cs->integer )
-					cs->v[ i ] = round( cs->v[ i ] );
+	if ( f == NULL )
+		return false;
+
+	n = names.size( );
+	ok = fwrite( MC_AGG_MAGIC, 1, strlen( MC_AGG_MAGIC ) + 1, f ) == strlen( MC_AGG_MAGIC ) + 1;
+	ok = ok && fwrite( & ver, sizeof ver, 1, f ) == 1 && fwrite( & order, sizeof order, 1, f ) == 1;
+	ok = ok && fwrite( & runs, sizeof runs, 1, f ) == 1 && fwrite( & last, sizeof last, 1, f ) == 1;
+	ok = ok && fwrite( & n, sizeof n, 1, f ) == 1;
+
+	for ( c = 0; ok && c < names.size( ); ++c )
+	{
+		n = names[ c ].size( );
+		ok = fwrite( & n, sizeof n, 1, f ) == 1 && fwrite( names[ c ].c_str( ), 1, n, f ) == ( size_t ) n;
+
+		n = heads[ c ].size( );
+		ok = ok && fwrite( & n, sizeof n, 1, f ) == 1 && fwrite( heads[ c ].c_str( ), 1, n, f ) == ( size_t ) n;
+
+		n = cells[ c ].size( );
+		ok = ok && fwrite( & n, sizeof n, 1, f ) == 1 && fwrite( cells[ c ].data( ), sizeof( mc_cell ), n, f ) == ( size_t ) n;
 	}
 
-	return 0;
+	ok = ( fclose( f ) == 0 ) && ok;
 
-	// error handling
-	error1:
-		if ( cv != NULL )
-			cmd( "ttk::messageBox -parent . -title Error -icon error -type ok -message \"Invalid lag selected\" -detail \"Variable '%s' has no lags set.\"", lab );
-		i = 1;
-		goto error;
-	error2:
-		cmd( "ttk::messageBox -parent . -title Error -icon error -type ok -message \"Invalid range\" -detail \"Element '%s' has less than two values to test.\"", lab );
-		i = 2;
-		goto error;
-	error3:
-		cmd( "ttk::messageBox -parent . -title Error -icon error -type ok -message \"Invalid element type\" -detail \"Element '%s' has an invalid value set.\"", lab );
-		i = 3;
-		goto error;
-	error4:
-		cmd( "ttk::messageBox -parent . -title Error -icon error -type ok -message \"Missing separator\" -detail \"Element '%s' has no separator character (':').\"", lab );
-		i = 4;
-		goto error;
-	error5:
-		cmd( "ttk::messageBox -parent . -title Error -icon error -type ok -message \"Invalid range value\" -detail \"Element '%s' has non-numeric range values.\"", lab );
-		i = 5;
-		goto error;
+	if ( ! ok )
+		remove( fname );
 
-	error:
-	empty_sensitivity( rsense );		// discard read data
-	rsense = NULL;
+	return ok;
+}
+
+
+/*********************************
+MC_STATS::LOAD
+Merge the partial statistics in
+a binary file
+*********************************/
+bool mc_stats::load( const char *fname )
+{
+	char magic[ strlen( MC_AGG_MAGIC ) + 1 ];
+	int i, j, n, cnt, fruns, flast, order, ver;
+	bool ok;
+	string name, head;
+	vector < mc_cell > vals;
+	FILE *f = fopen( fname, "rb" );
+
+	if ( f == NULL )
+		return false;
+
+	ok = fread( magic, 1, sizeof magic, f ) == sizeof magic && ! memcmp( magic, MC_AGG_MAGIC, sizeof magic );
+	ok = ok && fread( & ver, sizeof ver, 1, f ) == 1 && ver == MC_AGG_VER;
+	ok = ok && fread( & order, sizeof order, 1, f ) == 1 && order == MC_AGG_ORDER;
+	ok = ok && fread( & fruns, sizeof fruns, 1, f ) == 1 && fread( & flast, sizeof flast, 1, f ) == 1;
+	ok = ok && fread( & cnt, sizeof cnt, 1, f ) == 1 && cnt >= 0;
+
+	for ( i = 0; ok && i < cnt; ++i )
+	{
+		ok = fread( & n, sizeof n, 1, f ) == 1 && n >= 0 && n < MAX_PATH_LENGTH;
+		name.resize( ok ? n : 0 );
+		ok = ok && fread( & name[ 0 ], 1, n, f ) == ( size_t ) n;
+
+		ok = ok && fread( & n, sizeof n, 1, f ) == 1 && n >= 0 && n < MAX_PATH_LENGTH;
+		head.resize( ok ? n : 0 );
+		ok = ok && fread( & head[ 0 ], 1, n, f ) == ( size_t ) n;
+
+		ok = ok && fread( & n, sizeof n, 1, f ) == 1 && n >= 0 && n <= flast;
+		vals.resize( ok ? n : 0 );
+		ok = ok && fread( vals.data( ), sizeof( mc_cell ), n, f ) == ( size_t ) n;
+
+		if ( ! ok )
+			break;
+
+		vector < mc_cell > &c = cells[ col( name, head ) ];
+
+		if ( c.size( ) < vals.size( ) )
+			c.resize( vals.size( ), mc_cell { 0, 0, 0, 0, 0 } );
+
+		for ( j = 0; j < n; ++j )
+			mc_merge( c[ j ], vals[ j ] );
+	}
+
+	fclose( f );
+
+	if ( ok )
+	{
+		runs += fruns;
+		last = max( last, flast );
+	}
+
+	return ok;
+}
+
+
+/*********************************
+MC_STATS::SAVE_CSV
+Write the mean, standard error,
+maximum and minimum .csv files,
+as lsd_mcstats
+*********************************/
+bool mc_stats::save_csv( const char *base )
+{
+	const char *suffix[ ] = { "mean", "se", "max", "min" };
+	char fname[ MAX_PATH_LENGTH ], num[ MAX_ELEM_LENGTH ];
+	double val;
+	int i, s;
+	size_t c;
+	FILE *f;
+
+	for ( s = 0; s < 4; ++s )
+	{
+		snprintf( fname, MAX_PATH_LENGTH, "%s_%s.csv", base, suffix[ s ] );
+		f = fopen( fname, "wt" );
+		if ( f == NULL )
+			return false;
+
+		for ( c = 0; c < names.size( ); ++c )
+			fprintf( f, "%s%s", c > 0 ? "," : "", heads[ c ].c_str( ) );
+
+		fprintf( f, "\n" );
+
+		for ( i = 0; i < last; ++i )
+		{
+			for ( c = 0; c < names.size( ); ++c )
+			{
+				if ( i < ( int ) cells[ c ].size( ) && cells[ c ][ i ].n > 0 )
+				{
+					mc_cell &m = cells[ c ][ i ];
+
+					switch ( s )
+					{
+						case 0:
+							val = m.mean;
+							break;
+						case 1:
+							val = m.n > 1 ? sqrt( m.m2 / ( m.n - 1 ) ) / sqrt( m.n ) : NAN;
+							break;
+						case 2:
+							val = m.max;
+							break;
+						default:
+							val = m.min;
+					}
+				}
+				else
+					val = NAN;
+
+				if ( isfinite( val ) )
+				{
+					strnum( num, fabs( val ) > 2 * DBL_MIN ? val : 0, 6, 'g', sizeof( num ) );
+					fprintf( f, "%s%s", c > 0 ? "," : "", num );
+				}
+				else
+					fprintf( f, "%s%s", c > 0 ? "," : "", nonavail );
+			}
+
+			fprintf( f, "\n" );
+		}
+
+		if ( fclose( f ) != 0 )
+			return false;
+	}
+
+	return true;
+}
+
+
+/***************************************************
+Run checkpoint
+
+The complete state of a running simulation, saved
+to a binary file every few time steps, to resume
+an interrupted run later: the objects tree, with
+all the variables values, lags and saved series,
+the objects pointers (hooks), networks and turbo
+search structures, the series of the deleted
+objects and the random generators state. Objects
+are stored in tree order, and pointers are saved
+as positions in this order. C++ object extensions
+and user static data are not saved, so the state
+of models using extensions is never written.
+***************************************************/
+
+/*********************************
+CHECKPOINT::SAVE
+Write the current run state to
+file, replacing it at once
+*********************************/
+bool checkpoint::save( const char *fname )
+{
+	bool done;
+	string tmp = string( fname ) + ".tmp";
+	FILE *file = fopen( tmp.c_str( ), "wb" );
+
+	if ( file == NULL )
+		return false;
+
+	done = save( file );
+	done = ( fclose( file ) == 0 ) && done;
+
+	if ( done )
+	{
+		remove( fname );
+		done = ( rename( tmp.c_str( ), fname ) == 0 );
+	}
+
+	if ( ! done )
+		remove( tmp.c_str( ) );
+
+	return done;
+}
+
+
+/*********************************
+CHECKPOINT::SAVE
+Write the current run state to an
+open file, from its beginning
+*********************************/
+bool checkpoint::save( FILE *file )
+{
+	int order = CKPT_ORDER, ver = CKPT_VER;
+
+	if ( step > 0 && ! savable( root ) )
+		return false;
+
+	f = file;
+	rewind( f );
+
+	ok = fwrite( CKPT_MAGIC, 1, strlen( CKPT_MAGIC ) + 1, f ) == strlen( CKPT_MAGIC ) + 1;
+	put( ver );
+	put( order );
+	put( run );
+	put( step );
+	put( run_seed );
+
+	if ( step > 0 )
+	{
+		put( nodesSerial );
+		put( series_saved );
+		put( no_ptr_chk );
+		put_str( get_random_state( ).c_str( ) );
+
+		put_obj( root );
+		put_links( );
+		put_graves( );
+		put( order );					// end mark
+
+		objs.clear( );
+		obj_pos.clear( );
+	}
+
+	ok = ( fflush( f ) == 0 ) && ok;
+	f = NULL;
+
+	return ok;
+}
+
+
+/*********************************
+CHECKPOINT::LOAD
+Read the run state from file and,
+if a run was started, restore it,
+replacing the current objects tree
+*********************************/
+bool checkpoint::load( const char *fname, bool head_only )
+{
+	bool done;
+	FILE *file = fopen( fname, "rb" );
+
+	if ( file == NULL )
+		return false;
+
+	done = load( file, head_only );
+	fclose( file );
+
+	return done;
+}
+
+
+/*********************************
+CHECKPOINT::LOAD
+Read the run state from an open
+file, from its beginning
+*********************************/
+bool checkpoint::load( FILE *file, bool head_only )
+{
+	char magic[ sizeof( CKPT_MAGIC ) ];
+	int order, ver, saved, ptr_chk;
+	long serial;
+	string rnd_state;
+
+	f = file;
+	rewind( f );
+
+	ok = fread( magic, 1, sizeof( magic ), f ) == sizeof( magic ) && ! memcmp( magic, CKPT_MAGIC, sizeof( magic ) );
+	get( ver );
+	get( order );
+	ok = ok && ver == CKPT_VER && order == CKPT_ORDER;
+	get( run );
+	get( step );
+	get( run_seed );
+
+	if ( ok && ! head_only && step > 0 )
+	{
+		get( serial );
+		get( saved );
+		get( ptr_chk );
+		get_str( rnd_state );
+
+		root->empty( );
+		root->init( NULL, "Root" );
+
+		get_obj( root );
+		get_links( );
+		get_graves( );
+		get( order );
+		ok = ok && order == CKPT_ORDER;
+
+		objs.clear( );
+
+		if ( ok )
+		{
+			ok = set_random_state( rnd_state );
+			nodesSerial = serial;
+			series_saved = saved;
+			no_ptr_chk = ptr_chk;
+			t = step;
+		}
+	}
+
+	f = NULL;
+
+	return ok;
+}
+
+
+/*********************************
+CHECKPOINT::SAVABLE
+Check if no object in the tree
+has a C++ extension, which cannot
+be saved and restored
+*********************************/
+bool checkpoint::savable( object *r )
+{
+	bridge *cb;
+	object *cur;
+
+	if ( r->cext != NULL )
+		return false;
+
+	for ( cb = r->b; cb != NULL; cb = cb->next )
+		for ( cur = cb->head; cur != NULL; cur = cur->next )
+			if ( ! savable( cur ) )
+				return false;
+
+	return true;
+}
+
+
+/*********************************
+CHECKPOINT::PUT_OBJ
+*********************************/
+void checkpoint::put_obj( object *r )
+{
+	int n;
+	bridge *cb;
+	object *cur;
+	variable *cv;
+
+	obj_pos[ r ] = objs.size( );
+	objs.push_back( r );
+
+	put_str( r->label );
+	put( r->to_compute );
+	put( r->acounter );
+	put( r->lstCntUpd );
+
+	for ( n = 0, cv = r->v; cv != NULL; cv = cv->next, ++n );
+	put( n );
+
+	for ( cv = r->v; cv != NULL; cv = cv->next )
+		put_var( cv );
+
+	for ( n = 0, cb = r->b; cb != NULL; cb = cb->next, ++n );
+	put( n );
+
+	for ( cb = r->b; cb != NULL; cb = cb->next )
+	{
+		put_str( cb->blabel );
+		put( cb->counter_updated );
+		put( cb->col_num > 0 );
+
+		for ( n = 0, cur = cb->head; cur != NULL; cur = cur->next, ++n );
+		put( n );
+
+		for ( cur = cb->head; cur != NULL; cur = cur->next )
+			put_obj( cur );
+	}
+}
+
+
+/*********************************
+CHECKPOINT::GET_OBJ
+*********************************/
+void checkpoint::get_obj( object *r )
+{
+	bool col;
+	int i, j, m, n;
+	string lab;
+	bridge *cb, *last_b = NULL;
+	object *cur, *last;
+	variable *cv, *last_v = NULL;
+
+	objs.push_back( r );
+
+	get_str( lab );
+	ok = ok && lab == r->label;
+	get( r->to_compute );
+	get( r->acounter );
+	get( r->lstCntUpd );
+
+	get( n );
+	for ( i = 0; ok && i < n; ++i )
+	{
+		cv = new variable;
+		if ( last_v == NULL )
+			r->v = cv;
+		else
+			last_v->next = cv;
+		last_v = cv;
+
+		get_var( r, cv );
+
+		if ( cv->label != NULL )
+			r->map_var( cv->label, cv );
+	}
+
+	get( n );
+	for ( i = 0; ok && i < n; ++i )
+	{
+		get_str( lab );
+		cb = new bridge( lab.c_str( ) );
+		if ( last_b == NULL )
+			r->b = cb;
+		else
+			last_b->next = cb;
+		last_b = cb;
+
+		r->map_bridge( cb->blabel, cb );
+
+		get( cb->counter_updated );
+		get( col );
+		get( m );
+
+		for ( last = NULL, j = 0; ok && j < m; ++j, last = cur )
+		{
+			cur = new object;
+			cur->init( r, cb->blabel );
+
+			if ( last == NULL )
+				cb->head = cur;
+			else
+				last->next = cur;
+
+			get_obj( cur );
+		}
+
+		if ( ok && col )				// repack columns, as when saved
+			r->initcolumns( cb->blabel );
+	}
+}
+
+
+/*********************************
+CHECKPOINT::PUT_VAR
+*********************************/
+void checkpoint::put_var( variable *cv )
+{
+	bool has_arr = ( cv->arr != NULL );
+
+	put_str( cv->label );
+	put( cv->data_loaded );
+	put( cv->debug );
+	put( cv->dummy );
+	put( cv->observe );
+	put( cv->parallel );
+	put( cv->plot );
+	put( cv->save );
+	put( cv->savei );
+	put( cv->num_lag );
+	put( cv->param );
+	put( cv->delay );
+	put( cv->delay_range );
+	put( cv->period );
+	put( cv->period_range );
+	put( cv->last_update );
+	put( cv->next_update );
+	put( cv->deb_cond );
+	put( cv->deb_cnd_val );
+	put( cv->vec_time );
+	put( cv->vec_res );
+	put( cv->save_every );
+	put( cv->save_fmt );
+	put( cv->save_from );
+	put( cv->save_to );
+	put( cv->save_last );
+
+	put_arr( cv->val, cv->num_lag + 1 );
+
+	put( has_arr );
+	if ( has_arr )
+	{
+		put( cv->rows );
+		put( cv->cols );
+		put_arr( cv->arr, ( size_t ) ( cv->num_lag + 2 ) * cv->rows * cv->cols );
+	}
+
+	put_data( cv );
+}
+
+
+/*********************************
+CHECKPOINT::GET_VAR
+*********************************/
+void checkpoint::get_var( object *r, variable *cv )
+{
+	bool has_arr, save;
+	int num_lag, rows, cols;
+	string lab;
+	vector < double > vals;
+
+	get_str( lab );
+	get( cv->data_loaded );
+	get( cv->debug );
+	get( cv->dummy );
+	get( cv->observe );
+	get( cv->parallel );
+	get( cv->plot );
+	get( save );
+	get( cv->savei );
+	get( num_lag );
+	get( cv->param );
+	get( cv->delay );
+	get( cv->delay_range );
+	get( cv->period );
+	get( cv->period_range );
+	get( cv->last_update );
+	get( cv->next_update );
+	get( cv->deb_cond );
+	get( cv->deb_cnd_val );
+	get( cv->vec_time );
+	get( cv->vec_res );
+	get( cv->save_every );
+	get( cv->save_fmt );
+	get( cv->save_from );
+	get( cv->save_to );
+	get( cv->save_last );
+
+	if ( ! ok || num_lag < -1 )
+	{
+		ok = false;
+		return;
+	}
+
+	vals.resize( num_lag + 1 );
+	get_arr( vals.data( ), vals.size( ) );
+	cv->init( r, lab.c_str( ), num_lag, vals.data( ), save );
+
+	get( has_arr );
+	if ( has_arr )
+	{
+		get( rows );
+		get( cols );
+
+		if ( ! ok || rows <= 0 || cols <= 0 )
+		{
+			ok = false;
+			return;
+		}
+
+		cv->set_dim( rows, cols );
+		get_arr( cv->arr, ( size_t ) ( num_lag + 2 ) * rows * cols );
+	}
+
+	get_data( cv );
+}
+
+
+/*********************************
+CHECKPOINT::PUT_DATA
+Saved data is stored by position,
+independently of the time steps
+*********************************/
+void checkpoint::put_data( variable *cv )
+{
+	char fmt = cv->data != NULL ? 'd' : cv->data_flt != NULL ? 'f' : cv->data_zip != NULL ? 'z' : '\0';
+	bool has_arr = ( cv->arr_data != NULL && cv->arr != NULL );
+	int i;
+
+	put( fmt );
+	if ( fmt == '\0' )
+		return;
+
+	put( cv->start );
+	put( cv->end );
+	put( cv->data_size );
+	put( cv->data_step );
+	put( cv->serial );
+
+	for ( i = 0; i < cv->data_size; ++i )
+		put( fmt == 'd' ? cv->data[ i ] : fmt == 'f' ? ( double ) cv->data_flt[ i ] : cv->data_zip->get( i ) );
+
+	put( has_arr );
+	if ( has_arr )
+		put_arr( cv->arr_data, ( size_t ) cv->data_size * cv->rows * cv->cols );
+}
+
+
+/*********************************
+CHECKPOINT::GET_DATA
+*********************************/
+void checkpoint::get_data( variable *cv )
+{
+	char fmt;
+	bool has_arr;
+	int i;
+	double val;
+
+	get( fmt );
+	if ( ! ok || fmt == '\0' )
+		return;
+
+	get( cv->start );
+	get( cv->end );
+	get( cv->data_size );
+	get( cv->data_step );
+	get( cv->serial );
+
+	if ( ! ok || cv->data_size <= 0 || ! cv->alloc_data( fmt == 'z' ? SAVE_ZIP | ( cv->save_fmt & SAVE_FLT ) : fmt == 'f' ? SAVE_FLT : 0 ) )
+	{
+		ok = false;
+		return;
+	}
+
+	for ( i = 0; ok && i < cv->data_size; ++i )
+	{
+		get( val );
+
+		if ( cv->data != NULL )
+			cv->data[ i ] = val;
+		else
+			if ( cv->data_flt != NULL )
+				cv->data_flt[ i ] = val;
+			else
+				cv->data_zip->set( i, val );
+	}
+
+	get( has_arr );
+	if ( has_arr )
+		get_arr( cv->arr != NULL ? cv->arr_data : NULL, ( size_t ) cv->data_size * cv->rows * cv->cols );
+}
+
+
+/*********************************
+CHECKPOINT::PUT_LINKS
+Pointers to objects, network nodes
+(all before the links) and turbo
+search structures
+*********************************/
+void checkpoint::put_links( void )
+{
+	bool has_mn, has_node;
+	int n;
+	bridge *cb;
+	netLink *cl;
+
+	for ( auto obj : objs )
+	{
+		put_ptr( obj->hook );
+
+		n = obj->hooks.size( );
+		put( n );
+		for ( auto hook : obj->hooks )
+			put_ptr( hook );
+
+		has_node = ( obj->node != NULL );
+		put( has_node );
+		if ( has_node )
+		{
+			put( obj->node->id );
+			put_str( obj->node->name != NULL ? obj->node->name : "" );
+			put( obj->node->prob );
+			put( obj->node->time );
+			put( obj->node->serNum );
+		}
+	}
+
+	for ( auto obj : objs )
+	{
+		if ( obj->node == NULL )
+			continue;
+
+		for ( n = 0, cl = obj->node->first; cl != NULL; cl = cl->next, ++n );
+		put( n );
+
+		for ( cl = obj->node->first; cl != NULL; cl = cl->next )
+		{
+			put_ptr( cl->ptrTo );
+			put( cl->weight );
+			put( cl->probTo );
+			put( cl->time );
+			put( cl->serTo );
+		}
+	}
+
+	for ( auto obj : objs )
+		for ( cb = obj->b; cb != NULL; cb = cb->next )
+		{
+			has_mn = ( cb->mn != NULL );
+			put( has_mn );
+			if ( has_mn )
+				put_mn( cb->mn );
+
+			put_str( cb->search_var != NULL ? cb->search_var : "" );
+
+			n = cb->o_map.size( );
+			put( n );
+			for ( auto &it : cb->o_map )
+			{
+				put( it.first );
+				put_ptr( it.second );
+			}
+		}
+}
+
+
+/*********************************
+CHECKPOINT::GET_LINKS
+*********************************/
+void checkpoint::get_links( void )
+{
+	bool has_mn, has_node;
+	int i, n, time;
+	long id, serial;
+	double key, prob, weight;
+	string name;
+	bridge *cb;
+	object *to;
+	netLink *cl;
+
+	for ( auto obj : objs )
+	{
+		obj->hook = get_ptr( );
+
+		get( n );
+		for ( i = 0; ok && i < n; ++i )
+			obj->hooks.push_back( get_ptr( ) );
+
+		get( has_node );
+		if ( ok && has_node )
+		{
+			get( id );
+			get_str( name );
+			get( prob );
+			get( time );
+			get( serial );
+
+			obj->node = new netNode( id, name.c_str( ), prob );
+			obj->node->time = time;
+			obj->node->serNum = serial;
+		}
+	}
+
+	for ( auto obj : objs )
+	{
+		if ( ! ok || obj->node == NULL )
+			continue;
+
+		get( n );
+		for ( i = 0; ok && i < n; ++i )
+		{
+			to = get_ptr( );
+			get( weight );
+			get( prob );
+			get( time );
+			get( serial );
+
+			if ( to == NULL || to->node == NULL )
+			{
+				ok = false;
+				break;
+			}
+
+			cl = new netLink( obj, to, weight, prob );
+			cl->time = time;
+			cl->serTo = serial;
+		}
+	}
+
+	for ( auto obj : objs )
+		for ( cb = obj->b; ok && cb != NULL; cb = cb->next )
+		{
+			get( has_mn );
+			if ( has_mn )
+				cb->mn = get_mn( );
+
+			get_str( name );
+			if ( name.size( ) > 0 )
+			{
+				cb->search_var = new char[ name.size( ) + 1 ];
+				strcpy( cb->search_var, name.c_str( ) );
+			}
+
+			get( n );
+			for ( i = 0; ok && i < n; ++i )
+			{
+				get( key );
+				cb->o_map[ key ] = get_ptr( );
+			}
+		}
+}
+
+
+/*********************************
+CHECKPOINT::PUT_MN
+*********************************/
+void checkpoint::put_mn( mnode *m )
+{
+	bool has_son = ( m->son != NULL );
+	int i;
+
+	put( m->deflev );
+	put( has_son );
+
+	if ( has_son )
+		for ( i = 0; i < 10; ++i )
+			put_mn( m->son + i );
+	else
+		put_ptr( m->pntr );
+}
+
+
+/*********************************
+CHECKPOINT::GET_MN
+*********************************/
+mnode *checkpoint::get_mn( void )
+{
+	bool has_son;
+	int i;
+	mnode *m = new mnode;
+
+	m->son = NULL;
+	m->pntr = NULL;
+
+	get( m->deflev );
+	get( has_son );
+
+	if ( ok && has_son )
+	{
+		m->son = new mnode[ 10 ];
+
+		for ( i = 0; i < 10; ++i )
+		{
+			m->son[ i ].son = NULL;
+			m->son[ i ].pntr = NULL;
+			m->son[ i ].deflev = 0;
+		}
+
+		for ( i = 0; ok && i < 10; ++i )
+		{
+			mnode *s = get_mn( );
+			m->son[ i ] = *s;
+			delete s;
+		}
+	}
+	else
+		m->pntr = get_ptr( );
+
+	return m;
+}
+
+
+/*********************************
+CHECKPOINT::PUT_GRAVES
+*********************************/
+void checkpoint::put_graves( void )
+{
+	char fmt;
+	bool has_arr;
+	int i, n = cemetery.graves.size( );
+
+	put( n );
+
+	for ( auto &cg : cemetery.graves )
+	{
+		fmt = cg.data != NULL ? 'd' : cg.data_flt != NULL ? 'f' : cg.data_zip != NULL ? 'z' : '\0';
+		has_arr = ( cg.arr_data != NULL );
+
+		put_str( cg.label );
+		put_str( cg.lab_tit );
+		put( cg.rows );
+		put( cg.cols );
+		put( cg.start );
+		put( cg.end );
+		put( cg.data_size );
+		put( cg.data_step );
+		put( cg.serial );
+		put( fmt );
+
+		for ( i = 0; fmt != '\0' && i < cg.data_size; ++i )
+			put( fmt == 'd' ? cg.data[ i ] : fmt == 'f' ? ( double ) cg.data_flt[ i ] : cg.data_zip->get( i ) );
+
+		put( has_arr );
+		if ( has_arr )
+			put_arr( cg.arr_data, ( size_t ) cg.data_size * cg.rows * cg.cols );
+	}
+}
+
+
+/*********************************
+CHECKPOINT::GET_GRAVES
+Series are placed in the store, as
+when objects are deleted
+*********************************/
+void checkpoint::get_graves( void )
+{
+	char fmt;
+	bool has_arr;
+	int i, j, n;
+	double val;
+	string lab, tag;
+	grave cg;
+
+	get( n );
+
+	for ( i = 0; ok && i < n; ++i )
+	{
+		get_str( lab );
+		get_str( tag );
+		get( cg.rows );
+		get( cg.cols );
+		get( cg.start );
+		get( cg.end );
+		get( cg.data_size );
+		get( cg.data_step );
+		get( cg.serial );
+		get( fmt );
+
+		if ( ! ok || cg.data_size < 0 )
+		{
+			ok = false;
+			return;
+		}
+
+		cg.label = ( char * ) cemetery.alloc( lab.size( ) + 1 );
+		cg.lab_tit = ( char * ) cemetery.alloc( tag.size( ) + 1 );
+		cg.data = fmt == 'd' ? ( double * ) cemetery.alloc( cg.data_size * sizeof( double ) ) : NULL;
+		cg.data_flt = fmt == 'f' ? ( float * ) cemetery.alloc( cg.data_size * sizeof( float ) ) : NULL;
+		cg.data_zip = fmt == 'z' ? new save_zip( cg.data_size, false ) : NULL;
+		cg.arr_data = NULL;
+		cg.in_store = true;
+
+		if ( cg.label == NULL || cg.lab_tit == NULL || ( fmt == 'd' && cg.data == NULL ) || ( fmt == 'f' && cg.data_flt == NULL ) )
+		{
+			delete cg.data_zip;
+			ok = false;
+			return;
+		}
+
+		strcpy( cg.label, lab.c_str( ) );
+		strcpy( cg.lab_tit, tag.c_str( ) );
+
+		for ( j = 0; fmt != '\0' && ok && j < cg.data_size; ++j )
+		{
+			get( val );
+
+			if ( cg.data != NULL )
+				cg.data[ j ] = val;
+			else
+				if ( cg.data_flt != NULL )
+					cg.data_flt[ j ] = val;
+				else
+					cg.data_zip->set( j, val );
+		}
+
+		if ( cg.data_zip != NULL )
+			cg.data_zip->shrink( );
+
+		get( has_arr );
+		if ( ok && has_arr )
+		{
+			cg.arr_data = ( double * ) cemetery.alloc( ( size_t ) cg.data_size * cg.rows * cg.cols * sizeof( double ) );
+			get_arr( cg.arr_data, ( size_t ) cg.data_size * cg.rows * cg.cols );
+		}
+
+		cemetery.graves.push_back( cg );
+	}
+}
+
+
+/*********************************
+CHECKPOINT::PUT_PTR/GET_PTR
+Pointers as tree order positions,
+-1 for NULL or unknown objects
+*********************************/
+void checkpoint::put_ptr( object *o )
+{
+	auto it = obj_pos.find( o );
+	long pos = ( it != obj_pos.end( ) ) ? it->second : -1;
+
+	put( pos );
+}
+
+object *checkpoint::get_ptr( void )
+{
+	long pos = -1;
+
+	get( pos );
+
+	if ( pos >= ( long ) objs.size( ) )
+		ok = false;
+
+	return ( ok && pos >= 0 ) ? objs[ pos ] : NULL;
+}
+
+
+/*********************************
+CHECKPOINT::PUT_ARR/GET_ARR/
+PUT_STR/GET_STR
+*********************************/
+void checkpoint::put_arr( const double *x, size_t n )
+{
+	ok = ok && fwrite( x, sizeof( double ), n, f ) == n;
+}
+
+void checkpoint::get_arr( double *x, size_t n )
+{
+	if ( x == NULL )
+		ok = ok && fseek( f, n * sizeof( double ), SEEK_CUR ) == 0;
+	else
+		ok = ok && fread( x, sizeof( double ), n, f ) == n;
+}
+
+void checkpoint::put_str( const char *s )
+{
+	int n = strlen( s );
+
+	put( n );
+	ok = ok && fwrite( s, 1, n, f ) == ( size_t ) n;
+}
+
+void checkpoint::get_str( string &s )
+{
+	int n = 0;
+
+	get( n );
+	ok = ok && n >= 0 && n < ( 1 << 20 );		// generators state is long
+	s.resize( ok ? n : 0 );
+	ok = ok && fread( & s[ 0 ], 1, n, f ) == ( size_t ) n;
+}
+
+
+/***************************************************
+Individually saved series
+
+Series flagged for individual saving are written,
+when their object is deleted or the run ends, to a
+single binary results file per run. save_single
+just copies the values to a queue, which a
+background thread appends to the file, so object
+deletion is not held by the disk writes.
+***************************************************/
+
+struct single_rec						// series waiting to be written
+{
+	string label;
+	string tag;
+	int rows;
+	int cols;
+	int start;
+	int end;
+	vector < vector < double > > vals;
+};
+
+static bool single_zip = false;			// compress the single series file
+static string single_fname;				// single series file name in run
+static result *single_file = NULL;		// single series file, once opened
+static vector < single_rec > single_queue;	// series to write
+
+#ifndef _NP_
+static bool single_end = false;			// no more series in the run
+static mutex single_lock;				// queue access control
+static condition_variable single_wake;	// new series in the queue
+static thread single_thread;			// background single series writer
+#endif
+
+
+/*********************************
+SINGLE_OPEN
+Prepare the single series file of
+a run, created only if needed
+*********************************/
+void single_open( const char *fname, bool zip )
+{
+	single_close( );
+
+	single_fname = fname;
+	single_zip = zip;
+}
+
+
+/*********************************
+SINGLE_WRITE
+Write the queued series to file
+(run in the background thread)
+*********************************/
+static void single_write( void )
+{
+	vector < single_rec > recs;
+
+#ifndef _NP_
+	unique_lock < mutex > lock( single_lock );
+
+	while ( true )
+	{
+		single_wake.wait( lock, [ ] { return single_queue.size( ) > 0 || single_end; } );
+
+		if ( single_queue.size( ) == 0 )
+			break;
+
+		recs.swap( single_queue );
+		lock.unlock( );
+#else
+		recs.swap( single_queue );
+#endif
+		for ( auto &rec : recs )
+			single_file->series( rec.label.c_str( ), rec.tag.c_str( ), rec.rows, rec.cols, rec.start, rec.end, rec.vals );
+
+		recs.clear( );
+#ifndef _NP_
+		lock.lock( );
+	}
+#endif
+}
+
+
+/*********************************
+SINGLE_CLOSE
+Finish writing the single series
+file of the run, if any
+*********************************/
+void single_close( void )
+{
+#ifndef _NP_
+	if ( single_thread.joinable( ) )
+	{
+		{
+			lock_guard < mutex > lock( single_lock );
+			single_end = true;
+		}
+
+		single_wake.notify_one( );
+		single_thread.join( );
+	}
+
+	single_end = false;
+#endif
+	delete single_file;			// write the series directory
+	single_file = NULL;
+	single_fname.clear( );
+	single_queue.clear( );
+}
+
+
+/*********************************
+SAVE_SINGLE
+*********************************/
+void save_single( variable *v )
+{
+	int i, k, n;
+	single_rec rec;
+
+	if ( single_fname.empty( ) )	// not in a run
+		return;
+
+	{
+#ifndef _NP_
+		// prevent concurrent use by more than one thread
+		rec_lguardT lock( v->parallel_comp );
+#endif
+		set_lab_tit( v );
+		rec.label = v->label;
+		rec.tag = v->lab_tit;
+		rec.rows = v->rows;
+		rec.cols = v->cols;
+		rec.start = max( v->start, 0 );
+		rec.end = min( v->end, t - 1 );
+		n = v->arr != NULL ? v->rows * v->cols : 0;
+		rec.vals.assign( n + 1, vector < double > ( max( rec.end - rec.start + 1, 0 ) ) );
+
+		for ( i = rec.start; i <= rec.end; ++i )
+		{
+			rec.vals[ 0 ][ i - rec.start ] = v->get_data( i );
+
+			for ( k = 0; k < n; ++k )
+				rec.vals[ k + 1 ][ i - rec.start ] = v->arr_data != NULL && v->in_data( i ) ? v->arr_data[ v->data_pos( i ) * n + k ] : NAN;
+		}
+	}
+
+#ifndef _NP_
+	lock_guard < mutex > lock( single_lock );
+#endif
+	if ( single_file == NULL )
+	{
+		single_file = new result( single_fname.c_str( ), "wb", single_zip, false, true );
+#ifndef _NP_
+		single_thread = thread( single_write );
+#endif
+	}
+
+	single_queue.push_back( move( rec ) );
+
+#ifndef _NP_
+	single_wake.notify_one( );
+#else
+	single_write( );
+#endif
+}
+
+
+/*****************************************************************************
+SAVE_CONFIGURATION
+	Save current defined configuration (adding tag index if appropriate)
+	If quick is true, just the structure and the parameters is saved
+	Returns: true: save ok, false: save failure
+******************************************************************************/
+bool save_configuration( int findex, const char *dest_path, bool quick )
+{
+	bool save_ok = false, bin_ok = true;
+	int delta, indexDig, save_len;
+	char ch[ MAX_PATH_LENGTH ], *save_file, *bak_file = NULL;
+	const char *save_path;
+	string bin_file;
+	description *cd;
+	FILE *f;
+
+	delta = ( findex > 0 ) ? sim_num * ( findex - 1 ) : 0;
+	indexDig = ( findex > 0 ) ? ( int ) floor( log10( findex ) + 2 ) : 0;
+
+	if ( dest_path == NULL )
+		save_path = path;
+	else
+		save_path = dest_path;
+
+	if ( strlen( simul_name ) == 0 )
+	{
+		delete [ ] simul_name;
+		simul_name = new char[ strlen( DEF_CONF_FILE ) + 1 ];
+		strcpy( simul_name, DEF_CONF_FILE );
+	}
+
+	if ( strlen( name_rep ) == 0 )
+		snprintf( name_rep, MAX_PATH_LENGTH, "report_%s.html", simul_name );
+
+	if ( strlen( path ) > 0 )
+	{
+		save_len = strlen( save_path ) + strlen( simul_name ) + 6 + indexDig;
+		save_file = new char[ save_len ];
+		sprintf( save_file, "%s/%s", save_path, simul_name );
+	}
+	else
+	{
+		save_len = strlen( simul_name ) + 6 + indexDig;
+		save_file = new char[ save_len ];
+		sprintf( save_file, "%s", simul_name );
+	}
+
+	if ( findex > 0 )
+	{
+		snprintf( ch, MAX_PATH_LENGTH, "_%d.lsd", findex );
+		strcatn( save_file, ch, save_len );
+	}
+	else
+	{
+		// create backup file when not indexed saving
+		bak_file = new char[ strlen( save_file ) + 5 ];
+		sprintf( bak_file, "%s.bak", save_file );
+
+		strcatn( save_file, ".lsd", save_len );
+
+		f = fopen( save_file, "r" );
+		if ( f != NULL )
+		{
+			fclose( f );
+
+			f = fopen( bak_file, "r" );
+			if ( f != NULL )
+			{
+				fclose( f );
+				if( remove( bak_file ) )
+					goto error;
+			}
+
+			if ( rename( save_file, bak_file ) )
+				goto error;
+		}
+	}
+
+	// keep the previous sidecar file with the backup, or discard it
+	bin_file = cfg_bin_file( save_file );
+	f = fopen( bin_file.c_str( ), "r" );
+	if ( f != NULL )
+	{
+		fclose( f );
+
+		if ( bak_file != NULL )
+		{
+			snprintf( ch, MAX_PATH_LENGTH, "%s.%s", bak_file, CFG_BIN_EXT );
+			remove( ch );
+			if ( rename( bin_file.c_str( ), ch ) )
+				goto error;
+		}
+		else
+			if ( remove( bin_file.c_str( ) ) )
+				goto error;
+	}
+
+	f = fopen( save_file, "wb" );
+	if ( f == NULL )
+		goto error;
+
+	if ( bin_values )
+		cfg_bin_name = bin_file;
+
+	root->save_struct( f, "" );
+	fprintf( f, "\nDATA\n" );
+	root->save_param( f );
+
+	if ( cfg_bin != NULL )
+	{
+		bin_ok = ! ferror( cfg_bin );
+		bin_ok = ( fclose( cfg_bin ) == 0 ) && bin_ok;
+		cfg_bin = NULL;
+	}
+	cfg_bin_name.clear( );
+
+	fprintf( f, "\nSIM_NUM %d\nSEED %d\nMAX_STEP %d", sim_num, seed + delta, max_step );
+
+	if ( when_debug > 0 || stack_info > 0 || prof_min_msecs > 0 || prof_obs_only || prof_aggr_time || no_ptr_chk || parallel_disable || bin_values )
+		fprintf( f, " %d %d %d %d %d %d %d", when_debug, stack_info, prof_min_msecs, prof_obs_only ? 1 : 0, prof_aggr_time ? 1 : 0, no_ptr_chk ? 1 : 0, parallel_disable ? 1 : 0 );
+
+	if ( bin_values )
+		fprintf( f, " 1" );
+
+	fprintf( f, "\nEQUATION %s\nMODELREPORT %s\n", equation_name, name_rep );
+
+	if ( ! quick )
+	{
+		fprintf( f, "\nDESCRIPTION\n\n" );
+		save_description( root, f );
+
+		fprintf( f, "\nDOCUOBSERVE\n" );
+		for ( cd = descr; cd != NULL; cd = cd->next )
+			if ( cd->observe == 'y' )
+				fprintf( f, "%s\n", cd->label );
+		fprintf( f, "\nEND_DOCUOBSERVE\n\n" );
+
+		fprintf( f, "\nDOCUINITIAL\n" );
+		for ( cd = descr; cd != NULL; cd = cd->next )
+			if ( cd->initial == 'y' )
+				fprintf( f, "%s\n", cd->label );
+		fprintf( f, "\nEND_DOCUINITIAL\n\n" );
+
+		save_eqfile( f );
+	}
+
+	if ( ! ferror( f ) && bin_ok )
+	{
+		save_ok = true;
+
+#ifndef _NW_
+		cmd( "set lastConf [ string map -nocase { \"%s/\" \"\" } [ file normalize \"%s\" ] ]", exec_path, struct_file );
+#endif
+	}
+
+	fclose( f );
+
+	error:
+
+	delete [ ] save_file;
+	delete [ ] bak_file;
+
+	return save_ok;
+}
+
+
+/*****************************************************************************
+LOAD_SENSITIVITY
+	Load defined sensitivity analysis configuration
+	Returns: 0: load ok, 1,2,3,4,...: load failure
+******************************************************************************/
+int load_sensitivity( FILE *f )
+{
+	int i;
+	char cc, lab[ MAX_ELEM_LENGTH ];
+	variable *cv;
+	sense *cs = rsense;
+
+	// read data from file (1 line per element, '#' indicate comment)
+	while ( ! feof( f ) )
+	{	// read element by element, skipping comments
+		fscanf( f, "%99s", lab );			// read string
+		while ( lab[ 0 ] == '#' )			// start of a comment
+		{
+			do								// jump to next line
+				cc = fgetc( f );
+			while ( ! feof( f ) && cc != '\n' );
+			fscanf( f, "%99s", lab );		// try again
+		}
+
+		if ( feof( f ) )					// ended too early?
+			break;
+
+		cv = root->search_var( root, lab );
+		if ( cv == NULL || ( cv->param != 1 && cv->num_lag == 0 ) )
+			goto error1;					// and not parameter or lagged variable
+
+		// create memory allocation for new variable
+		if ( rsense == NULL )				// allocate first element
+			rsense = cs = new sense;
+		else								// allocate next ones
+		{
+			cs->next = new sense;
+			cs = cs->next;
+		}
+		cs->v = NULL;						// initialize struct pointers
+		cs->next = NULL;
+
+		cs->label = new char[ strlen( lab ) + 1 ];	// save element name
+		strcpy( cs->label, lab );
+
+		// get lags and # of values to test
+		if ( fscanf( f, "%d %d ", &cs->lag, &cs->nvalues ) < 2 )
+			goto error2;
+
+		// get variable type (newer versions)
+		if ( fscanf( f, "%c ", &cc ) < 1 )
+			goto error3;
+
+		if ( cc == 'i' || cc == 'd' || cc == 'f' )
+		{
+			cs->integer = ( cc == 'i' ) ? true : false;
+			fscanf( f, ": " );				// remove separator
+		}
+		else
+			if ( cc == ':' )
+				cs->integer = false;
+			else
+				goto error4;
+
+		if ( cs->lag == 0 )					// adjust type and lag #
+			cs->param = 1;
+		else
+		{
+			cs->param = 0;
+			cs->lag = abs( cs->lag ) - 1;
+		}
+
+		cs->v = new double[ cs->nvalues ];	// get values
+		for ( i = 0; i < cs->nvalues; ++i )
+			if ( ! fscanf( f, "%lf", &cs->v[ i ] ) )
+				goto error5;
+			else
+				if ( cs->integer )
+					cs->v[ i ] = round( cs->v[ i ] );
+	}
+
+	return 0;
+
+	// error handling
+	error1:
+		if ( cv != NULL )
+			cmd( "ttk::messageBox -parent . -title Error -icon error -type ok -message \"Invalid lag selected\" -detail \"Variable '%s' has no lags set.\"", lab );
+		i = 1;
+		goto error;
+	error2:
+		cmd( "ttk::messageBox -parent . -title Error -icon error -type ok -message \"Invalid range\" -detail \"Element '%s' has less than two values to test.\"", lab );
+		i = 2;
+		goto error;
+	error3:
+		cmd( "ttk::messageBox -parent . -title Error -icon error -type ok -message \"Invalid element type\" -detail \"Element '%s' has an invalid value set.\"", lab );
+		i = 3;
+		goto error;
+	error4:
+		cmd( "ttk::messageBox -parent . -title Error -icon error -type ok -message \"Missing separator\" -detail \"Element '%s' has no separator character (':').\"", lab );
+		i = 4;
+		goto error;
+	error5:
+		cmd( "ttk::messageBox -parent . -title Error -icon error -type ok -message \"Invalid range value\" -detail \"Element '%s' has non-numeric range values.\"", lab );
+		i = 5;
+		goto error;
+
+	error:
+	empty_sensitivity( rsense );		// discard read data
+	rsense = NULL;
+
+	return i;
+}
+
+
+/*****************************************************************************
+EMPTY_SENSITIVITY
+	Deallocate sensitivity analysis memory
+******************************************************************************/
+void empty_sensitivity( sense *cs )
+{
+	if ( cs == NULL )		// prevent invalid calls (last variable)
+		return;
+
+	if ( cs->next != NULL )	// recursively start from the end of the list
+		empty_sensitivity( cs->next );
+#ifndef _NW_
+	else
+		NOLH_clear( );		// deallocate DoE (last object only)
+#endif
+	if ( cs->v != NULL )	// deallocate requested memory, if applicable
+		delete cs->v;
+	if ( cs->label != NULL )
+		delete cs->label;
+
+	delete cs;				// suicide
+}
+
+
+/*****************************************************************************
+SAVE_SENSITIVITY
+	Save current sensitivity configuration
+	Returns: true: save ok, false: save failure
+******************************************************************************/
+bool save_sensitivity( FILE *f )
+{
+	int i;
+	sense *cs;
+
+	for ( cs = rsense; cs != NULL; cs = cs->next )
+	{
+		if ( cs->param == 1 )
+			fprintf( f, "%s 0 %d %c:", cs->label, cs->nvalues, cs->integer ? 'i' : 'f' );
+		else
+			fprintf( f, "%s -%d %d %c:", cs->label, cs->lag + 1, cs->nvalues, cs->integer ? 'i' : 'f' );
+		for ( i = 0; cs->v != NULL && i < cs->nvalues; ++i )
+			fprintf( f," %g", cs->v[ i ] );
+		fprintf( f,"\n" );
+	}
+
+	return ! ferror( f );
+}
+
+
+/****************************************************
+GET_SAVED
+****************************************************/
+void get_saved( object *n, FILE *out, const char *sep, bool all_var )
+{
+	int i, sl;
+	char *lab;
+	bridge *cb;
+	description *cd;
+	object *co;
+	variable *cv;
+
+	for ( cv = n->v; cv != NULL; cv = cv->next )
+		if ( cv->save || all_var )
+		{
+			// get element description
+			cd = search_description( cv->label, false );
+			if ( cd != NULL && cd->text != NULL && ( sl = strlen( cd->text ) ) > 0 )
+			{
+				// select just the first description line
+				lab = new char[ sl + 1 ];
+				strcpy( lab, cd->text );
+				for ( i = 0; i < sl; ++i )
+					if ( lab[ i ] == '\n' || lab[ i ] == '\r' )
+					{
+						lab[ i ] = '\0';
+						break;
+					}
+			}
+			else
+				lab = NULL;
+
+			fprintf( out, "%s%s%s%s%s%s%s\n", cv->label, sep, cv->param ? "parameter" : "variable", sep, n->label, sep, lab != NULL ? lab : "" );
+		}
+
+	for ( cb = n->b; cb != NULL; cb = cb->next )
+	{
+		if ( cb->head == NULL )
+			co = blueprint->search( cb->blabel );
+		else
+			co = cb->head;
+		get_saved( co, out, sep, all_var );
+	}
+}
+
+
+/****************************************************
+GET_SA_LIMITS
+****************************************************/
+const char *meta_par_name[ META_PAR_NUM ] = META_PAR_NAME;
+
+void get_sa_limits( object *r, FILE *out, const char *sep )
+{
+	int i, sl;
+	char *lab, type[ 10 ];
+	variable *cv;
+	description *cd;
+	sense *cs;
+
+	for ( i = 0; i < META_PAR_NUM; ++i )
+		meta_par_in[ i ] = false;
+
+	for ( cs = rsense; cs != NULL; cs = cs->next )
+	{
+		// get current value (first object)
+		cv = r->search_var( NULL, cs->label );
+
+		// get element description
+		cd = search_description( cs->label, false );
+		if ( cd != NULL && cd->text != NULL && ( sl = strlen( cd->text ) ) > 0 )
+		{
+			// select just the first description line
+			lab = new char[ sl + 1 ];
+			strcpy( lab, cd->text );
+			for ( i = 0; i < sl; ++i )
+				if ( lab[ i ] == '\n' || lab[ i ] == '\r' )
+				{
+					lab[ i ] = '\0';
+					break;
+				}
+		}
+		else
+			lab = NULL;
+
+		// find max and min values
+		double min = HUGE_VAL, max = - HUGE_VAL;
+		for ( i = 0; cs->v != NULL &&  i < cs->nvalues; ++i )
+			if ( cs->v[ i ] < min )
+				min = cs->v[ i ];
+			else
+				if ( cs->v[ i ] > max )
+					max = cs->v[ i ];
+
+		// check meta-parameters
+		if ( cs->param == 1 )
+		{
+			strcpy( type, "parameter" );
+
+			for ( i = 0; i < META_PAR_NUM; ++i )
+				if ( ! strcmp( cs->label, meta_par_name[ i ] ) )
+				{
+					strcpy( type, "setting" );
+					meta_par_in[ i ] = true;
+					break;
+				}
+		}
+		else
+			strcpy( type, "variable" );
+
+		fprintf( out, "%s%s%s%s%d%s%s%s%g%s%g%s%g%s\"%s\"\n", cs->label, sep, type, sep, cs->param == 1 ? 0 : cs->lag + 1, sep, cs->integer ? "integer" : "real", sep, cv != NULL ? cv->val[ cs->lag ] : NAN, sep, min, sep, max, sep, lab != NULL ? lab : "" );
+
+		delete [ ] lab;
+	}
+}
+
+
+/***************************************************
+SAVE_EQFILE
+***************************************************/
+void save_eqfile( FILE *f )
+{
+	if ( eq_file != NULL && ( strlen( lsd_eq_file ) == 0 || strcmp( lsd_eq_file, eq_file ) != 0 ) )
+		strcpyn( lsd_eq_file, eq_file, MAX_FILE_SIZE );
+
+	fprintf( f, "\nEQ_FILE\n" );
+	fprintf( f, "%s", lsd_eq_file );
+	fprintf( f, "\nEND_EQ_FILE\n" );
+}
+
+
+#ifndef _NW_
+
+/***************************************************
+READ_EQ_FILENAME
+***************************************************/
+void read_eq_filename( char *s, int sz )
+{
+	char lab[ MAX_PATH_LENGTH ];
+	FILE *f;
+
+	snprintf( lab, MAX_PATH_LENGTH, "%s/%s", exec_path, MODEL_OPTIONS );
+	f = fopen( lab, "r" );
+
+	if ( f == NULL )
+	{
+		cmd( "ttk::messageBox -parent . -title Error -icon error -type ok -message \"File not found\" -detail \"File '$MODEL_OPTIONS' missing, cannot upload the equation file.\nYou may have to recreate your model configuration.\"" );
+		return;
+	}
+
+	fscanf( f, "%999s", lab );
+	for ( int i = 0; strncmp( lab, "FUN=", 4 ) && fscanf( f, "%999s", lab ) != EOF && i < MAX_FILE_TRY; ++i );
+	fclose( f );
+	if ( strncmp( lab, "FUN=", 4 ) != 0 )
+	{
+		cmd( "ttk::messageBox -parent . -type ok -title -title Error -icon error -message \"File corrupted\" -detail \"File '$MODEL_OPTIONS' has invalid contents, cannot upload the equation file.\nYou may have to recreate your model configuration.\"" );
+		return;
+	}
+
+	strcpyn( s, lab + 4, sz );
+	strcatn( s, ".cpp", sz );
+
+	return;
+}
+
+
+/***************************************************
+UPLOAD_EQFILE
+***************************************************/
+char *upload_eqfile( void )
+{
+	char s[ MAX_PATH_LENGTH ], line[ MAX_LINE_SIZE ], *eq;
+	int sz;
+	FILE *f;
+
+	read_eq_filename( s, MAX_PATH_LENGTH );
+	if ( ( f = fopen( s, "r" ) ) == NULL )
+		return NULL;
+
+	cmd( "set res [ file size %s ]", s );
+	sz = get_int( "res" ) + 1;
+	eq = new char[ sz ];
+	strcpy( eq, "" );
+
+	while ( fgets( line, MAX_LINE_SIZE, f ) != NULL )
+		strcatn( eq, line, sz );
+
+	fclose( f );
+
+	return eq;
+}
+
+
+/****************************************************
+SHOW_LOGS
+Open tail/multitail to show log files dynamically
+****************************************************/
+void show_logs( const char *path, vector < string > & logs, bool par_cntl )
+{
+	char exec[ MAX_PATH_LENGTH	];
+	int i, j, n, sz;
+
+	cmd( "switch [ ttk::messageBox -parent . -type yesno -default yes -icon info -title \"Background run monitor\" -message \"Open the background run monitor?\" -detail \"The selected simulation runs were started as parallel background job(s). Each job progress can be monitored in a separated window results by choosing 'Yes'\n\nLog files are being created in the folder:\n\n[ fn_break [ file nativename \"%s\" ] 40 ]\" ] { yes { set ans 1 } no { set ans 0 } }", path );
+
+	if ( ! get_int( "ans" ) || ( par_cntl && ! parallel_monitor ) )
+		return;
+
+	lock_guard < mutex > lock( lock_run_logs );
+
+	n = logs.size( );
+	if ( n == 0 )
+		return;
+
+	for ( i = j = 0; i < n; ++i )
+		j += logs[ i ].length( );
+
+	sz = i + j + 1;
+	char logs_str[ sz ];
+	strcpy( logs_str, "" );
+
+	for ( i = 0; i < n; ++i )
+	{
+		strcatn( logs_str, logs[ i ].c_str( ), sz );
+
+		if ( i < n - 1 )
+			strcatn( logs_str, " ", sz );
+	}
+
+	if ( n == 1 )
+		strcpy( exec, "tail -n 20 -F" );
+	else
+	{
+		// number of terminal columns
+		j = n > 4 ? ( n > 8 ? ( n > 12 ? 4 : 3 ) : 2 ) : 1;
+
+		if ( j == 1 )
+			snprintf( exec, MAX_PATH_LENGTH , "multitail%s", platform == _WIN_ ? "" : " --retry-all" );
+		else
+			snprintf( exec, MAX_PATH_LENGTH , "multitail%s -s %d", platform == _WIN_ ? "" : " --retry-all", j );
+	}
+
+	cmd( "if { [ open_terminal \"%s %s\" ] != 0 } { \
+			ttk::messageBox -parent . -type ok -icon error -title Error -message \"%s failed to launch\" -detail \"Please check if %s is installed and set up properly.\n\nDetail:\n$termResult\" \
+		}", exec, logs_str, exec, exec );
+}
+
+#endif
+
+/***************************************************
+RESULT
+Methods for results file saving (class result)
+***************************************************/
+
+/***************************************************
+SAVE_PLAN
+Lists once the saved variables in the file columns
+order: the variables in the model tree, depth first,
+followed by the dead ones, in the cemetery
+***************************************************/
+void result::save_plan( object *root )
+{
+	if ( plan_root == root )
+		return;
+
+	plan.clear( );
+	plan_tree( root );
+	plan_dead = cemetery.graves.size( );
+	plan_root = root;
+}
+
+void result::plan_tree( object *r )
+{
+	bridge *cb;
+	object *cur;
+	variable *cv;
+
+	for ( cv = r->v; cv != NULL; cv = cv->next )
+		if ( cv->save == 1 )
+			plan.push_back( cv );
+
+	for ( cb = r->b; cb != NULL; cb = cb->next )
+		if ( cb->head != NULL && cb->head->to_compute )
+			for ( cur = cb->head; cur != NULL; cur = cur->next )
+				plan_tree( cur );
+}
+
+
+/***************************************************
+DATA
+Saves data to file in the specified period
+***************************************************/
+void result::data( object *root, int initstep, int endtstep )
+{
+	if ( dobin )						// binary files are written by series
+	{
+		data_bin( root, initstep, endtstep == 0 ? initstep : endtstep );
+		return;
+	}
+
+	// don't include initialization (t=0) in .csv format
+	initstep = ( docsv && initstep < 1 ) ? 1 : initstep;
+	// adjust for 1 time step if needed
+	endtstep = ( endtstep == 0 ) ? initstep : endtstep;
+
+	save_plan( root );
+
+	for ( int i = initstep; i <= endtstep; i++ )
+	{
+		firstCol = true;
+
+		for ( auto cv : plan )			// output one data line
+		{
+			data_value( cv->get_data( i ) );
+
+			if ( cv->arr != NULL )
+				data_arr( cv, i );
+		}
+
+		for ( int j = 0; j < plan_dead; ++j )
+		{
+			grave *cg = & cemetery.graves[ j ];
+
+			data_value( cg->get_data( i ) );
+
+			for ( int k = 0; k < cg->rows * cg->cols; ++k )
+				data_value( cg->get_arr( i, k ) );
+		}
+
+		print( "\n" );					// and change line
+	}
+}
+
+
+/***************************************************
+DATA_ARR
+Saves the array elements of a variable in a time step
+***************************************************/
+void result::data_arr( variable *cv, int i )
+{
+	int k, n = cv->rows * cv->cols;
+
+	for ( k = 0; k < n; ++k )
+		data_value( ( cv->arr_data != NULL && cv->in_data( i ) ) ? cv->arr_data[ cv->data_pos( i ) * n + k ] : NAN );
+}
+
+
+/***************************************************
+TITLE
+Saves header to file
+***************************************************/
+void result::title( object *root, int flag )
+{
+	bool single = false, root_single = false;
+	object *last_up = NULL;
+	grave *cg;
+
+	if ( dobin )						// binary files header is written at the end
+	{
+		title_bin( root );
+		return;
+	}
+
+	save_plan( root );
+
+	firstCol = true;
+
+	for ( auto cv : plan )				// variables in the model tree
+	{
+		if ( cv->up != last_up )		// suffix flag is kept per object
+		{
+			last_up = cv->up;
+			single = false;
+		}
+
+		set_lab_tit( cv );
+		if ( single_lab_tit( cv ) )
+			single = true;					// prevent adding suffix to single objects
+
+		if ( cv->up == root )
+			root_single = single;
+
+		title_var( cv->label, cv->lab_tit, cv->arr != NULL ? cv->rows : 0, cv->cols, cv->start, cv->end, single, flag );
+	}
+
+	for ( int i = 0; i < plan_dead; ++i )	// dead variables as in root
+	{
+		cg = & cemetery.graves[ i ];
+		title_var( cg->label, cg->lab_tit, cg->rows, cg->cols, cg->start, cg->end, root_single, true );
+	}
+
+	print( "\n" );						// and change line
+}
+
+
+/***************************************************
+TITLE_VAR
+Saves the header of a variable and of its array
+elements, if any, one column per element named
+label_row (vectors) or label_row_column (matrices)
+***************************************************/
+void result::title_var( const char *lab, const char *tag, int rows, int cols, int start, int end, bool single, int header )
+{
+	char elem[ MAX_ELEM_LENGTH ];
+	int k;
+
+	for ( k = -1; k < rows * cols; ++k )
+	{
+		if ( k < 0 )
+			strcpyn( elem, lab, MAX_ELEM_LENGTH );
+		else
+			if ( cols == 1 )
+				snprintf( elem, MAX_ELEM_LENGTH, "%s_%d", lab, k + 1 );
+			else
+				snprintf( elem, MAX_ELEM_LENGTH, "%s_%d_%d", lab, k % rows + 1, k / rows + 1 );
+
+		if ( docsv )
+			print( "%s%s%s%s", firstCol ? "" : CSV_SEP, elem, single ? "" : "_", single ? "" : tag );
+		else
+			if ( header )
+				print( "%s %s (%d %d)\t", elem, tag, start, end );
+			else
+				print( "%s %s (-1 -1)\t", elem, tag );
+
+		firstCol = false;
+	}
+}
+
+/***************************************************
+CONSTRUCTOR
+Open the appropriate file for saving the results
+***************************************************/
+result::result( const char *fname, const char *fmode, bool dozip, bool docsv, bool dobin )
+{
+	char mode[ 3 ] = { fmode[ 0 ], 'b', '\0' };
+	res_bin_head head;
+
+	this->dobin = dobin;
+	this->docsv = docsv;
+	this->dozip = dozip;		// save local class flag
+	plan_root = NULL;
+
+	if ( dobin )				// binary files compress by chunk, if zipping
+	{
+		f = fopen( fname, "wb" );
+		bin_first = 0;
+		bin_last = -1;
+		bin_pos = sizeof( head );
+
+		memset( & head, 0, sizeof( head ) );	// placeholder for final header
+		if ( f != NULL )
+			fwrite( & head, sizeof( head ), 1, f );
+	}
+	else
+		if ( dozip )			// compressed text is written in gzip members
+		{
+			f = fopen( fname, mode );
+			zipped = 0;
+		}
+		else
+			f = fopen( fname, fmode );
+}
+
+
+/***************************************************
+DESTRUCTOR
+Close the results file
+***************************************************/
+result::~result( void )
+{
+	res_bin_head head;
+
+	if ( f == NULL )
+		return;
+
+	if ( dobin )
+	{
+		// write the series directory, the names and the final header
+		fwrite( bin_dir.data( ), sizeof( res_bin_ser ), bin_dir.size( ), f );
+		fwrite( bin_names.data( ), 1, bin_names.size( ), f );
+
+		memset( & head, 0, sizeof( head ) );
+		strcpy( head.magic, RES_BIN_MAGIC );
+		head.version = RES_BIN_VER;
+		head.order = RES_BIN_ORDER;
+		head.first = bin_first;
+		head.last = bin_last;
+		head.series = bin_dir.size( );
+		head.chunk = RES_BIN_CHUNK;
+		head.dir = bin_pos;
+		head.names = bin_pos + bin_dir.size( ) * sizeof( res_bin_ser );
+		head.names_size = bin_names.size( );
+
+		fseek( f, 0, SEEK_SET );
+		fwrite( & head, sizeof( head ), 1, f );
+	}
+	else
+		if ( dozip )
+		{
+			if ( zipped == 0 || zbuf.size( ) > 0 )
+				gz_flush( );			// at least one (maybe empty) member
+
+			while ( zblocks.size( ) > 0 )
+				gz_write( );
+		}
+		else
+			fwrite( zbuf.data( ), 1, zbuf.size( ), f );
+
+	fclose( f );
+}
+
+
+/***************************************************
+PRINT
+Formats text to the results file buffer
+***************************************************/
+void result::print( const char *fmt, ... )
+{
+	char buf[ 2 * MAX_ELEM_LENGTH ];
+	int n;
+	size_t sz;
+	va_list args;
+
+	if ( f == NULL )
+		return;
+
+	va_start( args, fmt );
+	n = vsnprintf( buf, sizeof( buf ), fmt, args );
+	va_end( args );
+
+	if ( n < ( int ) sizeof( buf ) )
+		put( buf, n );
+	else
+	{
+		sz = zbuf.size( );
+		zbuf.resize( sz + n + 1 );
+		va_start( args, fmt );
+		vsnprintf( & zbuf[ sz ], n + 1, fmt, args );
+		va_end( args );
+		zbuf.resize( sz + n );
+		put( "", 0 );
+	}
+}
+
+
+/***************************************************
+PUT
+Appends text to the results file buffer, writing it
+in large blocks, compressed in parallel if zipping
+***************************************************/
+void result::put( const char *text, size_t len )
+{
+	zbuf.append( text, len );
 
-	return i;
+	if ( zbuf.size( ) >= GZ_BLOCK_SIZE )
+	{
+		if ( dozip )
+			gz_flush( );
+		else
+		{
+			fwrite( zbuf.data( ), 1, zbuf.size( ), f );
+			zbuf.clear( );
+		}
+	}
 }
 
 
-/*****************************************************************************
-EMPTY_SENSITIVITY
-	Deallocate sensitivity analysis memory
-******************************************************************************/
-void empty_sensitivity( sense *cs )
+/***************************************************
+GZ_FLUSH
+Hands the buffered text to a compression thread,
+producing an independent gzip member, so the members
+written in order make a standard (multi-member)
+gzip file. The oldest block is written when there
+are more blocks in progress than threads available
+***************************************************/
+static void gz_member( gz_block *blk )
 {
-	if ( cs == NULL )		// prevent invalid calls (last variable)
+	z_stream zs;
+
+	memset( & zs, 0, sizeof( zs ) );
+
+	if ( deflateInit2( & zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
 		return;
 
-	if ( cs->next != NULL )	// recursively start from the end of the list
-		empty_sensitivity( cs->next );
-#ifndef _NW_
-	else
-		NOLH_clear( );		// deallocate DoE (last object only)
-#endif
-	if ( cs->v != NULL )	// deallocate requested memory, if applicable
-		delete cs->v;
-	if ( cs->label != NULL )
-		delete cs->label;
+	blk->out.resize( deflateBound( & zs, blk->in.size( ) ) );
 
-	delete cs;				// suicide
-}
+	zs.next_in = ( Bytef * ) blk->in.data( );
+	zs.avail_in = blk->in.size( );
+	zs.next_out = ( Bytef * ) & blk->out[ 0 ];
+	zs.avail_out = blk->out.size( );
 
+	deflate( & zs, Z_FINISH );
+	blk->out.resize( zs.total_out );
+	deflateEnd( & zs );
 
-/*****************************************************************************
-SAVE_SENSITIVITY
-	Save current sensitivity configuration
-	Returns: true: save ok, false: save failure
-******************************************************************************/
-bool save_sensitivity( FILE *f )
+	string( ).swap( blk->in );			// release text early
+}
+
+void result::gz_flush( void )
 {
-	int i;
-	sense *cs;
+	gz_block *blk = new gz_block;
 
-	for ( cs = rsense; cs != NULL; cs = cs->next )
-	{
-		if ( cs->param == 1 )
-			fprintf( f, "%s 0 %d %c:", cs->label, cs->nvalues, cs->integer ? 'i' : 'f' );
-		else
-			fprintf( f, "%s -%d %d %c:", cs->label, cs->lag + 1, cs->nvalues, cs->integer ? 'i' : 'f' );
-		for ( i = 0; cs->v != NULL && i < cs->nvalues; ++i )
-			fprintf( f," %g", cs->v[ i ] );
-		fprintf( f,"\n" );
-	}
+	blk->in.swap( zbuf );
+	zblocks.push_back( blk );
+	++zipped;
 
-	return ! ferror( f );
+#ifndef _NP_
+	blk->worker = thread( gz_member, blk );
+
+	while ( ( int ) zblocks.size( ) > max( max_threads, 1 ) )
+		gz_write( );
+#else
+	gz_member( blk );
+	gz_write( );
+#endif
 }
 
 
-/****************************************************
-GET_SAVED
-****************************************************/
-void get_saved( object *n, FILE *out, const char *sep, bool all_var )
+/***************************************************
+GZ_WRITE
+Writes the oldest compressed block to file
+***************************************************/
+void result::gz_write( void )
 {
-	int i, sl;
-	char *lab;
-	bridge *cb;
-	description *cd;
-	object *co;
-	variable *cv;
+	gz_block *blk = zblocks.front( );
 
-	for ( cv = n->v; cv != NULL; cv = cv->next )
-		if ( cv->save || all_var )
-		{
-			// get element description
-			cd = search_description( cv->label, false );
-			if ( cd != NULL && cd->text != NULL && ( sl = strlen( cd->text ) ) > 0 )
-			{
-				// select just the first description line
-				lab = new char[ sl + 1 ];
-				strcpy( lab, cd->text );
-				for ( i = 0; i < sl; ++i )
-					if ( lab[ i ] == '\n' || lab[ i ] == '\r' )
-					{
-						lab[ i ] = '\0';
-						break;
-					}
-			}
-			else
-				lab = NULL;
+#ifndef _NP_
+	if ( blk->worker.joinable( ) )
+		blk->worker.join( );
+#endif
 
-			fprintf( out, "%s%s%s%s%s%s%s\n", cv->label, sep, cv->param ? "parameter" : "variable", sep, n->label, sep, lab != NULL ? lab : "" );
-		}
+	fwrite( blk->out.data( ), 1, blk->out.size( ), f );
 
-	for ( cb = n->b; cb != NULL; cb = cb->next )
-	{
-		if ( cb->head == NULL )
-			co = blueprint->search( cb->blabel );
-		else
-			co = cb->head;
-		get_saved( co, out, sep, all_var );
-	}
+	zblocks.erase( zblocks.begin( ) );
+	delete blk;
 }
 
 
-/****************************************************
-GET_SA_LIMITS
-****************************************************/
-const char *meta_par_name[ META_PAR_NUM ] = META_PAR_NAME;
+/***************************************************
+TITLE_BIN
+Update the tags of the series to save in binary
+format (the header is written by the destructor)
+***************************************************/
+void result::title_bin( object *root )
+{
+	save_plan( root );
 
-void get_sa_limits( object *r, FILE *out, const char *sep )
+	for ( auto cv : plan )
+		set_lab_tit( cv );
+}
+
+
+/***************************************************
+DATA_BIN
+Saves data in the specified period to binary file,
+one series at a time, in the same order of the
+text formats (binary files hold a single period)
+***************************************************/
+void result::data_bin( object *root, int initstep, int endtstep )
 {
-	int i, sl;
-	char *lab, type[ 10 ];
-	variable *cv;
-	description *cd;
-	sense *cs;
+	int i, j, k, n, first, last;
+	grave *cg;
+	vector < vector < double > > vals;
 
-	for ( i = 0; i < META_PAR_NUM; ++i )
-		meta_par_in[ i ] = false;
+	bin_first = initstep;
+	bin_last = endtstep;
 
-	for ( cs = rsense; cs != NULL; cs = cs->next )
+	save_plan( root );
+
+	for ( auto cv : plan )
 	{
-		// get current value (first object)
-		cv = r->search_var( NULL, cs->label );
+		first = max( initstep, cv->start );
+		last = min( endtstep, cv->end );
+		n = cv->arr != NULL ? cv->rows * cv->cols : 0;
+		vals.assign( n + 1, vector < double > ( max( last - first + 1, 0 ) ) );
 
-		// get element description
-		cd = search_description( cs->label, false );
-		if ( cd != NULL && cd->text != NULL && ( sl = strlen( cd->text ) ) > 0 )
+		for ( i = first; i <= last; ++i )
 		{
-			// select just the first description line
-			lab = new char[ sl + 1 ];
-			strcpy( lab, cd->text );
-			for ( i = 0; i < sl; ++i )
-				if ( lab[ i ] == '\n' || lab[ i ] == '\r' )
-				{
-					lab[ i ] = '\0';
-					break;
-				}
+			vals[ 0 ][ i - first ] = cv->get_data( i );
+
+			for ( k = 0; k < n; ++k )
+				vals[ k + 1 ][ i - first ] = cv->arr_data != NULL && cv->in_data( i ) ? cv->arr_data[ cv->data_pos( i ) * n + k ] : NAN;
 		}
-		else
-			lab = NULL;
 
-		// find max and min values
-		double min = HUGE_VAL, max = - HUGE_VAL;
-		for ( i = 0; cs->v != NULL &&  i < cs->nvalues; ++i )
-			if ( cs->v[ i ] < min )
-				min = cs->v[ i ];
-			else
-				if ( cs->v[ i ] > max )
-					max = cs->v[ i ];
+		bin_var( cv->label, cv->lab_tit, cv->rows, cv->cols, first, last, vals );
+	}
 
-		// check meta-parameters
-		if ( cs->param == 1 )
+	for ( j = 0; j < plan_dead; ++j )
+	{
+		cg = & cemetery.graves[ j ];
+		first = max( initstep, cg->start );
+		last = min( endtstep, cg->end );
+		n = cg->rows * cg->cols;
+		vals.assign( n + 1, vector < double > ( max( last - first + 1, 0 ) ) );
+
+		for ( i = first; i <= last; ++i )
 		{
-			strcpy( type, "parameter" );
+			vals[ 0 ][ i - first ] = cg->get_data( i );
 
-			for ( i = 0; i < META_PAR_NUM; ++i )
-				if ( ! strcmp( cs->label, meta_par_name[ i ] ) )
-				{
-					strcpy( type, "setting" );
-					meta_par_in[ i ] = true;
-					break;
-				}
+			for ( k = 0; k < n; ++k )
+				vals[ k + 1 ][ i - first ] = cg->get_arr( i, k );
 		}
-		else
-			strcpy( type, "variable" );
 
-		fprintf( out, "%s%s%s%s%d%s%s%s%g%s%g%s%g%s\"%s\"\n", cs->label, sep, type, sep, cs->param == 1 ? 0 : cs->lag + 1, sep, cs->integer ? "integer" : "real", sep, cv != NULL ? cv->val[ cs->lag ] : NAN, sep, min, sep, max, sep, lab != NULL ? lab : "" );
-
-		delete [ ] lab;
+		bin_var( cg->label, cg->lab_tit, cg->rows, cg->cols, first, last, vals );
 	}
 }
 
 
 /***************************************************
-SAVE_EQFILE
+BIN_VAR
+Appends the series of a variable (and its array
+elements, if any) to the binary file
 ***************************************************/
-void save_eqfile( FILE *f )
+void result::bin_var( const char *lab, const char *tag, int rows, int cols, int start, int end, vector < vector < double > > &vals )
 {
-	if ( eq_file != NULL && ( strlen( lsd_eq_file ) == 0 || strcmp( lsd_eq_file, eq_file ) != 0 ) )
-		strcpyn( lsd_eq_file, eq_file, MAX_FILE_SIZE );
+	char elem[ MAX_ELEM_LENGTH ];
+	int k;
 
-	fprintf( f, "\nEQ_FILE\n" );
-	fprintf( f, "%s", lsd_eq_file );
-	fprintf( f, "\nEND_EQ_FILE\n" );
+	bin_series( lab, tag, start, end, vals[ 0 ].data( ) );
+
+	for ( k = 1; k < ( int ) vals.size( ); ++k )
+	{
+		if ( cols == 1 )
+			snprintf( elem, MAX_ELEM_LENGTH, "%s_%d", lab, k );
+		else
+			snprintf( elem, MAX_ELEM_LENGTH, "%s_%d_%d", lab, ( k - 1 ) % rows + 1, ( k - 1 ) / rows + 1 );
+
+		bin_series( elem, tag, start, end, vals[ k ].data( ) );
+	}
 }
 
 
-#ifndef _NW_
+/***************************************************
+SERIES
+Appends the series of a variable saved on its own
+to the binary file, extending the file period
+***************************************************/
+void result::series( const char *lab, const char *tag, int rows, int cols, int start, int end, vector < vector < double > > &vals )
+{
+	bin_last = max( bin_last, end );
+	bin_var( lab, tag, rows, cols, start, end, vals );
+}
+
 
 /***************************************************
-READ_EQ_FILENAME
+BIN_SERIES
+Appends a series to the binary file, in chunks of
+RES_BIN_CHUNK values, compressed if zipping and
+smaller, followed by the series chunk table.
+Values are compressed with their bytes grouped by
+position (all first bytes, all second bytes...),
+as successive values share most of the high bytes
 ***************************************************/
-void read_eq_filename( char *s, int sz )
+static bool bin_deflate( Bytef *dest, uLongf *destLen, const Bytef *src, uLong srcLen )
 {
-	char lab[ MAX_PATH_LENGTH ];
-	FILE *f;
+	int res;
+	z_stream zs;
 
-	snprintf( lab, MAX_PATH_LENGTH, "%s/%s", exec_path, MODEL_OPTIONS );
-	f = fopen( lab, "r" );
+	memset( & zs, 0, sizeof( zs ) );
+
+	// run-length matching is as good as full search for grouped bytes
+	if ( deflateInit2( & zs, Z_BEST_SPEED, Z_DEFLATED, 15, 8, Z_RLE ) != Z_OK )
+		return false;
+
+	zs.next_in = ( Bytef * ) src;
+	zs.avail_in = srcLen;
+	zs.next_out = dest;
+	zs.avail_out = *destLen;
+
+	res = deflate( & zs, Z_FINISH );
+	*destLen = zs.total_out;
+	deflateEnd( & zs );
+
+	return res == Z_STREAM_END;
+}
+
+void result::bin_series( const char *lab, const char *tag, int start, int end, const double *data )
+{
+	const char pad[ 8 ] = { 0 };
+	int b, c, i, m, n = max( end - start + 1, 0 );
+	uLongf sz;
+	res_bin_ser ser;
+	vector < Bytef > sbuf, zbuf;
+	vector < res_bin_chk > tab( ( n + RES_BIN_CHUNK - 1 ) / RES_BIN_CHUNK );
 
 	if ( f == NULL )
-	{
-		cmd( "ttk::messageBox -parent . -title Error -icon error -type ok -message \"File not found\" -detail \"File '$MODEL_OPTIONS' missing, cannot upload the equation file.\nYou may have to recreate your model configuration.\"" );
 		return;
+
+	if ( n == 0 )						// empty series start at file beginning
+	{
+		start = bin_first;
+		end = bin_first - 1;
 	}
 
-	fscanf( f, "%999s", lab );
-	for ( int i = 0; strncmp( lab, "FUN=", 4 ) && fscanf( f, "%999s", lab ) != EOF && i < MAX_FILE_TRY; ++i );
-	fclose( f );
-	if ( strncmp( lab, "FUN=", 4 ) != 0 )
+	if ( dozip )
 	{
-		cmd( "ttk::messageBox -parent . -type ok -title -title Error -icon error -message \"File corrupted\" -detail \"File '$MODEL_OPTIONS' has invalid contents, cannot upload the equation file.\nYou may have to recreate your model configuration.\"" );
-		return;
+		sbuf.resize( RES_BIN_CHUNK * sizeof( double ) );
+		zbuf.resize( compressBound( RES_BIN_CHUNK * sizeof( double ) ) );
 	}
 
-	strcpyn( s, lab + 4, sz );
-	strcatn( s, ".cpp", sz );
+	for ( c = 0; c < ( int ) tab.size( ); ++c, data += m )
+	{
+		m = min( RES_BIN_CHUNK, n - c * RES_BIN_CHUNK );
+		sz = zbuf.size( );
+
+		tab[ c ].pos = bin_pos;
+
+		if ( dozip )
+			for ( i = 0; i < m; ++i )
+				for ( b = 0; b < ( int ) sizeof( double ); ++b )
+					sbuf[ b * m + i ] = ( ( const Bytef * ) ( data + i ) )[ b ];
+
+		if ( dozip && bin_deflate( zbuf.data( ), & sz, sbuf.data( ), m * sizeof( double ) ) && sz < m * sizeof( double ) )
+		{
+			tab[ c ].size = sz;
+			tab[ c ].zip = 1;
+			fwrite( zbuf.data( ), 1, sz, f );
+			fwrite( pad, 1, ( 8 - sz % 8 ) % 8, f );	// keep 8-byte alignment
+			bin_pos += sz + ( 8 - sz % 8 ) % 8;
+		}
+		else
+		{
+			tab[ c ].size = m * sizeof( double );
+			tab[ c ].zip = 0;
+			fwrite( data, sizeof( double ), m, f );
+			bin_pos += tab[ c ].size;
+		}
+	}
+
+	memset( & ser, 0, sizeof( ser ) );
+	ser.label = bin_name( lab );
+	ser.tag = bin_name( tag );
+	ser.start = start;
+	ser.end = end;
+	ser.chunks = bin_pos;
+	bin_dir.push_back( ser );
+
+	fwrite( tab.data( ), sizeof( res_bin_chk ), tab.size( ), f );
+	bin_pos += tab.size( ) * sizeof( res_bin_chk );
+}
+
+
+/***************************************************
+DATA_VALUE
+Saves a single value, as n/a if not available
+***************************************************/
+void result::data_value( double val )
+{
+	char buf[ MAX_ELEM_LENGTH ];
+	int n = 0;
+
+	if ( f == NULL )
+		return;
+
+	if ( docsv && ! firstCol )
+		buf[ n++ ] = CSV_SEP[ 0 ];
+
+	if ( ! is_nan( val ) )
+		n += strnum( buf + n, val, SIG_DIG, 'G', sizeof( buf ) - n );
+	else
+		n += strlen( strcpyn( buf + n, nonavail, sizeof( buf ) - n ) );
+
+	if ( ! docsv )
+		buf[ n++ ] = '\t';
+
+	put( buf, n );
+
+	firstCol = false;
+}
+
+
+/***************************************************
+Results streaming
+
+When streaming, saved series keep just the last
+2 x stream_steps + 1 values in memory. Every
+stream_steps time steps, the block of values just
+completed (but the last step, which new objects
+may still save) is handed to a background thread,
+which appends it to a temporary spool file, while
+the simulation proceeds filling the other half of
+the buffers (double buffering). As objects may be
+created or deleted along the run, the results file
+columns are only known at the end, so the spool is
+stored by series serial number and arranged in
+rows by result::stream.
+
+Spool block format: first step, last step and
+number of series, followed, for each series, by
+the serial number, the first step, the number of
+steps, the values per step (1 + array elements)
+and the values.
+***************************************************/
+
+struct stream_rec						// series to write in a block
+{
+	int serial;
+	int first;
+	int last;
+	int start;
+	int step;							// saved time steps interval
+	int size;							// circular buffer size
+	int width;							// values per step
+	double *data;
+	double *arr_data;
+};
+
+struct stream_pos						// series values position in the spool
+{
+	long pos;
+	int first;
+	int steps;
+	int width;
+};
+
+static void stream_write( vector < stream_rec > *recs, int first, int last );
+
+static size_t stream_buried = 0;		// deleted objects series already streamed
+
+#ifndef _NP_
+thread stream_thread;					// background results writer
+#endif
+
+
+/***************************************************
+STREAM_OPEN
+Create a new spool file for streaming results
+***************************************************/
+bool stream_open( void )
+{
+	stream_close( );
+
+	stream_buried = 0;
+	stream_file = tmpfile( );
+
+	return stream_file != NULL;
+}
 
-	return;
+
+/***************************************************
+STREAM_WAIT
+Wait for the background writer to finish
+***************************************************/
+static void stream_wait( void )
+{
+#ifndef _NP_
+	if ( stream_thread.joinable( ) )
+		stream_thread.join( );
+#endif
 }
 
 
 /***************************************************
-UPLOAD_EQFILE
+STREAM_CLOSE
+Remove the spool file, if any
 ***************************************************/
-char *upload_eqfile( void )
+void stream_close( void )
 {
-	char s[ MAX_PATH_LENGTH ], line[ MAX_LINE_SIZE ], *eq;
-	int sz;
-	FILE *f;
+	stream_wait( );
 
-	read_eq_filename( s, MAX_PATH_LENGTH );
-	if ( ( f = fopen( s, "r" ) ) == NULL )
-		return NULL;
+	if ( stream_file != NULL )
+		fclose( stream_file );
 
-	cmd( "set res [ file size %s ]", s );
-	sz = get_int( "res" ) + 1;
-	eq = new char[ sz ];
-	strcpy( eq, "" );
+	stream_file = NULL;
+}
 
-	while ( fgets( line, MAX_LINE_SIZE, f ) != NULL )
-		strcatn( eq, line, sz );
 
-	fclose( f );
+/***************************************************
+STREAM_BLOCK
+Hand the saved values after the last streamed
+step up to step last to the background writer
+***************************************************/
+static void stream_collect( variable *cv, vector < stream_rec > *recs, int first, int last )
+{
+	stream_rec rec;
 
-	return eq;
+	for ( ; cv != NULL; cv = cv->next )
+		if ( ( cv->save || cv->savei ) && cv->data != NULL && cv->start <= last && cv->end >= first )
+		{
+			rec.serial = cv->serial;
+			rec.first = max( first, cv->start );
+			rec.last = min( last, cv->end );
+			rec.start = cv->start;
+			rec.step = cv->data_step;
+			rec.size = cv->data_size;
+			rec.width = 1 + ( cv->arr_data != NULL ? cv->rows * cv->cols : 0 );
+			rec.data = cv->data;
+			rec.arr_data = cv->arr_data;
+			recs->push_back( rec );
+		}
 }
 
-
-/****************************************************
-SHOW_LOGS
-Open tail/multitail to show log files dynamically
-****************************************************/
-void show_logs( const char *path, vector < string > & logs, bool par_cntl )
+static void stream_dead( vector < stream_rec > *recs, int first, int last )
 {
-	char exec[ MAX_PATH_LENGTH	];
-	int i, j, n, sz;
+	grave *cg;
+	stream_rec rec;
 
-	cmd( "switch [ ttk::messageBox -parent . -type yesno -default yes -icon info -title \"Background run monitor\" -message \"Open the background run monitor?\" -detail \"The selected simulation runs were started as parallel background job(s). Each job progress can be monitored in a separated window results by choosing 'Yes'\n\nLog files are being created in the folder:\n\n[ fn_break [ file nativename \"%s\" ] 40 ]\" ] { yes { set ans 1 } no { set ans 0 } }", path );
+	// release the series already streamed, in deletion order
+	while ( stream_buried < cemetery.graves.size( ) && cemetery.graves[ stream_buried ].end < first )
+		cemetery.graves[ stream_buried++ ].free_data( );
 
-	if ( ! get_int( "ans" ) || ( par_cntl && ! parallel_monitor ) )
-		return;
+	for ( size_t i = stream_buried; i < cemetery.graves.size( ); ++i )
+	{
+		cg = & cemetery.graves[ i ];
 
-	lock_guard < mutex > lock( lock_run_logs );
+		if ( cg->data != NULL && cg->start <= last && cg->end >= first )
+		{
+			rec.serial = cg->serial;
+			rec.first = max( first, cg->start );
+			rec.last = min( last, cg->end );
+			rec.start = cg->start;
+			rec.step = cg->data_step;
+			rec.size = cg->data_size;
+			rec.width = 1 + ( cg->arr_data != NULL ? cg->rows * cg->cols : 0 );
+			rec.data = cg->data;
+			rec.arr_data = cg->arr_data;
+			recs->push_back( rec );
+		}
+	}
+}
 
-	n = logs.size( );
-	if ( n == 0 )
-		return;
+static void stream_tree( object *r, vector < stream_rec > *recs, int first, int last )
+{
+	bridge *cb;
+	object *cur;
 
-	for ( i = j = 0; i < n; ++i )
-		j += logs[ i ].length( );
+	stream_collect( r->v, recs, first, last );
 
-	sz = i + j + 1;
-	char logs_str[ sz ];
-	strcpy( logs_str, "" );
+	for ( cb = r->b; cb != NULL; cb = cb->next )
+		for ( cur = cb->head; cur != NULL; cur = cur->next )
+			stream_tree( cur, recs, first, last );
+}
 
-	for ( i = 0; i < n; ++i )
-	{
-		strcatn( logs_str, logs[ i ].c_str( ), sz );
+void stream_block( object *root, int last )
+{
+	int first = stream_done + 1;
+	vector < stream_rec > *recs;
 
-		if ( i < n - 1 )
-			strcatn( logs_str, " ", sz );
-	}
+	if ( stream_file == NULL || last < first )
+		return;
 
-	if ( n == 1 )
-		strcpy( exec, "tail -n 20 -F" );
-	else
-	{
-		// number of terminal columns
-		j = n > 4 ? ( n > 8 ? ( n > 12 ? 4 : 3 ) : 2 ) : 1;
+	stream_wait( );			// previous block must be done
 
-		if ( j == 1 )
-			snprintf( exec, MAX_PATH_LENGTH , "multitail%s", platform == _WIN_ ? "" : " --retry-all" );
-		else
-			snprintf( exec, MAX_PATH_LENGTH , "multitail%s -s %d", platform == _WIN_ ? "" : " --retry-all", j );
-	}
+	recs = new vector < stream_rec >;
+	stream_tree( root, recs, first, last );
+	stream_dead( recs, first, last );
 
-	cmd( "if { [ open_terminal \"%s %s\" ] != 0 } { \
-			ttk::messageBox -parent . -type ok -icon error -title Error -message \"%s failed to launch\" -detail \"Please check if %s is installed and set up properly.\n\nDetail:\n$termResult\" \
-		}", exec, logs_str, exec, exec );
-}
+	stream_done = last;
 
+#ifndef _NP_
+	stream_thread = thread( stream_write, recs, first, last );
+#else
+	stream_write( recs, first, last );
 #endif
+}
 
-/***************************************************
-RESULT
-Methods for results file saving (class result)
-***************************************************/
 
 /***************************************************
-DATA
-Saves data to file in the specified period
+STREAM_WRITE
+Append a block of saved values to the spool file
+(run in the background writer thread)
 ***************************************************/
-void result::data( object *root, int initstep, int endtstep )
+static void stream_write( vector < stream_rec > *recs, int first, int last )
 {
-	// don't include initialization (t=0) in .csv format
-	initstep = ( docsv && initstep < 1 ) ? 1 : initstep;
-	// adjust for 1 time step if needed
-	endtstep = ( endtstep == 0 ) ? initstep : endtstep;
-
-	for ( int i = initstep; i <= endtstep; i++ )
-	{
-		firstCol = true;
+	int i, hdr[ 4 ], n, pos;
+	double *row;
 
-		data_recursive( root, i );		// output one data line
+	hdr[ 0 ] = first;
+	hdr[ 1 ] = last;
+	hdr[ 2 ] = recs->size( );
+	fwrite( hdr, sizeof( int ), 3, stream_file );
 
-		if ( dozip )					// and change line
-			gzprintf( fz, "\n" );
-		else
-			fprintf( f, "\n" );
-	}
-}
+	for ( auto &rec : *recs )
+	{
+		hdr[ 0 ] = rec.serial;
+		hdr[ 1 ] = rec.first;
+		hdr[ 2 ] = rec.last - rec.first + 1;
+		hdr[ 3 ] = n = rec.width;
+		fwrite( hdr, sizeof( int ), 4, stream_file );
 
-void result::data_recursive( object *r, int i )
-{
-	bridge *cb;
-	object *cur;
-	variable *cv;
+		row = new double[ n ];
 
-	for ( cv = r->v; cv != NULL; cv = cv->next )
-	{
-		if ( cv->save == 1 )
+		for ( i = rec.first; i <= rec.last; ++i )
 		{
-			if ( cv->start <= i && cv->end >= i && ! is_nan( cv->data[ i - cv->start ] ) )
+			if ( ( i - rec.start ) % rec.step == 0 )
 			{
-				if ( dozip )
-				{
-					if ( docsv )
-						gzprintf( fz, "%s%.*G", firstCol ? "" : CSV_SEP, SIG_DIG, cv->data[ i - cv->start ] );
-					else
-						gzprintf( fz, "%.*G\t", SIG_DIG, cv->data[ i - cv->start ] );
-				}
-				else
-				{
-					if ( docsv )
-						fprintf( f, "%s%.*G", firstCol ? "" : CSV_SEP, SIG_DIG, cv->data[ i - cv->start ] );
-					else
-						fprintf( f, "%.*G\t", SIG_DIG, cv->data[ i - cv->start ] );
-				}
+				pos = ( i - rec.start ) / rec.step % rec.size;
+				row[ 0 ] = rec.data[ pos ];
+
+				if ( n > 1 )
+					memcpy( row + 1, rec.arr_data + pos * ( n - 1 ), ( n - 1 ) * sizeof( double ) );
 			}
 			else
-			{
-				if ( dozip )		// save NaN as n/a
-				{
-					if ( docsv )
-						gzprintf( fz, "%s%s", firstCol ? "" : CSV_SEP, nonavail );
-					else
-						gzprintf( fz, "%s\t", nonavail );
-				}
-				else
-				{
-					if ( docsv )
-						fprintf( f, "%s%s", firstCol ? "" : CSV_SEP, nonavail );
-					else
-						fprintf( f, "%s\t", nonavail );
-				}
-			}
+				fill( row, row + n, NAN );
 
-			firstCol = false;
+			fwrite( row, sizeof( double ), n, stream_file );
 		}
+
+		delete [ ] row;
 	}
 
-	for ( cb = r->b; cb != NULL; cb = cb->next )
+	delete recs;
+}
+
+
+/***************************************************
+STREAM
+Saves the streamed data to file, up to endtstep,
+in the same format of data( )
+***************************************************/
+void result::stream( object *root, int endtstep )
+{
+	int i, j, k, blk[ 3 ], rec[ 4 ], initstep, width;
+	vector < double > block;
+	unordered_map < int, int > col_pos;
+	unordered_map < int, int >::iterator it;
+
+	if ( dobin )
 	{
-		if ( cb->head == NULL )
-			continue;
+		bin_stream( root, endtstep );
+		return;
+	}
+
+	stream_wait( );
+	save_plan( root );
+
+	// position of each series in the rows
+	for ( width = 0, i = 0; i < ( int ) plan.size( ); ++i )
+	{
+		col_pos[ plan[ i ]->serial ] = width;
+		width += 1 + ( plan[ i ]->arr != NULL ? plan[ i ]->rows * plan[ i ]->cols : 0 );
+	}
 
-		cur = cb->head;
-		if ( cur->to_compute )
-			for ( ; cur != NULL; cur = cur->next )
-				data_recursive( cur, i );
+	for ( i = 0; i < plan_dead; ++i )
+	{
+		col_pos[ cemetery.graves[ i ].serial ] = width;
+		width += 1 + cemetery.graves[ i ].rows * cemetery.graves[ i ].cols;
 	}
 
-	if ( r->up == NULL )
+	// don't include initialization (t=0) in .csv format
+	initstep = docsv ? 1 : 0;
+
+	rewind( stream_file );
+
+	while ( fread( blk, sizeof( int ), 3, stream_file ) == 3 )
 	{
-		for ( cv = cemetery; cv != NULL; cv = cv->next )
+		block.assign( ( size_t ) ( blk[ 1 ] - blk[ 0 ] + 1 ) * width, NAN );
+
+		for ( k = 0; k < blk[ 2 ] && fread( rec, sizeof( int ), 4, stream_file ) == 4; ++k )
 		{
-			if ( cv->start <= i && cv->end >= i && ! is_nan( cv->data[ i - cv->start ] ) )
-			{
-				if ( dozip )
-				{
-					if ( docsv )
-						gzprintf( fz, "%s%.*G", firstCol ? "" : CSV_SEP, SIG_DIG, cv->data[ i - cv->start ] );
-					else
-						gzprintf( fz, "%.*G\t", SIG_DIG, cv->data[ i - cv->start ] );
-				}
-				else
-				{
-					if ( docsv )
-						fprintf( f, "%s%.*G", firstCol ? "" : CSV_SEP, SIG_DIG, cv->data[ i - cv->start ] );
-					else
-						fprintf( f, "%.*G\t", SIG_DIG, cv->data[ i - cv->start ] );
-				}
-			}
-			else					// save NaN as n/a
+			it = col_pos.find( rec[ 0 ] );
+
+			for ( i = 0; i < rec[ 2 ]; ++i )
 			{
-				if ( dozip )
-				{
-					if ( docsv )
-						gzprintf( fz, "%s%s", firstCol ? "" : CSV_SEP, nonavail );
-					else
-						gzprintf( fz, "%s\t", nonavail );
-				}
-				else
-				{
-					if ( docsv )
-						fprintf( f, "%s%s", firstCol ? "" : CSV_SEP, nonavail );
-					else
-						fprintf(f, "%s\t", nonavail );
-				}
+				j = ( rec[ 1 ] + i - blk[ 0 ] ) * width;
+
+				if ( it != col_pos.end( ) )
+					fread( & block[ j + it->second ], sizeof( double ), rec[ 3 ], stream_file );
+				else		// skip series not in the results file
+					fseek( stream_file, rec[ 3 ] * sizeof( double ), SEEK_CUR );
 			}
+		}
+
+		for ( i = max( blk[ 0 ], initstep ); i <= min( blk[ 1 ], endtstep ); ++i )
+		{
+			firstCol = true;
+
+			for ( j = ( i - blk[ 0 ] ) * width, k = 0; k < width; ++k )
+				data_value( block[ j + k ] );
 
-			firstCol = false;
+			print( "\n" );
 		}
 	}
 }
 
 
+
 /***************************************************
-TITLE
-Saves header to file
+BIN_NAME
+Position of a name in the binary file names table,
+adding it if not there yet
 ***************************************************/
-void result::title( object *root, int flag )
+uint32_t result::bin_name( const char *name )
 {
-	firstCol = true;
+	auto it = bin_name_pos.find( name );
 
-	title_recursive( root, flag );		// output header
+	if ( it != bin_name_pos.end( ) )
+		return it->second;
 
-	if ( dozip )						// and change line
-		gzprintf( fz, "\n" );
-	else
-		fprintf( f, "\n" );
+	bin_name_pos[ name ] = bin_names.size( );
+	bin_names.append( name );
+	bin_names.push_back( '\0' );
+
+	return bin_name_pos[ name ];
 }
 
-void result::title_recursive( object *r, int header )
+
+/***************************************************
+BIN_STREAM
+Saves the streamed data to binary file, up to
+endtstep, gathering each series from all blocks
+***************************************************/
+void result::bin_stream( object *root, int endtstep )
 {
-	bool single = false;
-	bridge *cb;
-	object *cur;
-	variable *cv;
+	char *lab, *tag;
+	int i, j, k, n, rows, cols, serial, first, last, t, blk[ 3 ], rec[ 4 ];
+	grave *cg;
+	stream_pos sp;
+	vector < double > buf;
+	vector < vector < double > > vals;
+	unordered_map < int, vector < stream_pos > > spool;
 
-	for ( cv = r->v; cv != NULL; cv = cv->next )
-	{
-		if ( cv->save == 1 )
-		{
-			set_lab_tit( cv );
-			if ( ( ! strcmp( cv->lab_tit, "1" ) || ! strcmp( cv->lab_tit, "1_1" ) || ! strcmp( cv->lab_tit, "1_1_1" ) || ! strcmp( cv->lab_tit, "1_1_1_1" ) ) && cv->up->hyper_next( ) == NULL )
-				single = true;					// prevent adding suffix to single objects
+	stream_wait( );
+	save_plan( root );
 
-			if ( header )
-			{
-				if ( dozip )
-				{
-					if ( docsv )
-						gzprintf( fz, "%s%s%s%s", firstCol ? "" : CSV_SEP, cv->label, single ? "" : "_", single ? "" : cv->lab_tit );
-					else
-						gzprintf( fz, "%s %s (%d %d)\t", cv->label, cv->lab_tit, cv->start, cv->end );
-				}
-				else
-				{
-					if ( docsv )
-						fprintf( f, "%s%s%s%s", firstCol ? "" : CSV_SEP, cv->label, single ? "" : "_", single ? "" : cv->lab_tit );
-					else
-						fprintf( f, "%s %s (%d %d)\t", cv->label, cv->lab_tit, cv->start, cv->end );
-				}
-			}
-			else
-			{
-				if ( dozip )
-				{
-					if ( docsv )
-						gzprintf( fz, "%s%s%s%s", firstCol ? "" : CSV_SEP, cv->label, single ? "" : "_", single ? "" : cv->lab_tit );
-					else
-						gzprintf( fz, "%s %s (-1 -1)\t", cv->label, cv->lab_tit );
-				}
-				else
-				{
-					if ( docsv )
-						fprintf( f, "%s%s%s%s", firstCol ? "" : CSV_SEP, cv->label, single ? "" : "_", single ? "" : cv->lab_tit );
-					else
-						fprintf( f, "%s %s (-1 -1)\t", cv->label, cv->lab_tit );
-				}
-			}
+	bin_first = 0;
+	bin_last = endtstep;
 
-			firstCol = false;
+	// index the series values in the spool
+	rewind( stream_file );
+
+	while ( fread( blk, sizeof( int ), 3, stream_file ) == 3 )
+		for ( k = 0; k < blk[ 2 ] && fread( rec, sizeof( int ), 4, stream_file ) == 4; ++k )
+		{
+			sp.pos = ftell( stream_file );
+			sp.first = rec[ 1 ];
+			sp.steps = rec[ 2 ];
+			sp.width = rec[ 3 ];
+			spool[ rec[ 0 ] ].push_back( sp );
+			fseek( stream_file, ( long ) rec[ 2 ] * rec[ 3 ] * sizeof( double ), SEEK_CUR );
 		}
-	}
 
-	for ( cb = r->b; cb != NULL; cb = cb->next )
+	// series alive first, then the dead ones
+	for ( j = 0; j < ( int ) plan.size( ) + plan_dead; ++j )
 	{
-		if ( cb->head == NULL )
-			continue;
-
-		cur = cb->head;
-		if ( cur->to_compute )
+		if ( j < ( int ) plan.size( ) )
 		{
-			for ( ; cur != NULL; cur = cur->next )
-			title_recursive( cur, header );
+			variable *cv = plan[ j ];
+			lab = cv->label;
+			tag = cv->lab_tit;
+			rows = cv->arr != NULL ? cv->rows : 0;
+			cols = cv->cols;
+			serial = cv->serial;
+			first = max( 0, cv->start );
+			last = min( endtstep, cv->end );
+		}
+		else
+		{
+			cg = & cemetery.graves[ j - plan.size( ) ];
+			lab = cg->label;
+			tag = cg->lab_tit;
+			rows = cg->rows;
+			cols = cg->cols;
+			serial = cg->serial;
+			first = max( 0, cg->start );
+			last = min( endtstep, cg->end );
 		}
-	}
 
-	if ( r->up == NULL )
-	{
-		for ( cv = cemetery; cv != NULL; cv = cv->next )
+		n = rows * cols;
+		vals.assign( n + 1, vector < double > ( max( last - first + 1, 0 ), NAN ) );
+
+		for ( auto &p : spool[ serial ] )
 		{
-			if ( dozip )
-			{
-				if ( docsv )
-					gzprintf( fz, "%s%s%s%s", firstCol ? "" : CSV_SEP, cv->label, single ? "" : "_", single ? "" : cv->lab_tit );
-				else
-					gzprintf( fz, "%s %s (%d %d)\t", cv->label, cv->lab_tit, cv->start, cv->end );
-			}
-			else
+			buf.resize( ( size_t ) p.steps * p.width );
+			fseek( stream_file, p.pos, SEEK_SET );
+			fread( buf.data( ), sizeof( double ), buf.size( ), stream_file );
+
+			for ( i = 0; i < p.steps; ++i )
 			{
-				if ( docsv )
-					fprintf( f, "%s%s%s%s", firstCol ? "" : CSV_SEP, cv->label, single ? "" : "_", single ? "" : cv->lab_tit );
-				else
-					fprintf( f, "%s %s (%d %d)\t", cv->label, cv->lab_tit, cv->start, cv->end );
+				t = p.first + i;
+				if ( t >= first && t <= last )
+					for ( k = 0; k < min( p.width, n + 1 ); ++k )
+						vals[ k ][ t - first ] = buf[ i * p.width + k ];
 			}
-
-			firstCol = false;
 		}
-	}
-}
-
-/***************************************************
-CONSTRUCTOR
-Open the appropriate file for saving the results
-***************************************************/
-result::result( const char *fname, const char *fmode, bool dozip, bool docsv )
-{
-	this->docsv = docsv;
-	this->dozip = dozip;		// save local class flag
-	if ( dozip )
-		fz = gzopen( fname, fmode );
-	else
-		f = fopen( fname, fmode );
-}
-
 
-/***************************************************
-DESTRUCTOR
-Close the results file
-***************************************************/
-result::~result( void )
-{
-	if ( dozip )
-		gzclose( fz );
-	else
-		fclose( f );
+		bin_var( lab, tag, rows, cols, first, last, vals );
+	}
 }
 
 
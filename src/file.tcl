@@ -1039,14 +1039,14 @@ proc get_source_files { path } {
 #************************************************
 # list of commands to search for parameters and objects
 # (X_Y : X=number of macro arguments, Y=position of parameter/object)
-set cmdp_1_1 [ list V SUM MAX MIN AVE MED SD STAT RECALC LAST_CALC INIT_TSEARCH_CND ]
-set cmdp_2_1 [ list VL SUML MAXL MINL AVEL MEDL WHTAVE SDL SEARCH_CND TSEARCH_CND WRITE INCR MULT V_CHEAT ]
-set cmdp_2_2 [ list VS SUMS MAXS MINS AVES MEDS WHTAVE SDS STATS RNDDRAW RECALCS LAST_CALCS INIT_TSEARCH_CNDS ]
-set cmdp_3_1 [ list WRITEL SEARCH_CNDL V_CHEATL ]
-set cmdp_3_2 [ list VLS SUMLS MAXLS MINLS AVELS MEDLS WHTAVES SDLS SEARCH_CNDS TSEARCH_CNDS RNDDRAWL RNDDRAW_TOT WRITES INCRS MULTS SORT V_CHEATS ]
+set cmdp_1_1 [ list V SUM MAX MIN AVE MED SD STAT RECALC LAST_CALC INIT_TSEARCH_CND VEC_IN ARR ARR_MAT ARR_ROWS ARR_COLS ]
+set cmdp_2_1 [ list VL SUML MAXL MINL AVEL MEDL WHTAVE SDL SEARCH_CND TSEARCH_CND WRITE INCR MULT V_CHEAT VEC_INL ARRL ARR_MATL ]
+set cmdp_2_2 [ list VS SUMS MAXS MINS AVES MEDS WHTAVE SDS STATS RNDDRAW RECALCS LAST_CALCS INIT_TSEARCH_CNDS ARRS ARR_MATS ARR_ROWSS ARR_COLSS ]
+set cmdp_3_1 [ list WRITEL SEARCH_CNDL V_CHEATL RESIZE_ARR ]
+set cmdp_3_2 [ list VLS SUMLS MAXLS MINLS AVELS MEDLS WHTAVES SDLS SEARCH_CNDS TSEARCH_CNDS RNDDRAWL RNDDRAW_TOT WRITES INCRS MULTS SORT V_CHEATS ARRLS ARR_MATLS ]
 set cmdp_3_3 [ list WHTAVES RNDDRAWS ]
 set cmdp_4_1 [ list WRITELL SUM_CND MAX_CND MIN_CND AVE_CND MED_CND SD_CND STAT_CND ]
-set cmdp_4_2 [ list WHTAVELS WRITELS SEARCH_CNDLS RNDDRAW_TOTL SORT2 V_CHEATLS SUM_CND MAX_CND MIN_CND AVE_CND MED_CND SD_CND COUNT_CND COUNT_ALL_CND STAT_CND ]
+set cmdp_4_2 [ list WHTAVELS WRITELS SEARCH_CNDLS RNDDRAW_TOTL SORT2 V_CHEATLS SUM_CND MAX_CND MIN_CND AVE_CND MED_CND SD_CND COUNT_CND COUNT_ALL_CND STAT_CND RESIZE_ARRS ]
 set cmdp_4_3 [ list WHTAVELS RNDDRAWLS RNDDRAW_TOTS SORTS SORT2 ]
 set cmdp_5_1 [ list SUM_CNDL MAX_CNDL MIN_CNDL AVE_CNDL WHTAVE_CND MED_CNDL PERC_CND SD_CNDL STAT_CNDL ]
 set cmdp_5_2 [ list WRITELLS SUM_CNDS SUM_CNDL MAX_CNDS MAX_CNDL MIN_CNDL AVE_CNDL WHTAVE_CND MED_CNDS MED_CNDL SD_CNDS SD_CNDL COUNT_CNDL COUNT_ALL_CNDL STAT_CNDS STAT_CNDL ]
@@ -1060,9 +1060,9 @@ set cmdp_7_2 [ list WHTAVE_CNDLS PERC_CNDLS ]
 set cmdp_7_3 [ list WHTAVE_CNDLS ]
 set cmdp_7_4 [ list WHTAVE_CNDLS PERC_CNDLS ]
 
-set cmdo_1_1 [ list COUNT COUNT_ALL SEARCH RNDDRAW_FAIR ADDOBJ DELETE_NET SHUFFLE_NET INIT_TSEARCH ]
+set cmdo_1_1 [ list COUNT COUNT_ALL SEARCH RNDDRAW_FAIR ADDOBJ DELETE_NET SHUFFLE_NET INIT_TSEARCH INIT_COLUMNS ]
 set cmdo_2_1 [ list RNDDRAW ADDOBJL ADDNOBJ ADDOBJ_EX LOAD_NET SAVE_NET SNAP_NET TSEARCH INIT_TSEARCHT ]
-set cmdo_2_2 [ list COUNTS COUNT_ALLS SEARCHS RNDDRAW_FAIRS CYCLE CYCLE_SAFE ADDOBJS DELETE_NETS SHUFFLE_NETS INIT_TSEARCHS ]
+set cmdo_2_2 [ list COUNTS COUNT_ALLS SEARCHS RNDDRAW_FAIRS CYCLE CYCLE_SAFE ADDOBJS DELETE_NETS SHUFFLE_NETS INIT_TSEARCHS INIT_COLUMNSS ]
 set cmdo_3_1 [ list RNDDRAWL RNDDRAW_TOT ADDNOBJL ADDOBJ_EXL ADDNOBJ_EX SORT ]
 set cmdo_3_2 [ list RNDDRAWS ADDOBJLS ADDNOBJS ADDOBJ_EXS LOAD_NETS SAVE_NETS SNAP_NETS TSEARCHS INIT_TSEARCHTS ]
 set cmdo_3_3 [ list CYCLES CYCLE_SAFES ]
@@ -1113,6 +1113,11 @@ proc create_elem_file { path } {
 			lappend vars $var
 		}
 
+		set eqs [ regexp -all -inline -- {EQUATION_VECTOR[ \t]*?\([ \t]*?\"(\w+)\"[ \t]*?\)} $text ]
+		foreach { eq var } $eqs {
+			lappend vars $var
+		}
+
 		# get parameter names
 		foreach cmd $cmdp_1_1 {
 			set calls [ regexp -all -inline -- [ subst -nocommands -nobackslashes {$cmd[ \t]*?\([ \t]*?\"(\w+)\"[ \t]*?\)} ] $text ]
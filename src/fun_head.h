@@ -42,6 +42,7 @@ bool fast_lookup = true;
 const bool no_pointer_check = false;
 
 #define CHK_PTR_NOP( O ) if ( chk_ptr( O ) ) bad_ptr_void( O, __FILE__, __LINE__ );
+#define CHK_PTR_ARR( O ) chk_ptr( O ) ? bad_ptr_arr( O, __FILE__, __LINE__ ) :
 #define CHK_PTR_CHR( O ) chk_ptr( O ) ? bad_ptr_chr( O, __FILE__, __LINE__ ) :
 #define CHK_PTR_DBL( O ) chk_ptr( O ) ? bad_ptr_dbl( O, __FILE__, __LINE__ ) :
 #define CHK_PTR_LNK( O ) chk_ptr( O ) ? bad_ptr_lnk( O, __FILE__, __LINE__ ) :
@@ -56,6 +57,7 @@ const bool no_pointer_check = false;
 const bool no_pointer_check = true;
 
 #define CHK_PTR_NOP( O )
+#define CHK_PTR_ARR( O )
 #define CHK_PTR_CHR( O )
 #define CHK_PTR_DBL( O )
 #define CHK_PTR_LNK( O )
@@ -205,6 +207,17 @@ const bool no_pointer_init = true;
 		goto end; \
 	}
 
+#define EQUATION_VECTOR( X ) \
+	if ( ! strcmp( label, X ) ) { \
+		res = fun_vec( caller, [ ]( eq_vec &vec ) \
+			{ \
+				int i;
+
+#define RESULT_VECTOR \
+			} ); \
+		goto end; \
+	}
+
 #else
 // use fast map method for equation look-up
 #define MODELBEGIN \
@@ -217,13 +230,13 @@ const bool no_pointer_init = true;
 		{ \
 			auto eq_it = eq_map.find( label ); \
 			if ( eq_it != eq_map.end( ) ) \
-				eq_func = eq_it->second; \
+				eq_func = &eq_it->second; \
 			else \
 			{ \
 				EQ_NOT_FOUND \
 			} \
 		} \
-		res = ( eq_func )( caller, this ); \
+		res = ( *eq_func )( caller, this ); \
 		EQ_TEST_RESULT \
 		return res; \
 	} \
@@ -268,6 +281,18 @@ const bool no_pointer_init = true;
 		} \
 	},
 
+#define EQUATION_VECTOR( X ) \
+	{ string( X ), [ ]( object *caller, variable *var ) \
+		{ \
+			return var->fun_vec( caller, [ ]( eq_vec &vec ) \
+				{ \
+					int i;
+
+#define RESULT_VECTOR \
+				} ); \
+		} \
+	},
+
 #endif
 
 // redefine as macro to avoid conflicts with C++ version in <cmath.h>
@@ -294,6 +319,8 @@ const bool no_pointer_init = true;
 #define USE_SAVED { no_saved = false; }
 #define NO_SEARCH { no_search = true; }
 #define USE_SEARCH { no_search = false; }
+#define NO_COMPACT { compact_steps = 0; }
+#define USE_COMPACT( N, FRAG ) { compact_steps = N; compact_frag = FRAG; }
 #define NO_ZERO_INSTANCE { no_zero_instance = true; }
 #define USE_ZERO_INSTANCE { no_zero_instance = false; }
 #define PARAMETER { var->param = 1; }
@@ -331,6 +358,41 @@ const bool no_pointer_init = true;
 #define VS( O, X ) ( CHK_PTR_DBL( O ) O->cal( O, ( char * ) X, 0 ) )
 #define VLS( O, X, Y ) ( CHK_PTR_DBL( O ) O->cal( O, ( char * ) X, Y ) )
 
+#define VEC_N ( vec.n )
+#define VEC_OBJ( I ) ( vec.obj[ I ] )
+#define VEC_OUT ( vec.res )
+#define VEC_IN( X ) ( vec.in( ( char * ) X, 0 ) )
+#define VEC_INL( X, Y ) ( vec.in( ( char * ) X, Y ) )
+
+#define ARR( X ) ( p->cal_arr( p, ( char * ) X, 0 ) )
+#define ARRL( X, Y ) ( p->cal_arr( p, ( char * ) X, Y ) )
+#define ARRS( O, X ) ( CHK_PTR_ARR( O ) O->cal_arr( O, ( char * ) X, 0 ) )
+#define ARRLS( O, X, Y ) ( CHK_PTR_ARR( O ) O->cal_arr( O, ( char * ) X, Y ) )
+#define ARR_OUT ( var->arr_out( ) )
+#define ARR_COLS( X ) ( p->arr_dim( ( char * ) X, true ) )
+#define ARR_COLSS( O, X ) ( CHK_PTR_DBL( O ) O->arr_dim( ( char * ) X, true ) )
+#define ARR_ROWS( X ) ( p->arr_dim( ( char * ) X ) )
+#define ARR_ROWSS( O, X ) ( CHK_PTR_DBL( O ) O->arr_dim( ( char * ) X ) )
+#define RESIZE_ARR( X, R, C ) ( p->set_dim( ( char * ) X, R, C ) )
+#define RESIZE_ARRS( O, X, R, C ) ( CHK_PTR_DBL( O ) O->set_dim( ( char * ) X, R, C ) )
+
+#if defined( EIGENLIB ) && __cplusplus >= 201103L
+// Eigen matrix views (no copy) of array elements and equation output
+Map< MatrixXd > arr_mat( object *o, const char *lab, int lag )
+{
+	int rows, cols;
+	double *a = ( o == NULL ) ? NULL : o->cal_arr( o, lab, lag, &rows, &cols );
+
+	return Map< MatrixXd >( a, a == NULL ? 0 : rows, a == NULL ? 0 : cols );
+}
+
+#define ARR_MAT( X ) ( arr_mat( p, ( char * ) X, 0 ) )
+#define ARR_MATL( X, Y ) ( arr_mat( p, ( char * ) X, Y ) )
+#define ARR_MATS( O, X ) ( arr_mat( CHK_PTR_OBJ( O ) O, ( char * ) X, 0 ) )
+#define ARR_MATLS( O, X, Y ) ( arr_mat( CHK_PTR_OBJ( O ) O, ( char * ) X, Y ) )
+#define ARR_MAT_OUT ( Map< MatrixXd >( var->arr_out( ), var->rows, var->cols ) )
+#endif
+
 #define SUM( X ) ( p->sum( ( char * ) X, 0, false, "", "", 0. ) )
 #define SUML( X, L ) ( p->sum( ( char * ) X, L, false, "", "", 0. ) )
 #define SUMS( O, X ) ( CHK_PTR_DBL( O ) O->sum( ( char * ) X, 0, false, "", "", 0. ) )
@@ -591,6 +653,9 @@ const bool no_pointer_init = true;
 #define TSEARCH_CND( X, Y ) ( p->turbosearch_cond( ( char * ) X, Y ) )
 #define TSEARCH_CNDS( O, X, Y ) ( CHK_PTR_OBJ( O ) O->turbosearch_cond( ( char * ) X, Y ) )
 
+#define INIT_COLUMNS( X ) ( p->initcolumns( ( char * ) X ) )
+#define INIT_COLUMNSS( O, X ) ( CHK_PTR_DBL( O ) O->initcolumns( ( char * ) X ) )
+
 #define V_CHEAT( X, Y ) ( p->cal( Y, ( char * ) X, 0 ) )
 #define V_CHEATL( X, L, Y ) ( p->cal( Y, ( char * ) X, L ) )
 #define V_CHEATS( O, X, Y ) ( CHK_PTR_DBL( O ) O->cal( Y, ( char * ) X, 0 ) )
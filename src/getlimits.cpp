@@ -65,6 +65,7 @@ char name_rep[ MAX_PATH_LENGTH ] = "";	// documentation report file name
 char nonavail[ ] = "NA";	// string for unavailable values (use R default)
 const bool no_pointer_check = false;// user pointer checking static disable
 int actual_steps = 0;		// number of executed time steps
+int bin_values = false;		// save large initial values to binary file (bool)
 int debug_flag = false;		// debug enable control (bool)
 int fast_mode = 1;			// flag to hide LOG messages & runtime plot
 int findex = 1;				// current multi configuration job
@@ -81,6 +82,7 @@ int series_saved = 0;		// number of series saved
 int sim_num = 1;			// simulation number running
 int stack;					// LSD stack call level
 int stack_info = 0;			// LSD stack control
+int stream_done = -1;		// last time step streamed to results file
 int when_debug;				// next debug stop time step (0 for none)
 int wr_warn_cnt;			// invalid write operations warning counter
 long nodesSerial = 1;		// network node's serial number global counter
@@ -91,9 +93,11 @@ object *blueprint = NULL;	// LSD blueprint (effective model in use)
 object *root = NULL;		// LSD root object
 object *wait_delete = NULL;	// LSD object waiting for deletion
 o_setT obj_list;			// set with all existing LSD objects
+save_map *spill_map = NULL;	// saved series spill file, if any
 sense *rsense = NULL;		// LSD sensitivity analysis structure
-variable *cemetery = NULL;	// LSD saved data series (from last simulation run)
-variable *last_cemetery = NULL;	// LSD last saved data from deleted objects
+FILE *stream_file = NULL;	// streamed results spool file, if any
+graveyard cemetery;			// LSD saved data series (from last simulation run)
+snapshot init_state;		// initial configuration state for next runs
 
 // constant string arrays
 const char *signal_names[ REG_SIG_NUM ] = REG_SIG_NAME;
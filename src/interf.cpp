@@ -1128,7 +1128,7 @@ object *operate( object *r )
 	char observe, initial, *lab0;
 	const char *lab1, *lab2, *lab3, *lab4;
 	char lab[ MAX_BUFF_SIZE ], lab_old[ 2 * MAX_PATH_LENGTH ], ch[ 2 * MAX_LINE_SIZE ], ch1[ MAX_ELEM_LENGTH ], NOLHfile[ MAX_PATH_LENGTH ], out_file[ MAX_PATH_LENGTH ], out_dir[ MAX_PATH_LENGTH ], nw_exe[ MAX_PATH_LENGTH ], out_bat[ MAX_PATH_LENGTH ], win_dir[ MAX_PATH_LENGTH ], buf_descr[ MAX_BUFF_SIZE ];
-	int i, j, k, sl, num, param, save, plot, nature, numlag, lag, fSeq, ffirst, fnext, sizMC, varSA, temp[ 11 ], done = 0;
+	int i, j, k, sl, num, param, save, plot, nature, numlag, lag, fSeq, ffirst, fnext, sizMC, varSA, temp[ 12 ], done = 0;
 	long nLinks, ptsSa, maxMC;
 	double fracMC, fake = 0;
 	FILE *f;
@@ -1959,7 +1959,7 @@ object *operate( object *r )
 	case 7:
 
 		redrawRoot = redrawStruc = true;	// force browser/structure redraw
-		int savei, parallel;
+		int savei, parallel, savef, savez, saveevery, savefrom, saveto, savelast;
 
 		cmd( "if { ! [ catch { set vname [ .l.v.c.var_name get [ .l.v.c.var_name curselection ] ] } ] && ! [ string equal $vname \"\" ] } { set choice 1 } { set choice 0 }" );
 		if ( choice == 0 )
@@ -1982,12 +1982,24 @@ object *operate( object *r )
 		Tcl_LinkVar( inter, "savei", ( char * ) &savei, TCL_LINK_BOOLEAN );
 		Tcl_LinkVar( inter, "plot", ( char * ) &plot, TCL_LINK_BOOLEAN );
 		Tcl_LinkVar( inter, "parallel", ( char * ) &parallel, TCL_LINK_BOOLEAN );
+		Tcl_LinkVar( inter, "savef", ( char * ) &savef, TCL_LINK_BOOLEAN );
+		Tcl_LinkVar( inter, "savez", ( char * ) &savez, TCL_LINK_BOOLEAN );
+		Tcl_LinkVar( inter, "saveevery", ( char * ) &saveevery, TCL_LINK_INT );
+		Tcl_LinkVar( inter, "savefrom", ( char * ) &savefrom, TCL_LINK_INT );
+		Tcl_LinkVar( inter, "saveto", ( char * ) &saveto, TCL_LINK_INT );
+		Tcl_LinkVar( inter, "savelast", ( char * ) &savelast, TCL_LINK_INT );
 
 		save = cv->save;
 		num = ( cv->debug == 'd' ) ? 1 : 0;
 		plot = cv->plot;
 		savei = cv->savei;
 		parallel = cv->parallel;
+		savef = ( cv->save_fmt & SAVE_FLT ) ? 1 : 0;
+		savez = ( cv->save_fmt & SAVE_ZIP ) ? 1 : 0;
+		saveevery = cv->save_every;
+		savefrom = cv->save_from;
+		saveto = cv->save_to;
+		savelast = cv->save_last;
 
 		cmd( "set observe %d", cd->observe == 'y' ? 1 : 0 );
 		cmd( "set initial %d", cd->initial == 'y' ? 1 : 0 );
@@ -2121,11 +2133,39 @@ object *operate( object *r )
 		cmd( "ttk::frame $T.b1" );
 
 		cmd( "ttk::frame $T.b1.sav" );
-		cmd( "ttk::checkbutton $T.b1.sav.n -text \"Save: save the series for analysis	   \" -variable save -underline 0 -command { if $save { .chgelem.b1.sav.i configure -state normal } { set savei 0; .chgelem.b1.sav.i configure -state disabled } }" );
+		cmd( "ttk::checkbutton $T.b1.sav.n -text \"Save: save the series for analysis	   \" -variable save -underline 0 -command { if $save { set s normal } { set savei 0; set s disabled }; foreach w { sav.i sto.f sto.z pol.e pol.f pol.t pol.k } { .chgelem.b1.$w configure -state $s } }" );
 		cmd( "ttk::checkbutton $T.b1.sav.i -text \"Save in separate files\" -variable savei -underline 17" );
-		cmd( "if { ! $save } { set savei 0; .chgelem.b1.sav.i configure -state disabled }" );
 		cmd( "pack $T.b1.sav.n $T.b1.sav.i -side left -anchor w" );
 
+		cmd( "ttk::frame $T.b1.sto" );
+		cmd( "ttk::label $T.b1.sto.l -text \"      Saved data storage:\"" );
+		cmd( "ttk::checkbutton $T.b1.sto.f -text \"Single precision\" -variable savef" );
+		cmd( "ttk::checkbutton $T.b1.sto.z -text \"Compressed\" -variable savez" );
+		cmd( "pack $T.b1.sto.l $T.b1.sto.f $T.b1.sto.z -side left -anchor w" );
+		cmd( "tooltip::tooltip $T.b1.sto.f \"Save the series values with about 7 significant digits, using half the memory\"" );
+		cmd( "tooltip::tooltip $T.b1.sto.z \"Compress the series values in memory (for slowly changing series)\"" );
+
+		cmd( "ttk::frame $T.b1.pol" );
+		cmd( "ttk::label $T.b1.pol.l1 -text \"      Save every\"" );
+		cmd( "ttk::spinbox $T.b1.pol.e -width 5 -from 1 -to 99999 -validate focusout -validatecommand { set n %%P; if { [ string is integer -strict $n ] && $n >= 1 } { set saveevery %%P; return 1 } { %%W delete 0 end; %%W insert 0 $saveevery; return 0 } } -invalidcommand { bell } -justify center" );
+		cmd( "ttk::label $T.b1.pol.l2 -text \"steps, from\"" );
+		cmd( "ttk::spinbox $T.b1.pol.f -width 5 -from 0 -to 99999 -validate focusout -validatecommand { set n %%P; if { [ string is integer -strict $n ] && $n >= 0 } { set savefrom %%P; return 1 } { %%W delete 0 end; %%W insert 0 $savefrom; return 0 } } -invalidcommand { bell } -justify center" );
+		cmd( "ttk::label $T.b1.pol.l3 -text \"to\"" );
+		cmd( "ttk::spinbox $T.b1.pol.t -width 5 -from 0 -to 99999 -validate focusout -validatecommand { set n %%P; if { [ string is integer -strict $n ] && $n >= 0 } { set saveto %%P; return 1 } { %%W delete 0 end; %%W insert 0 $saveto; return 0 } } -invalidcommand { bell } -justify center" );
+		cmd( "ttk::label $T.b1.pol.l4 -text \"keeping last\"" );
+		cmd( "ttk::spinbox $T.b1.pol.k -width 5 -from 0 -to 99999 -validate focusout -validatecommand { set n %%P; if { [ string is integer -strict $n ] && $n >= 0 } { set savelast %%P; return 1 } { %%W delete 0 end; %%W insert 0 $savelast; return 0 } } -invalidcommand { bell } -justify center" );
+		cmd( "$T.b1.pol.e insert 0 $saveevery" );
+		cmd( "$T.b1.pol.f insert 0 $savefrom" );
+		cmd( "$T.b1.pol.t insert 0 $saveto" );
+		cmd( "$T.b1.pol.k insert 0 $savelast" );
+		cmd( "pack $T.b1.pol.l1 $T.b1.pol.e $T.b1.pol.l2 $T.b1.pol.f $T.b1.pol.l3 $T.b1.pol.t $T.b1.pol.l4 $T.b1.pol.k -side left -anchor w -padx 2" );
+		cmd( "tooltip::tooltip $T.b1.pol.e \"Save the series only every this number of cases (time steps)\"" );
+		cmd( "tooltip::tooltip $T.b1.pol.f \"First case (time step) to save (0=first)\"" );
+		cmd( "tooltip::tooltip $T.b1.pol.t \"Last case (time step) to save (0=last)\"" );
+		cmd( "tooltip::tooltip $T.b1.pol.k \"Keep only this number of the last saved values (0=all)\"" );
+
+		cmd( "if { ! $save } { set savei 0; foreach w { sav.i sto.f sto.z pol.e pol.f pol.t pol.k } { .chgelem.b1.$w configure -state disabled } }" );
+
 		cmd( "ttk::checkbutton $T.b1.plt -text \"Run-time plot: observe the series during the simulation execution\" -variable plot -underline 9" );
 		cmd( "ttk::checkbutton $T.b1.deb -text \"Debug: allow interruption after this equation/function\" -variable debug -underline 0" );
 		cmd( "ttk::checkbutton $T.b1.par -text \"Parallel: allow multi-object parallel updating for this equation\" -variable parallel -underline 0" );
@@ -2133,14 +2173,14 @@ object *operate( object *r )
 		switch ( cv->param )
 		{
 			case 1:
-				cmd( "pack $T.b1.sav $T.b1.plt -anchor w" );
+				cmd( "pack $T.b1.sav $T.b1.sto $T.b1.pol $T.b1.plt -anchor w" );
 				break;
 			case 2:
-				cmd( "pack $T.b1.sav $T.b1.plt $T.b1.deb -anchor w" );
+				cmd( "pack $T.b1.sav $T.b1.sto $T.b1.pol $T.b1.plt $T.b1.deb -anchor w" );
 				cmd( "bind $T <Control-d> \"$T.b1.deb invoke\"; bind $T <Control-D> \"$T.b1.deb invoke\"" );
 				break;
 			case 0:
-				cmd( "pack $T.b1.sav $T.b1.plt $T.b1.deb $T.b1.par -anchor w" );
+				cmd( "pack $T.b1.sav $T.b1.sto $T.b1.pol $T.b1.plt $T.b1.deb $T.b1.par -anchor w" );
 				cmd( "bind $T <Control-d> \"$T.b1.deb invoke\"; bind $T <Control-D> \"$T.b1.deb invoke\"" );
 				cmd( "bind $T <Control-p> \"$T.b1.par invoke\"; bind $T <Control-P> \"$T.b1.par invoke\"" );
 		}
@@ -2286,6 +2326,10 @@ object *operate( object *r )
 		}
 		else
 		{
+			cmd( "set saveevery [ .chgelem.b1.pol.e get ]" );
+			cmd( "set savefrom [ .chgelem.b1.pol.f get ]" );
+			cmd( "set saveto [ .chgelem.b1.pol.t get ]" );
+			cmd( "set savelast [ .chgelem.b1.pol.k get ]" );
 			cmd( "set choice $observe" );
 			choice == 1 ? observe = 'y' : observe = 'n';
 			cmd( "set choice $initial" );
@@ -2298,6 +2342,11 @@ object *operate( object *r )
 			   cv = cur->search_var( NULL, lab_old );
 			   cv->save = save;
 			   cv->savei = savei;
+			   cv->save_fmt = ( savef ? SAVE_FLT : 0 ) | ( savez ? SAVE_ZIP : 0 );
+			   cv->save_every = max( saveevery, 1 );
+			   cv->save_from = max( savefrom, 0 );
+			   cv->save_to = max( saveto, 0 );
+			   cv->save_last = max( savelast, 0 );
 			   cv->debug = ( num == 1 ) ? 'd' : 'n';
 			   cv->plot = plot;
 			   cv->parallel = parallel;
@@ -2331,6 +2380,12 @@ object *operate( object *r )
 		Tcl_UnlinkVar( inter, "debug" );
 		Tcl_UnlinkVar( inter, "plot" );
 		Tcl_UnlinkVar( inter, "parallel" );
+		Tcl_UnlinkVar( inter, "savef" );
+		Tcl_UnlinkVar( inter, "savez" );
+		Tcl_UnlinkVar( inter, "saveevery" );
+		Tcl_UnlinkVar( inter, "savefrom" );
+		Tcl_UnlinkVar( inter, "saveto" );
+		Tcl_UnlinkVar( inter, "savelast" );
 		cmd( "unset done" );
 
 		// options to be handled in a second run of the operate function
@@ -2489,6 +2544,10 @@ object *operate( object *r )
 							cv->val[ i ] = old_val[ i ];
 
 				delete [ ] old_val;
+
+				if ( cv->arr != NULL )		// keep array lags consistent
+					cv->set_dim( cv->rows, cv->cols, numlag );
+
 				cv->num_lag = numlag;
 				cv->param = nature;
 
@@ -2994,7 +3053,7 @@ object *operate( object *r )
 		cmd( "set firstFile \"%s_%d\"", simul_name, seed );
 		cmd( "set lastFile \"%s_%d\"", simul_name, seed + sim_num - 1 );
 		cmd( "set totFile \"%s\"", simul_name );
-		cmd( "set resExt %s", docsv ? "csv" : "res" );
+		cmd( "set resExt %s", dobin ? RES_BIN_EXT : docsv ? "csv" : "res" );
 		cmd( "set totExt %s", docsv ? "csv" : "tot" );
 		cmd( "set zipExt \"%s\"", dozip ? ".gz" : "" );
 		cmd( "set tot_msg_warn \"(totals file already exists)\"" );
@@ -3379,6 +3438,7 @@ object *operate( object *r )
 		temp[ 8 ] = prof_aggr_time;
 		temp[ 9 ] = no_ptr_chk;
 		temp[ 10 ] = parallel_disable;
+		temp[ 11 ] = bin_values;
 
 		Tcl_LinkVar( inter, "sim_num", ( char * ) & sim_num, TCL_LINK_INT );
 		Tcl_LinkVar( inter, "seed", ( char * ) & seed, TCL_LINK_INT );
@@ -3389,6 +3449,7 @@ object *operate( object *r )
 		Tcl_LinkVar( inter, "prof_aggr_time", ( char * ) & prof_aggr_time, TCL_LINK_BOOLEAN );
 		Tcl_LinkVar( inter, "no_ptr_chk", ( char * ) & no_ptr_chk, TCL_LINK_BOOLEAN );
 		Tcl_LinkVar( inter, "parallel_disable", ( char * ) & parallel_disable, TCL_LINK_BOOLEAN );
+		Tcl_LinkVar( inter, "bin_values", ( char * ) & bin_values, TCL_LINK_BOOLEAN );
 
 		cmd( "set tw 28" );					// text label width
 
@@ -3440,14 +3501,15 @@ object *operate( object *r )
 		cmd( "ttk::checkbutton $T.c.obs -text \"Profile observed variables only\" -variable prof_obs_only" );
 		cmd( "ttk::checkbutton $T.c.aggr -text \"Show aggregated profiling times\" -variable prof_aggr_time" );
 		cmd( "ttk::checkbutton $T.c.nchk -text \"Disable pointer checks\" -variable no_ptr_chk -state %s", no_pointer_check ? "disabled" : "normal" );
+		cmd( "ttk::checkbutton $T.c.bin -text \"Save large initial values in binary file\" -variable bin_values" );
 
 #ifndef _NP_
 		cmd( "ttk::checkbutton $T.c.npar -text \"Disable parallel computation\" -variable parallel_disable" );
 		if ( ! search_parallel( root ) || max_threads < 2 )
 			cmd( "$T.c.npar configure -state disabled" );
-		cmd( "pack $T.c.obs $T.c.aggr $T.c.nchk $T.c.npar -anchor w" );
+		cmd( "pack $T.c.obs $T.c.aggr $T.c.nchk $T.c.npar $T.c.bin -anchor w" );
 #else
-		cmd( "pack $T.c.obs $T.c.aggr $T.c.nchk -anchor w" );
+		cmd( "pack $T.c.obs $T.c.aggr $T.c.nchk $T.c.bin -anchor w" );
 #endif
 
 		cmd( "pack $T.f $T.c -padx 5 -pady 5" );
@@ -3490,10 +3552,11 @@ object *operate( object *r )
 			prof_aggr_time = temp[ 8 ];
 			no_ptr_chk = temp[ 9 ];
 			parallel_disable = temp[ 10 ];
+			bin_values = temp[ 11 ];
 		}
 		else
 			// signal unsaved change if anything to be saved
-			if ( temp[ 1 ] != sim_num || ( unsigned ) temp[ 2 ] != seed || temp[ 3 ] != max_step || temp[ 4 ] != when_debug || temp[ 5 ] != stack_info || temp[ 6 ] != prof_min_msecs || temp[ 7 ] != prof_obs_only || temp[ 8 ] != prof_aggr_time || temp[ 9 ] != no_ptr_chk || temp[ 10 ] != parallel_disable )
+			if ( temp[ 1 ] != sim_num || ( unsigned ) temp[ 2 ] != seed || temp[ 3 ] != max_step || temp[ 4 ] != when_debug || temp[ 5 ] != stack_info || temp[ 6 ] != prof_min_msecs || temp[ 7 ] != prof_obs_only || temp[ 8 ] != prof_aggr_time || temp[ 9 ] != no_ptr_chk || temp[ 10 ] != parallel_disable || temp[ 11 ] != bin_values )
 				unsaved_change( true );
 
 		Tcl_UnlinkVar( inter, "sim_num" );
@@ -3505,6 +3568,7 @@ object *operate( object *r )
 		Tcl_UnlinkVar( inter, "prof_aggr_time" );
 		Tcl_UnlinkVar( inter, "no_ptr_chk" );
 		Tcl_UnlinkVar( inter, "parallel_disable" );
+		Tcl_UnlinkVar( inter, "bin_values" );
 
 	break;
 
@@ -3956,6 +4020,7 @@ object *operate( object *r )
 			break;
 		}
 
+		Tcl_LinkVar( inter, "dobin", ( char * ) & dobin, TCL_LINK_BOOLEAN );
 		Tcl_LinkVar( inter, "docsv", ( char * ) & docsv, TCL_LINK_BOOLEAN );
 		Tcl_LinkVar( inter, "dozip", ( char * ) & dozip, TCL_LINK_BOOLEAN );
 		Tcl_LinkVar( inter, "saveConf", ( char * ) & saveConf, TCL_LINK_BOOLEAN );
@@ -3979,9 +4044,10 @@ object *operate( object *r )
 
 		cmd( "ttk::frame .n.do" );
 		cmd( "ttk::checkbutton .n.do.zip -text \"Generate zipped results file\" -variable dozip" );
-		cmd( "ttk::checkbutton .n.do.csv -text \"Comma-separated text format (.csv)\" -variable docsv" );
+		cmd( "ttk::checkbutton .n.do.csv -text \"Comma-separated text format (.csv)\" -variable docsv -command { if $docsv { set dobin 0 } }" );
+		cmd( "ttk::checkbutton .n.do.bin -text \"Binary columnar format (.%s)\" -variable dobin -command { if $dobin { set docsv 0 } }", RES_BIN_EXT );
 		cmd( "ttk::checkbutton .n.do.conf -text \"Save associated configuration\" -variable saveConf" );
-		cmd( "pack .n.do.zip .n.do.csv .n.do.conf -anchor w" );
+		cmd( "pack .n.do.zip .n.do.csv .n.do.bin .n.do.conf -anchor w" );
 
 		cmd( "pack .n.n .n.do -padx 5 -pady 5" );
 
@@ -4000,6 +4066,7 @@ object *operate( object *r )
 
 		cmd( "destroytop .n" );
 
+		Tcl_UnlinkVar( inter, "dobin" );
 		Tcl_UnlinkVar( inter, "docsv" );
 		Tcl_UnlinkVar( inter, "dozip" );
 		Tcl_UnlinkVar( inter, "saveConf" );
@@ -4026,16 +4093,16 @@ object *operate( object *r )
 		}
 
 		if ( strlen( path ) == 0 )
-			snprintf( out_file, MAX_PATH_LENGTH, "%s.%s", ch1, docsv ? "csv" : "res" );
+			snprintf( out_file, MAX_PATH_LENGTH, "%s.%s", ch1, dobin ? RES_BIN_EXT : docsv ? "csv" : "res" );
 		else
-			snprintf( out_file, MAX_PATH_LENGTH, "%s/%s.%s", path, ch1, docsv ? "csv" : "res" );
+			snprintf( out_file, MAX_PATH_LENGTH, "%s/%s.%s", path, ch1, dobin ? RES_BIN_EXT : docsv ? "csv" : "res" );
 
-		if ( dozip )
+		if ( dozip && ! dobin )
 			strcatn( out_file, ".gz", MAX_PATH_LENGTH );
 
 		plog( "\nSaving results to file %s... ", out_file );
 
-		rf = new result( out_file, "wt", dozip, docsv );// create results file object
+		rf = new result( out_file, "wt", dozip, docsv, dobin );// create results file object
 		rf->title( root, 1 );						// write header
 		rf->data( root, 0, actual_steps );			// write all data
 		delete rf;									// close file and delete object
@@ -5954,7 +6021,7 @@ object *operate( object *r )
 		cmd( "set firstFile \"%s_%d\"", simul_name, seed );
 		cmd( "set lastFile \"%s_%d\"", simul_name, seed + sim_num - 1 );
 		cmd( "set totFile \"%s\"", simul_name );
-		cmd( "set resExt %s", docsv ? "csv" : "res" );
+		cmd( "set resExt %s", dobin ? RES_BIN_EXT : docsv ? "csv" : "res" );
 		cmd( "set totExt %s", docsv ? "csv" : "tot" );
 		cmd( "set zipExt %s", dozip ? ".gz" : "" );
 		cmd( "set cores %d", param );
@@ -43,26 +43,35 @@ bool ignore_eq_file = true;	// flag to ignore equation file in configuration fil
 char err_file[ ] = "LSD.err";// error log file name
 char nonavail[ ] = "NA";	// string for unavailable values (use R default)
 char tabs[ ] = "5c 7.5c 10c 12.5c 15c 17.5c 20c";	// Log window tabs
+double compact_frag = 0;	// fragmentation share to trigger compaction
 double def_res = 0;			// default equation result
 int add_to_tot = false;		// flag to append results to existing totals file (bool)
+int ckpt_steps = 0;			// time steps between run checkpoints (0=none)
+int compact_steps = 0;		// time steps between compaction checks (0=none)
 int dobar = false;			// output a progress bar to the log/standard output
+int dobin = false;			// produce binary columnar .lrb results files (bool)
 int docsv = false;			// produce .csv text results files (bool)
 int doover = false;			// overwrite results folder (bool)
 int dozip = true;			// compressed results file flag (bool)
 int max_step = 100;			// default number of simulation runs
 int overwConf = true;		// overwrite configuration on run flag (bool)
 int saveConf = false;		// save configuration on results saving (bool)
+int stream_steps = 0;		// time steps per streamed results block (0=none)
 int strWindowOn = true;		// control the presentation of the model structure window (bool)
+int warm_steps = 0;			// burn-in time steps shared by all runs (0=none)
 unsigned seed = 1;			// random number generator initial seed
 
 bool batch_sequential = false;// no-window multi configuration job running
 bool brCovered = false;		// browser cover currently covered
+bool ckpt_resume = false;	// resume the runs from the checkpoint file, if any
 bool eq_dum = false;		// current equation is dummy
 bool error_hard_thread;		// flag to error_hard() called in worker thread
 bool fast;					// safe copy of fast_mode flag
+bool fork_runs = false;		// fork parallel runs from the loaded configuration
 bool grandTotal;			// flag to produce grand total in batch processing
 bool idle_loop = false;		// indicates in main idle loop (no running operation)
 bool log_ok = false;		// control for log window available
+bool mc_aggr = false;		// save the cross-run Monte Carlo statistics
 bool message_logged = false;// new message posted in log window
 bool meta_par_in[ META_PAR_NUM ];// flag meta parameter for simulation settings found
 bool no_more_memory = false;// memory overflow when setting data save structure
@@ -94,10 +103,13 @@ char *eq_file = NULL;		// equation file content
 char *exec_file = NULL;		// name of executable file
 char *exec_path = NULL;		// path of executable file
 char *log_filename = NULL;	// name of log file, if any
+char *mc_part = NULL;		// partial Monte Carlo statistics file, if any
 char *rootLsd = NULL;		// path of LSD root directory
 char *path = NULL;			// path of current configuration
 char *sens_file = NULL;		// current sensitivity analysis file
 char *simul_name = NULL;	// name of current simulation configuration
+char *spill_dir = NULL;		// directory for saved series spill files, if any
+run_prg *prg_cur = NULL;	// current run progress in shared memory, if any
 char *struct_file = NULL;	// name of current configuration file
 char equation_name[ MAX_PATH_LENGTH ] = "";// equation file name
 char error_hard_msg1[ MAX_BUFF_SIZE ];	// buffer for parallel worker title msg
@@ -110,7 +122,9 @@ char path_sens[ MAX_PATH_LENGTH ] = "";	// path of last used sensitivity directo
 char tcl_dir[ MAX_PATH_LENGTH ] = "";	// Tcl/Tk directory
 description *descr = NULL;	// model description structure
 eq_mapT eq_map;				// fast equation look-up map
+graveyard cemetery;			// LSD saved data from deleted objects
 int actual_steps = 0;		// number of executed time steps
+int bin_values = false;		// save large initial values to binary file (bool)
 int choice;					// Tcl menu control variable (main window)
 int choice_g;				// Tcl menu control variable (structure window)
 int cur_plt;				// current graph plot number
@@ -140,22 +154,25 @@ int sim_num = 1;			// simulation number running
 int stack;					// LSD stack call level
 int stack_info = 0;			// LSD stack control
 int stop;					// activity interruption flag (Tcl boolean)
+int stream_done = -1;		// last time step streamed to results file
 int t;						// current time step
 int when_debug;				// next debug stop time step (0 for none)
 int wr_warn_cnt;			// invalid write operations warning counter
 long nodesSerial = 1;		// network node's serial number global counter
 lsdstack *stacklog = NULL;	// LSD stack
 map < string, profile > prof;// set of saved profiling times
+mc_stats *mc_data = NULL;	// cross-run Monte Carlo statistics, if any
 object *blueprint = NULL;	// LSD blueprint (effective model in use)
 object *currObj = NULL;		// pointer to current object in browser
 object *root = NULL;		// LSD root object
 object *wait_delete = NULL;	// LSD object waiting for deletion
 o_setT obj_list;			// set with all existing LSD objects
+save_map *spill_map = NULL;	// saved series spill file, if any
 sense *rsense = NULL;		// LSD sensitivity analysis structure
-variable *cemetery = NULL;	// LSD saved data from deleted objects
-variable *last_cemetery = NULL;// LSD last saved data from deleted objects
+snapshot init_state;		// initial configuration state for next runs
 vector < string > res_list;	// list of results files last saved
 FILE *log_file = NULL;		// log file, if any
+FILE *stream_file = NULL;	// streamed results spool file, if any
 
 // constant arrays
 const char *lmm_options[ LMM_OPTIONS_NUM ] = LMM_OPTIONS_NAME;
@@ -174,11 +191,14 @@ mutex lock_obj_list;		// lock for object list for parallel manipulation
 mutex lock_run_logs;		// lock run_logs for parallel updating
 mutex lock_run_pids;		// lock run_pids for parallel updating
 mutex lock_run_status;		// lock run_status for parallel updating
+atomic < int > run_next;	// next parallel run to be started
+prg_map *prg_mon = NULL;	// progress of the parallel runs in shared memory
 string run_log;				// consolidated runs log
 thread::id main_thread;		// LSD main thread ID
 thread run_monitor;			// thread monitoring parallel instances
 vector < handleT > run_pids;// parallel running instances process id's
 vector < int > run_status;	// parallel running instances status
+vector < string > run_cmds;	// parallel runs command lines
 vector < string > run_logs;	// list of log files produced in parallel runs
 vector < string > run_results;// parallel run results files
 vector < thread > run_threads;// parallel running instances
@@ -197,7 +217,7 @@ Tcl_Interp *inter = NULL;	// global Tcl interpreter in LSD
 #else
 // command line strings
 const char lsdCmdMsg[ ] = "This is the No Window version of LSD.";
-const char lsdCmdHlp[ ] = "Command line options:\n'-f FILENAME.lsd [-s SEED] [-e RUNS] to run a single configuration file\n'-f FILE_BASE_NAME -s FIRST_NUM [-e LAST_NUM]' for batch sequential mode\n'-o PATH' to save result file(s) to a different subdirectory\n'-l FILENAME' to save all output to a (log) file\n'-t' to produce comma separated (.csv) text result file(s)\n'-r' for skipping the generation of intermediate result file(s)\n'-p' for skipping the generation of totals file\n'-g' for the generation of a single grand total file\n'-z' for preventing the generation of compressed result file(s)\n'-b' for showing a progress bar\n'-c MAX_THREADS[:MAX_RUNS]' to set maximum parallel threads/runs to use\n";
+const char lsdCmdHlp[ ] = "Command line options:\n'-f FILENAME.lsd [-s SEED] [-e RUNS] to run a single configuration file\n'-f FILE_BASE_NAME -s FIRST_NUM [-e LAST_NUM]' for batch sequential mode\n'-o PATH' to save result file(s) to a different subdirectory\n'-l FILENAME' to save all output to a (log) file\n'-t' to produce comma separated (.csv) text result file(s)\n'-u' to produce binary columnar (.lrb) result file(s)\n'-r' for skipping the generation of intermediate result file(s)\n'-p' for skipping the generation of totals file\n'-g' for the generation of a single grand total file\n'-z' for preventing the generation of compressed result file(s)\n'-b' for showing a progress bar\n'-c MAX_THREADS[:MAX_RUNS]' to set maximum parallel threads/runs to use\n'-m STEPS[:FRAG]' to compact memory every STEPS if fragmentation is over FRAG%\n'-w STEPS' to write results while running, keeping only 2 x STEPS + 1 in memory\n'-d PATH' to keep saved series in memory-mapped temporary files in PATH\n'-k STEPS' to save a checkpoint of the run every STEPS (not with C++ object extensions)\n'-x' to resume the runs from the last checkpoint, if any\n'-i STEPS' to simulate the first STEPS once and start all runs from that state (sequential runs only, not with C++ object extensions)\n'-q' to fork parallel runs from the loaded configuration (not in Windows)\n'-j NAME:RUN' to report the run progress in the shared memory of parallel runs NAME\n'-a' to save the Monte Carlo statistics of the runs (mean, se, max, min .csv files)\n'-y FILENAME' to save the partial Monte Carlo statistics to a file (used by parallel runs)\n";
 #endif
 
 
@@ -235,7 +255,7 @@ int lsdmain( int argn, const char **argv )
 #ifdef _NW_
 
 	dozip = no_window = true;			// to preserve compatibility
-	dobar = doover = docsv = no_res = no_tot = grandTotal = false;
+	dobar = dobin = doover = docsv = no_res = no_tot = grandTotal = false;
 	findex = -1;						// no default
 	fend = 0;							// no file number limit
 
@@ -282,6 +302,54 @@ int lsdmain( int argn, const char **argv )
 				sscanf( argv[ i + 1 ], "%d:%d", &j, &k );
 				continue;
 			}
+			// read -m parameter : memory compaction period and threshold
+			if ( argv[ i ][ 0 ] == '-' && argv[ i ][ 1 ] == 'm' && 1 + i < argn && strlen( argv[ 1 + i ] ) > 0 )
+			{
+				sscanf( argv[ i + 1 ], "%d:%lf", & compact_steps, & compact_frag );
+				compact_frag /= 100;
+				continue;
+			}
+			// read -w parameter : stream results to file in blocks of time steps
+			if ( argv[ i ][ 0 ] == '-' && argv[ i ][ 1 ] == 'w' && 1 + i < argn && strlen( argv[ 1 + i ] ) > 0 )
+			{
+				sscanf( argv[ i + 1 ], "%d", & stream_steps );
+				continue;
+			}
+			// read -k parameter : save a run checkpoint every number of time steps
+			if ( argv[ i ][ 0 ] == '-' && argv[ i ][ 1 ] == 'k' && 1 + i < argn && strlen( argv[ 1 + i ] ) > 0 )
+			{
+				sscanf( argv[ i + 1 ], "%d", & ckpt_steps );
+				continue;
+			}
+			// read -i parameter : burn-in time steps shared by all runs
+			if ( argv[ i ][ 0 ] == '-' && argv[ i ][ 1 ] == 'i' && 1 + i < argn && strlen( argv[ 1 + i ] ) > 0 )
+			{
+				sscanf( argv[ i + 1 ], "%d", & warm_steps );
+				continue;
+			}
+			// read -j parameter : report run progress to the parallel runs monitor
+			if ( argv[ i ][ 0 ] == '-' && argv[ i ][ 1 ] == 'j' && 1 + i < argn && strlen( argv[ 1 + i ] ) > 0 )
+			{
+#ifndef _NP_
+				char prg_name[ MAX_ELEM_LENGTH ];
+				int prg_id;
+
+				if ( prg_mon == NULL && sscanf( argv[ i + 1 ], "%99[^:]:%d", prg_name, & prg_id ) == 2 && prg_id >= 0 )
+				{
+					prg_mon = new prg_map( prg_name, prg_id + 1, false );
+					prg_cur = prg_mon->run( prg_id );
+				}
+#endif
+				continue;
+			}
+			// read -d parameter : keep saved series in memory-mapped files in a directory
+			if ( argv[ i ][ 0 ] == '-' && argv[ i ][ 1 ] == 'd' && 1 + i < argn && strlen( argv[ 1 + i ] ) > 0 )
+			{
+				delete [ ] spill_dir;
+				spill_dir = new char[ strlen( argv[ 1 + i ] ) + 1 ];
+				strcpy( spill_dir, argv[ 1 + i ] );
+				continue;
+			}
 			// read -s parameter : first sequential file to process
 			if ( argv[ i ][ 0 ] == '-' && argv[ i ][ 1 ] == 's' && 1 + i < argn && strlen( argv[ 1 + i ] ) > 0 )
 			{
@@ -301,6 +369,13 @@ int lsdmain( int argn, const char **argv )
 				docsv = true;
 				continue;
 			}
+			// read -u parameter : produce binary columnar .lrb results files
+			if ( argv[ i ][ 0 ] == '-' && argv[ i ][ 1 ] == 'u' )
+			{
+				i--;					// no parameter for this option
+				dobin = true;
+				continue;
+			}
 			// read -r parameter : do not produce intermediate .res files
 			if ( argv[ i ][ 0 ] == '-' && argv[ i ][ 1 ] == 'r' )
 			{
@@ -337,6 +412,36 @@ int lsdmain( int argn, const char **argv )
 				dobar = true;
 				continue;
 			}
+			// read -a parameter : save cross-run Monte Carlo statistics
+			if ( argv[ i ][ 0 ] == '-' && argv[ i ][ 1 ] == 'a' )
+			{
+				i--;					// no parameter for this option
+				mc_aggr = true;
+				continue;
+			}
+			// read -y parameter : save partial Monte Carlo statistics to a file
+			if ( argv[ i ][ 0 ] == '-' && argv[ i ][ 1 ] == 'y' && 1 + i < argn && strlen( argv[ 1 + i ] ) > 0 )
+			{
+				delete [ ] mc_part;
+				mc_part = new char[ strlen( argv[ 1 + i ] ) + 1 ];
+				strcpy( mc_part, argv[ 1 + i ] );
+				mc_aggr = true;
+				continue;
+			}
+			// read -q parameter : fork parallel runs from the loaded configuration
+			if ( argv[ i ][ 0 ] == '-' && argv[ i ][ 1 ] == 'q' )
+			{
+				i--;					// no parameter for this option
+				fork_runs = true;
+				continue;
+			}
+			// read -x parameter : resume from checkpoint file
+			if ( argv[ i ][ 0 ] == '-' && argv[ i ][ 1 ] == 'x' )
+			{
+				i--;					// no parameter for this option
+				ckpt_resume = true;
+				continue;
+			}
 
 			fprintf( stderr, "\nOption '%c%c' not recognized.\n%s\n%s\n", argv[ i ][ 0 ], argv[ i ][ 1 ], lsdCmdMsg, lsdCmdHlp );
 			myexit( 6 );
@@ -353,6 +458,27 @@ int lsdmain( int argn, const char **argv )
 		myexit( 6 );
 	}
 
+	if ( ckpt_steps > 0 && stream_steps > 0 )
+	{
+		fprintf( stderr, "\nOptions '-k' and '-w' cannot be used together.\n%s\n%s\n", lsdCmdMsg, lsdCmdHlp );
+		myexit( 6 );
+	}
+
+	if ( warm_steps > 0 && ( ckpt_steps > 0 || ckpt_resume || stream_steps > 0 ) )
+	{
+		fprintf( stderr, "\nOption '-i' cannot be used together with '-k', '-x' or '-w'.\n%s\n%s\n", lsdCmdMsg, lsdCmdHlp );
+		myexit( 6 );
+	}
+
+	if ( mc_aggr && ( ckpt_resume || stream_steps > 0 ) )
+	{
+		fprintf( stderr, "\nOption '-a' cannot be used together with '-x' or '-w'.\n%s\n%s\n", lsdCmdMsg, lsdCmdHlp );
+		myexit( 6 );
+	}
+
+	if ( mc_aggr )
+		mc_data = new mc_stats;
+
 	if ( strstr( str, ".LSD" ) == NULL )
 	{
 		batch_sequential = true;
@@ -438,6 +564,13 @@ int lsdmain( int argn, const char **argv )
 	// if parallel execution is required, just run new instances & wait to finish
 	if ( ! batch_sequential && sim_num > 1 && max_runs > 1 )
 	{
+		// each parallel run would do its own burn-in
+		if ( warm_steps > 0 )
+		{
+			fprintf( stderr, "\nOption '-i' cannot be used with parallel runs ('-c' with more than one run or '-q').\n%s\n%s\n", lsdCmdMsg, lsdCmdHlp );
+			myexit( 6 );
+		}
+
 		if ( grandTotal || ! no_tot )
 		{
 			printf( "\n(Grand) total file(s) request ignored, running in parallel mode.\n" );
@@ -445,8 +578,18 @@ int lsdmain( int argn, const char **argv )
 			grandTotal = false;
 		}
 
-		return run_parallel( no_window, argv[ 0 ], simul_name, seed, sim_num, max_threads, max_runs );
+#ifdef _WIN32
+		if ( fork_runs )
+		{
+			printf( "\nForked runs request ignored, not available in Windows.\n" );
+			fork_runs = false;
+		}
+#endif
+		if ( ! fork_runs )		// forked runs are started after set up
+			return run_parallel( no_window, argv[ 0 ], simul_name, seed, sim_num, max_threads, max_runs );
 	}
+	else
+		fork_runs = false;
 
 #else
 
@@ -784,6 +927,11 @@ int lsdmain( int argn, const char **argv )
 
 #else
 
+#if ! defined( _NP_ ) && ! defined( _WIN32 )
+	if ( fork_runs )
+		return run_forked( simul_name, seed, sim_num, max_runs );
+#endif
+
 	run( );
 
 #endif
@@ -814,10 +962,13 @@ RUN
 *********************************/
 void run( void )
 {
-	bool batch_sequential_loop = false;
-	char *path_out = NULL, *name_out, sep_out[ 2 ], fname[ MAX_PATH_LENGTH ], bar_done[ 2 * BAR_DONE_SIZE ];
-	int i, perc_done, last_done;
-	FILE *f;
+	bool batch_sequential_loop = false, branch;
+	char *path_out = NULL, *name_out, sep_out[ 2 ], fname[ MAX_PATH_LENGTH ], bar_done[ 2 * BAR_DONE_SIZE ], ckpt_name[ MAX_PATH_LENGTH ] = "";
+	int i, perc_done, last_done, compactions, first_run = 1, resume_step = 0, warm_max = 0;
+	checkpoint ckpt;			// run state to resume the runs
+	map < string, double > run_par;
+	vector < pair < string, double > > base_init, run_init;
+	FILE *f, *warm = NULL;		// burn-in state to start the runs from
 	clock_t start, end, last_update;
 	result *rf;					// pointer for results files (may be zipped or not)
 
@@ -863,6 +1014,25 @@ void run( void )
 
 	for ( i = 1, quit = 0; i <= sim_num && quit != 2; ++i )
 	{
+		// set the checkpoint file of the set of runs, and resume from it if required
+		if ( i == 1 && ( ckpt_steps > 0 || ckpt_resume ) )
+		{
+			if ( ! batch_sequential )
+				snprintf( ckpt_name, MAX_PATH_LENGTH, "%s%s%s_%d.%s", save_alt_path ? alt_path : path, strlen( save_alt_path ? alt_path : path ) > 0 ? "/" : "", save_alt_path ? clean_file( simul_name ) : simul_name, seed, CKPT_EXT );
+			else
+				snprintf( ckpt_name, MAX_PATH_LENGTH, "%s%s%s_%d_%d.%s", save_alt_path ? alt_path : path, strlen( save_alt_path ? alt_path : path ) > 0 ? "/" : "", save_alt_path ? clean_file( simul_name ) : simul_name, findex, seed, CKPT_EXT );
+
+			first_run = 1;
+
+			if ( ckpt_resume && ckpt.load( ckpt_name, true ) && ckpt.run >= 1 && ckpt.run <= sim_num && ( ckpt.run > 1 || ckpt.step > 0 ) )
+			{
+				plog( "\nResuming from checkpoint file %s (simulation %d, case %d)\n", clean_file( ckpt_name ), ckpt.run, ckpt.step );
+				i = first_run = ckpt.run;
+				seed = ckpt.run_seed;
+				resume_step = ckpt.step;
+			}
+		}
+
 		running = true;		// signal simulation is running
 		cur_sim = i;		// update the current run in the set of runs
 		actual_steps = 0;	// no steps performed yet
@@ -898,8 +1068,12 @@ void run( void )
 			batch_sequential_loop = false;
 		}
 
+		// keep the initial state in memory to set up the next runs
+		if ( i == first_run && sim_num > 1 )
+			init_state.take( root );
+
 		// if just another run seed, reload just structure & parameters
-		if ( i > 1 )
+		if ( i > first_run )
 			if ( load_configuration( true, 2 ) != 0 )
 			{
 #ifndef _NW_
@@ -916,28 +1090,115 @@ void run( void )
 			build_obj_list( true );
 
 		series_saved = 0;
+		stream_done = -1;
 		t = 1;
 
-		if ( ! alloc_save_mem( root ) )
+		// stream results to file while running, if required
+		if ( stream_steps > 0 && no_window && ! stream_open( ) )
+		{
+			fprintf( stderr, "\nCannot create temporary file for streaming results.\n" );
+			myexit( 11 );
+		}
+
+		// keep saved series in a memory-mapped file, if required
+		if ( spill_dir != NULL && no_window )
+		{
+			delete spill_map;
+			spill_map = new save_map( spill_dir );
+
+			if ( ! spill_map->ok( ) )
+			{
+				fprintf( stderr, "\nCannot create temporary file for saved series in '%s'.\n", spill_dir );
+				myexit( 11 );
+			}
+		}
+
+		// start from the burn-in state, if available, with the changed parameters
+		branch = false;
+		if ( warm_steps > 0 )
 		{
+			run_init.clear( );
+			get_init_val( root, run_init );
+
+			if ( warm != NULL )
+			{
+				if ( max_step == warm_max && cmp_init_val( base_init, run_init, run_par ) )
+					branch = true;
+				else
+				{
+					plog( "\nConfiguration changed, running a new burn-in\n" );
+					fclose( warm );
+					warm = NULL;
+				}
+			}
+
+			if ( warm == NULL )
+			{
+				base_init = run_init;
+				warm_max = max_step;
+			}
+		}
+
+		// restore the interrupted run state, or set up the saved series
+		if ( resume_step > 0 )
+		{
+			if ( ! ckpt.load( ckpt_name ) )
+			{
+				fprintf( stderr, "\nCheckpoint file '%s' not found or corrupted.\n", ckpt_name );
+				myexit( 10 );
+			}
+
+			if ( ! no_ptr_chk )
+				build_obj_list( true );
+		}
+		else
+			if ( branch )
+			{
+				if ( ! ckpt.load( warm ) )
+				{
+					fprintf( stderr, "\nCannot read the burn-in state from temporary file.\n" );
+					myexit( 10 );
+				}
+
+				set_par_init( root, run_par );
+
+				if ( ! no_ptr_chk )
+					build_obj_list( true );
+			}
+			else
+				if ( ! alloc_save_mem( root ) )
+				{
 #ifndef _NW_
-			log_tcl_error( true, "Memory allocation", "Not enough memory, too many series saved for the memory available" );
-			cmd( "ttk::messageBox -parent . -type ok -icon error -title Error -message \"Not enough memory\" -detail \"Too many series saved for the available memory. Memory insufficient for %d series over %d time steps. Reduce series to save and/or time steps.\nLSD will close now.\"", series_saved, max_step );
+					log_tcl_error( true, "Memory allocation", "Not enough memory, too many series saved for the memory available" );
+					cmd( "ttk::messageBox -parent . -type ok -icon error -title Error -message \"Not enough memory\" -detail \"Too many series saved for the available memory. Memory insufficient for %d series over %d time steps. Reduce series to save and/or time steps.\nLSD will close now.\"", series_saved, max_step );
 #else
-			fprintf( stderr, "\nNot enough memory. Too many series saved for the memory available.\nMemory insufficient for %d series over %d time steps.\nReduce series to save and/or time steps.\n", series_saved, max_step );
+					fprintf( stderr, "\nNot enough memory. Too many series saved for the memory available.\nMemory insufficient for %d series over %d time steps.\nReduce series to save and/or time steps.\n", series_saved, max_step );
 #endif
-			myexit( 11 );
-		}
+					myexit( 11 );
+				}
 
 		// reset trace stack
 		empty_stack( );
 
-		// new random routine' initialization
-		init_random( seed );
+		// new random routine' initialization (resumed runs keep the saved state)
+		if ( resume_step == 0 )
+			init_random( seed );
+
+		// branched runs continue after the burn-in, with their own seed
+		if ( branch )
+			resume_step = warm_steps;
 
 		// reset math error counters
 		init_math_error( );
 
+		// individually saved series go to a single binary file per run
+		if ( ! batch_sequential )
+			snprintf( fname, MAX_PATH_LENGTH, "%s%s%s_%d_single.%s", save_alt_path ? alt_path : path, strlen( save_alt_path ? alt_path : path ) > 0 ? "/" : "", save_alt_path ? clean_file( simul_name ) : simul_name, seed, RES_BIN_EXT );
+		else
+			snprintf( fname, MAX_PATH_LENGTH, "%s%s%s_%d_%d_single.%s", save_alt_path ? alt_path : path, strlen( save_alt_path ? alt_path : path ) > 0 ? "/" : "", save_alt_path ? clean_file( simul_name ) : simul_name, findex, seed, RES_BIN_EXT );
+
+		single_open( fname, dozip );
+
 		seed++;
 		pause_run = false;
 		debug_flag = false;
@@ -950,9 +1211,25 @@ void run( void )
 		no_search = false;
 		done_in = 0;
 		wr_warn_cnt = 0;
+		compactions = 0;
 		start = last_update = clock( );
 
-		for ( t = 1; quit == 0 && t <= max_step; ++t )
+		// report the run start to the parallel runs monitor, if any
+		if ( prg_cur != NULL )
+		{
+			prg_cur->runs = sim_num;
+			prg_cur->max_step = max_step;
+			prg_cur->step = resume_step;
+			prg_cur->start = chrono::duration < double > ( chrono::system_clock::now( ).time_since_epoch( ) ).count( );
+			prg_cur->run = i;
+		}
+
+		// continue after the last checkpointed step, if resuming
+		actual_steps = resume_step;
+		t = resume_step + 1;
+		resume_step = 0;
+
+		for ( ; quit == 0 && t <= max_step; ++t )
 		{
 			// update the percentage done bar, if needed
 			if ( no_window && dobar )
@@ -978,10 +1255,66 @@ void run( void )
 			{
 				actual_steps = t;
 				root->update( true, false );
+
+				// relocate variables contiguously if too fragmented
+				if ( compact_steps > 0 && t % compact_steps == 0 && quit == 0 &&
+					 fragmentation( root ) >= compact_frag )
+				{
+					relocate_vars( root, true );
+					++compactions;
+				}
+
+				// hand the complete block of saved values to the writer, but
+				// the last step, which objects created next may still save
+				if ( stream_file != NULL && ( t + 1 ) % stream_steps == 0 )
+					stream_block( root, t - 1 );
+
+				// save the run state to resume it later, if required
+				if ( ckpt_steps > 0 && t % ckpt_steps == 0 && t < max_step && quit == 0 )
+				{
+					ckpt.run = i;
+					ckpt.step = t;
+					ckpt.run_seed = seed - 1;
+
+					if ( ! checkpoint::savable( root ) )
+						error_hard( "cannot save run checkpoint",
+									"remove option '-k' to run models using C++ object extensions",
+									true,
+									"objects with C++ extensions (ADDEXT) cannot be saved to checkpoint file '%s'", clean_file( ckpt_name ) );
+					else
+						if ( ! ckpt.save( ckpt_name ) )
+							plog( "\nWarning: cannot save checkpoint file '%s' at case %d\n", ckpt_name, t );
+				}
+
+				// keep the burn-in state to start the next runs from it
+				if ( warm_steps > 0 && t == warm_steps && t < max_step && warm == NULL && quit == 0 )
+				{
+					ckpt.run = i;
+					ckpt.step = t;
+					ckpt.run_seed = seed - 1;
+
+					if ( ! checkpoint::savable( root ) )
+						error_hard( "cannot keep burn-in state",
+									"remove option '-i' to run models using C++ object extensions",
+									true,
+									"objects with C++ extensions (ADDEXT) cannot be restored at the start of the next runs" );
+
+					warm = tmpfile( );
+					if ( warm == NULL || ! ckpt.save( warm ) )
+					{
+						plog( "\nWarning: cannot save the burn-in state, running without it\n" );
+						warm_steps = 0;
+					}
+
+					init_random( seed - 1 );	// restart as the branched runs
+				}
 			}
 
 			perc_done = min( 100 * ( ( i - 1 ) + ( double ) t / max_step ) / sim_num, 100 );
 
+			if ( prg_cur != NULL )
+				prg_cur->step = t;
+
 #ifndef _NW_
 			switch ( done_in )
 			{
@@ -1072,7 +1405,11 @@ void run( void )
 			update_bar( bar_done, perc_done, last_done, 2 * BAR_DONE_SIZE );
 
 		if ( fast_mode < 2 )
+		{
 			plog( "\nSimulation %d of %d %s at case %d (%.2f sec.)\n", i, sim_num, quit == 2 ? "stopped" : "finished", t - 1, ( float ) ( end - start ) / CLOCKS_PER_SEC );
+			if ( compact_steps > 0 )
+				plog( "Memory fragmentation: %.1f%% (%d compaction%s)\n", 100 * fragmentation( root ), compactions, compactions == 1 ? "" : "s" );
+		}
 
 		if ( quit == 1 )			// for multiple simulation runs you need to reset quit
 			quit = 0;
@@ -1090,7 +1427,11 @@ void run( void )
 		user_exception = false;
 
 		reset_end( root );
+		single_close( );			// write individually saved series
+		stream_block( root, actual_steps );	// stream the remaining steps, if any
 		root->emptyturbo( );
+		root->emptycolumns( );
+		relocate_vars( root, false );
 
 		if ( quit != 2 && ( sim_num > 1 || no_window ) )
 		{
@@ -1118,11 +1459,11 @@ void run( void )
 				if ( ! no_res )
 				{
 					if ( ! batch_sequential )
-						snprintf( fname, MAX_PATH_LENGTH, "%s%s%s_%d.%s", path_out, sep_out, name_out, seed - 1, docsv ? "csv" : "res" );
+						snprintf( fname, MAX_PATH_LENGTH, "%s%s%s_%d.%s", path_out, sep_out, name_out, seed - 1, dobin ? RES_BIN_EXT : docsv ? "csv" : "res" );
 					else
-						snprintf( fname, MAX_PATH_LENGTH, "%s%s%s_%d_%d.%s", path_out, sep_out, name_out, findex, seed - 1, docsv ? "csv" : "res" );
+						snprintf( fname, MAX_PATH_LENGTH, "%s%s%s_%d_%d.%s", path_out, sep_out, name_out, findex, seed - 1, dobin ? RES_BIN_EXT : docsv ? "csv" : "res" );
 
-					if ( dozip )
+					if ( dozip && ! dobin )
 						strcatn( fname, ".gz", MAX_PATH_LENGTH );
 
 					res_list.push_back( fname );
@@ -1130,9 +1471,13 @@ void run( void )
 					if ( fast_mode < 2 )
 						plog( "Saving results to file %s... ", fname );
 
-					rf = new result( fname, "wt", dozip, docsv );	// create results file object
+					rf = new result( fname, "wt", dozip, docsv, dobin );	// create results file object
 					rf->title( root, 1 );						// write header
-					rf->data( root, 0, actual_steps );			// write all data
+
+					if ( stream_file != NULL )
+						rf->stream( root, actual_steps );		// write streamed data
+					else
+						rf->data( root, 0, actual_steps );		// write all data
 					delete rf;									// close file and delete object
 
 					if ( fast_mode < 2 )
@@ -1174,6 +1519,34 @@ void run( void )
 						plog( "Done\n" );
 				}
 
+				// add run to the cross-run statistics, saved after the last run
+				if ( mc_data != NULL )
+				{
+					mc_data->add( root, actual_steps );
+
+					if ( i == sim_num )
+					{
+						if ( mc_part != NULL )
+							strcpyn( fname, mc_part, MAX_PATH_LENGTH );
+						else
+							if ( ! batch_sequential )
+								snprintf( fname, MAX_PATH_LENGTH, "%s%s%s_%d_%d", path_out, sep_out, name_out, seed - i, seed - 1 + sim_num - i );
+							else
+								snprintf( fname, MAX_PATH_LENGTH, "%s%s%s_%d_%d_%d", path_out, sep_out, name_out, findex, seed - i, seed - 1 + sim_num - i );
+
+						if ( fast_mode < 2 && mc_part == NULL )
+							plog( "\nSaving Monte Carlo statistics to files %s_*.csv... ", fname );
+
+						if ( ! ( mc_part != NULL ? mc_data->save( fname ) : mc_data->save_csv( fname ) ) )
+							plog( "\nWarning: cannot save the Monte Carlo statistics to %s\n", fname );
+						else
+							if ( fast_mode < 2 && mc_part == NULL )
+								plog( "Done\n" );
+
+						mc_data->clear( );
+					}
+				}
+
 				if ( i == sim_num )								// last run?
 					strcpyn( path_res, path_out, MAX_PATH_LENGTH );
 			}
@@ -1181,6 +1554,20 @@ void run( void )
 				if ( fast_mode < 2 )
 					plog( "Nothing to save: no element selected\n" );
 
+			// point the checkpoint to the next run, or remove it after the last
+			if ( strlen( ckpt_name ) > 0 )
+			{
+				if ( i < sim_num )
+				{
+					ckpt.run = i + 1;
+					ckpt.step = 0;
+					ckpt.run_seed = seed;
+					ckpt.save( ckpt_name );
+				}
+				else
+					remove( ckpt_name );
+			}
+
 			if ( i == sim_num )									// last run?
 			{
 				if ( batch_sequential )							// last batch file?
@@ -1215,6 +1602,17 @@ void run( void )
 		}
 	}	// end of run
 
+	stream_close( );
+	single_close( );
+	init_state.clear( );
+
+	if ( warm != NULL )
+		fclose( warm );
+
+	// saved series in the spill file are no longer accessed
+	delete spill_map;
+	spill_map = NULL;
+
 	if ( fast_mode == 2 )
 		plog( "\nFinished processing configuration file(s)\n" );
 
@@ -1397,7 +1795,7 @@ ALLOC_SAVE_VAR
 *********************************/
 bool alloc_save_var( variable *v )
 {
-	bool prev_state = no_more_memory;
+	bool ok, prev_state = no_more_memory;
 
 	if ( ! running )
 		return true;
@@ -1411,12 +1809,31 @@ bool alloc_save_var( variable *v )
 
 		v->end = max_step;
 
-		// use C stdlib to be able to deallocate memory for deleted objects
-		free( v->data );
-		v->data = ( double * ) malloc( ( v->end - v->start + 1 ) * sizeof( double ) );
+		// apply the saving policy: period and time steps interval
+		v->data_step = max( v->save_every, 1 );
+		v->start = max( v->start, v->save_from );
+		v->start += ( v->data_step - ( v->start - v->save_from ) % v->data_step ) % v->data_step;
+
+		if ( v->save_to > 0 )
+			v->end = min( v->end, v->save_to );
+
+		v->data_size = max( ( v->end - v->start ) / v->data_step + 1, 1 );
+
+		// keep just the last steps if streaming results (individual files need all)
+		if ( stream_file != NULL && ! v->savei )
+			v->data_size = min( v->data_size, 2 * stream_steps + 1 );
 
-		if( v->data == NULL )
+		// or the last values, if required and not streaming
+		if ( stream_file == NULL && v->save_last > 0 )
+			v->data_size = min( v->data_size, v->save_last );
+
+		// circular buffers are kept uncompressed (streamed ones also in double)
+		v->free_data( );
+		ok = v->alloc_data( stream_file != NULL ? 0 : v->save_last > 0 ? v->save_fmt & ~ SAVE_ZIP : v->save_fmt );
+
+		if ( ! ok )
 		{
+			v->free_data( );
 			no_more_memory = true;
 			v->save = v->savei = false;
 			v->start = v->end = 0;
@@ -1430,9 +1847,12 @@ bool alloc_save_var( variable *v )
 		else
 		{
 			if ( v->num_lag > 0	 || v->param == 1 )
-				v->data[ 0 ] = v->val[ 0 ];
+			{
+				v->set_data( t - 1, v->val[ 0 ] );
+				v->save_arr( t - 1 );
+			}
 
-			++series_saved;
+			v->serial = series_saved++;
 		}
 	}
 	else
@@ -1442,6 +1862,128 @@ bool alloc_save_var( variable *v )
 }
 
 
+/*********************************
+GET_INIT_VAL
+Collect the initial values of all
+instances, in the model tree order:
+parameters ("p"), initial lags of
+variables ("v") and number of object
+instances ("b") per bridge
+*********************************/
+void get_init_val( object *r, vector < pair < string, double > > &vals )
+{
+	int i, n;
+	bridge *cb;
+	object *cur;
+	variable *cv;
+	char key[ MAX_ELEM_LENGTH + 50 ];
+
+	for ( cv = r->v; cv != NULL; cv = cv->next )
+		if ( cv->param == 1 )
+		{
+			snprintf( key, MAX_ELEM_LENGTH + 50, "p %s %d", cv->label, cv->save || cv->savei );
+			vals.push_back( make_pair( string( key ), cv->val != NULL ? cv->val[ 0 ] : 0 ) );
+		}
+		else
+			for ( i = 0; i <= cv->num_lag; ++i )
+			{
+				snprintf( key, MAX_ELEM_LENGTH + 50, "v %s %d %d %d", cv->label, cv->param, cv->save || cv->savei, i );
+				vals.push_back( make_pair( string( key ), i < cv->num_lag && cv->val != NULL ? cv->val[ i ] : 0 ) );
+			}
+
+	for ( cb = r->b; cb != NULL; cb = cb->next )
+	{
+		for ( n = 0, cur = cb->head; cur != NULL; cur = cur->next, ++n );
+
+		snprintf( key, MAX_ELEM_LENGTH + 50, "b %s", cb->blabel );
+		vals.push_back( make_pair( string( key ), n ) );
+
+		for ( cur = cb->head; cur != NULL; cur = cur->next )
+			get_init_val( cur, vals );
+	}
+}
+
+
+/*********************************
+CMP_INIT_VAL
+Compare the initial values of two
+configurations, instance by instance,
+returning in pars the parameters
+changed to the same value in all
+instances, or false if the burn-in
+state cannot be reused (different
+structure, initial lags or
+parameters changed per instance)
+*********************************/
+bool cmp_init_val( vector < pair < string, double > > &base, vector < pair < string, double > > &vals, map < string, double > &pars )
+{
+	bool same;
+	size_t i;
+	string lab;
+
+	pars.clear( );
+
+	if ( base.size( ) != vals.size( ) )
+		return false;
+
+	for ( i = 0; i < vals.size( ); ++i )
+	{
+		if ( base[ i ].first != vals[ i ].first )
+			return false;
+
+		same = base[ i ].second == vals[ i ].second || ( isnan( base[ i ].second ) && isnan( vals[ i ].second ) );
+
+		if ( vals[ i ].first[ 0 ] != 'p' )
+		{
+			if ( ! same )
+				return false;
+		}
+		else
+			if ( ! same )
+			{
+				lab = vals[ i ].first.substr( 2, vals[ i ].first.find( ' ', 2 ) - 2 );
+				pars.insert( make_pair( lab, vals[ i ].second ) );
+			}
+	}
+
+	// changed parameters must be the same in all instances
+	for ( i = 0; i < vals.size( ); ++i )
+		if ( vals[ i ].first[ 0 ] == 'p' )
+		{
+			lab = vals[ i ].first.substr( 2, vals[ i ].first.find( ' ', 2 ) - 2 );
+
+			if ( pars.count( lab ) > 0 && ! ( pars[ lab ] == vals[ i ].second || ( isnan( pars[ lab ] ) && isnan( vals[ i ].second ) ) ) )
+				return false;
+		}
+
+	return true;
+}
+
+
+/*********************************
+SET_PAR_INIT
+Set the values of the parameters
+in pars in all the instances
+*********************************/
+void set_par_init( object *r, map < string, double > &pars )
+{
+	bridge *cb;
+	object *cur;
+	variable *cv;
+
+	if ( pars.size( ) == 0 )
+		return;
+
+	for ( cv = r->v; cv != NULL; cv = cv->next )
+		if ( cv->param == 1 && cv->val != NULL && pars.count( cv->label ) > 0 )
+			cv->val[ 0 ] = pars[ cv->label ];
+
+	for ( cb = r->b; cb != NULL; cb = cb->next )
+		for ( cur = cb->head; cur != NULL; cur = cur->next )
+			set_par_init( cur, pars );
+}
+
+
 /*********************************
 RESET_END
 *********************************/
@@ -1453,9 +1995,16 @@ void reset_end( object *r )
 
 	for ( cv = r->v; cv != NULL; cv = cv->next )
 	{
-		if ( cv->save )
-			cv->end = t - 1;
-		if ( cv->savei == 1 )
+		cv->vec_time = -1;			// discard pending vector results
+		if ( cv->save && ! running )
+		{
+			cv->end = cv->save_to > 0 ? min( cv->save_to, t - 1 ) : t - 1;
+
+			// trim and order kept last values (streamed data is released when written)
+			if ( stream_file == NULL )
+				cv->trim_data( );
+		}
+		if ( cv->savei == 1 && ! running )
 			save_single( cv );
 	}
 
@@ -1538,15 +2087,20 @@ bool search_parallel( object *r )
 
 /***************************************
 RUN_PARALLEL_EXEC
+Perform the parallel runs not yet started,
+one at a time, until none is left
 ***************************************/
-void run_parallel_exec( bool nw, int id, string cmd )
+void run_parallel_exec( bool nw, int id )
 {
-	int res;
+	int i, res;
 
-	res = run_system( cmd.c_str( ), id );
+	while ( ! parallel_abort && ( i = run_next++ ) < ( int ) run_cmds.size( ) )
+	{
+		res = run_system( run_cmds[ i ].c_str( ), id );
 
-	lock_guard < mutex > lock( lock_run_status );
-	run_status[ id ] = res;
+		lock_guard < mutex > lock( lock_run_status );
+		run_status[ i ] = res;
+	}
 }
 
 
@@ -1557,15 +2111,17 @@ RUN_PARALLEL
 int run_parallel( bool nw, const char *exec, const char *simname, int fseed, int runs, int thrrun, int parruns )
 {
 	char *alt_name;
-	int i, j, k, num, sl;
+	int i, j, num, sl;
 
 	int path_len = save_alt_path ? strlen( alt_path ) : strlen( path );
 	int name_len = strlen( simname ) + ( int ) log10( fseed + runs ) + 2;
 	int dest_len = path_len + 5;
 	int log_len = path_len + name_len + 6;
 	int res_len = path_len + name_len + 9;
-	int cmd_len = strlen( exec ) + 2 * ( path_len + name_len ) + 50;
-	char dest_path[ dest_len ], log_file[ log_len ], res_file[ res_len ], cmd[ cmd_len ];
+	int mc_len = 4 + path_len + 1 + name_len + 1 + strlen( MC_AGG_EXT ) + 1;
+	int spill_len = spill_dir != NULL ? strlen( spill_dir ) + 5 : 1;
+	int cmd_len = strlen( exec ) + 3 * ( path_len + name_len ) + spill_len + 136 + MAX_ELEM_LENGTH;
+	char extra_opt[ 80 ], prg_name[ MAX_ELEM_LENGTH ], prg_opt[ MAX_ELEM_LENGTH + 16 ], mc_opt[ mc_len ], dest_path[ dest_len ], log_file[ log_len ], res_file[ res_len ], spill_opt[ spill_len ], cmd[ cmd_len ];
 
 	alt_name = clean_file( simname );
 
@@ -1574,72 +2130,88 @@ int run_parallel( bool nw, const char *exec, const char *simname, int fseed, int
 	else
 		strcpy( dest_path, "" );
 
+	if ( spill_dir != NULL )
+		snprintf( spill_opt, spill_len, " -d %s", spill_dir );
+	else
+		strcpy( spill_opt, "" );
+
+	if ( compact_steps > 0 )
+		snprintf( extra_opt, 50, " -m %d:%g", compact_steps, 100 * compact_frag );
+	else
+		strcpy( extra_opt, "" );
+
+	if ( stream_steps > 0 )
+		snprintf( extra_opt + strlen( extra_opt ), 25, " -w %d", stream_steps );
+
+	if ( ckpt_steps > 0 )
+		snprintf( extra_opt + strlen( extra_opt ), 25, " -k %d", ckpt_steps );
+
+	if ( ckpt_resume )
+		strcatn( extra_opt, " -x", 80 );
+
+
+	if ( dobin )
+		strcatn( extra_opt, " -u", 80 );
+
+	run_cmds.clear( );
 	run_logs.clear( );
 	run_pids.clear( );
 	run_status.clear( );
 	run_threads.clear( );
 	run_results.clear( );
 	parallel_abort = false;
+	run_next = 0;
 
-	if ( runs > parruns )				// more than one run per thread?
+	// shared memory for the runs to report progress, named after this process
+#ifdef _WIN32
+	snprintf( prg_name, MAX_ELEM_LENGTH, "lsd_prg_%lu", ( unsigned long ) GetCurrentProcessId( ) );
+#else
+	snprintf( prg_name, MAX_ELEM_LENGTH, "lsd_prg_%lu", ( unsigned long ) getpid( ) );
+#endif
+	delete prg_mon;
+	prg_mon = new prg_map( prg_name, runs, true );
+
+	// prepare one run per seed, to be picked by the first free thread
+	for ( i = fseed; i < fseed + runs; ++i )
 	{
-		num = runs / parruns;			// base number of cases per thread
-		sl = runs % parruns;			// remaining cases per thread
+		// log file name
+		snprintf( log_file, log_len, "%s%s%s_%d.log", save_alt_path ? alt_path : path, strlen( save_alt_path ? alt_path : path ) > 0 ? "/" : "", save_alt_path ? alt_name : simname, i );
+		remove( log_file );		// avoid monitoring old logs
+		run_logs.push_back( log_file );
 
-		// allocate runs by thread
-		for ( i = fseed, j = 1; j <= parruns; ++j )
-		{
-			// log file name
-			snprintf( log_file, log_len, "%s%s%s_%d.log", save_alt_path ? alt_path : path, strlen( save_alt_path ? alt_path : path ) > 0 ? "/" : "", save_alt_path ? alt_name : simname, j );
-			run_logs.push_back( log_file );
+		// results file name
+		snprintf( res_file, res_len, "%s%s%s_%d.%s", save_alt_path ? alt_path : path, strlen( save_alt_path ? alt_path : path ) > 0 ? "/" : "", save_alt_path ? alt_name : simname, i, dobin ? RES_BIN_EXT : docsv ? "csv" : "res" );
 
-			// results file names
-			for ( k = i; k < i + num + ( j <= sl ? 1 : 0 ); ++k )
-			{
-				snprintf( res_file, res_len, "%s%s%s_%d.%s", save_alt_path ? alt_path : path, strlen( save_alt_path ? alt_path : path ) > 0 ? "/" : "", save_alt_path ? alt_name : simname, k, docsv ? "csv" : "res" );
+		if ( dozip && ! dobin )
+			strcatn( res_file, ".gz", res_len );
 
-				if ( dozip )
-					strcatn( res_file, ".gz", res_len );
+		if ( ! no_res )
+			run_results.push_back( res_file );
 
-				if ( ! no_res )
-					run_results.push_back( res_file );
-			}
+		// progress reporting slot
+		if ( prg_mon->ok( ) )
+			snprintf( prg_opt, MAX_ELEM_LENGTH + 16, " -j %s:%d", prg_name, i - fseed );
+		else
+			strcpy( prg_opt, "" );
 
-			// command line
-			snprintf( cmd, cmd_len, "%s -c %d -f %s.lsd -s %d -e %d%s%s%s%s%s%s -l %s", exec, thrrun, simname, i, j <= sl ? num + 1 : num, no_res ? " -r" : "", no_tot ? " -p" : "", docsv ? " -t" : "", dozip ? "" : " -z", dobar ? " -b" : "", dest_path, log_file );
+		// partial Monte Carlo statistics file
+		if ( mc_aggr )
+			snprintf( mc_opt, mc_len, " -y %s%s%s_%d.%s", save_alt_path ? alt_path : path, strlen( save_alt_path ? alt_path : path ) > 0 ? "/" : "", save_alt_path ? alt_name : simname, i, MC_AGG_EXT );
+		else
+			strcpy( mc_opt, "" );
 
-			run_pids.resize( run_pids.size( ) + 1 );
-			run_status.push_back( INISTAT );
-			run_threads.push_back( thread( run_parallel_exec, nw, run_status.size( ) - 1, string( cmd ) ) );
+		// command line
+		snprintf( cmd, cmd_len, "%s -c %d -f %s.lsd -s %d -e 1%s%s%s%s%s%s%s%s%s%s -l %s", exec, thrrun, simname, i, no_res ? " -r" : "", no_tot ? " -p" : "", docsv ? " -t" : "", dozip ? "" : " -z", dobar ? " -b" : "", extra_opt, prg_opt, mc_opt, spill_opt, dest_path, log_file );
 
-			j <= sl ? i += num + 1 : i += num;
-		}
+		run_cmds.push_back( cmd );
+		run_status.push_back( INISTAT );
 	}
-	else								// just one run per thread
-	{
-		for ( i = fseed, j = 1; i < fseed + runs; ++i, ++j )
-		{
-			// log file name
-			snprintf( log_file, log_len, "%s%s%s_%d.log", save_alt_path ? alt_path : path, strlen( save_alt_path ? alt_path : path ) > 0 ? "/" : "", save_alt_path ? alt_name : simname, i );
-			run_logs.push_back( log_file );
-
-			// results file name
-			snprintf( res_file, res_len, "%s%s%s_%d.%s", save_alt_path ? alt_path : path, strlen( save_alt_path ? alt_path : path ) > 0 ? "/" : "", save_alt_path ? alt_name : simname, i, docsv ? "csv" : "res" );
 
-			if ( dozip )
-				strcatn( res_file, ".gz", res_len );
-
-			if ( ! no_res )
-				run_results.push_back( res_file );
-
-			// command line
-			snprintf( cmd, cmd_len, "%s -c %d -f %s.lsd -s %d -e 1%s%s%s%s%s%s -l %s", exec, thrrun, simname, i, no_res ? " -r" : "", no_tot ? " -p" : "", docsv ? " -t" : "", dozip ? "" : " -z", dobar ? " -b" : "", dest_path, log_file );
-
-			run_pids.resize( run_pids.size( ) + 1 );
-			run_status.push_back( INISTAT );
-			run_threads.push_back( thread( run_parallel_exec, nw, run_status.size( ) - 1, string( cmd ) ) );
-		}
-	}
+	// start the threads, each one performing the next run available
+	parruns = min( parruns, runs );
+	run_pids.resize( parruns );
+	for ( j = 0; j < parruns; ++j )
+		run_threads.push_back( thread( run_parallel_exec, nw, j ) );
 
 	if ( nw )
 	{
@@ -1653,7 +2225,7 @@ int run_parallel( bool nw, const char *exec, const char *simname, int fseed, int
 
 			do
 			{
-				msleep( 1000 );
+				msleep( prg_mon->ok( ) ? 200 : 1000 );
 
 				num = monitor_logs( );
 				if ( num < 0 )
@@ -1673,8 +2245,14 @@ int run_parallel( bool nw, const char *exec, const char *simname, int fseed, int
 			if ( thr.joinable( ) )
 				thr.join( );
 
+		delete prg_mon;
+		prg_mon = NULL;
+
 		log_parallel( nw );
 
+		if ( mc_aggr )
+			mc_parallel( simname, fseed, runs );
+
 		i = 0;
 		for ( int status : run_status )
 			if ( status != 0 )
@@ -1692,26 +2270,195 @@ int run_parallel( bool nw, const char *exec, const char *simname, int fseed, int
 }
 
 
+#ifndef _WIN32
+/***************************************
+RUN_FORKED
+Perform the runs in parallel child processes
+forked from the loaded configuration, which
+is shared in copy-on-write memory, starting
+the next run as soon as a process ends
+***************************************/
+int run_forked( const char *simname, int fseed, int runs, int parruns )
+{
+	char log_file[ MAX_PATH_LENGTH ];
+	int i, slot, status, done, last = -1, res = 0;
+	pid_t pid;
+	FILE *f;
+	vector < pid_t > slot_pid( parruns, 0 );
+	vector < bool > slot_used( parruns, false );
+
+	run_logs.clear( );
+	parallel_abort = false;
+
+	for ( slot = 0; slot < parruns; ++slot )
+	{
+		snprintf( log_file, MAX_PATH_LENGTH, "%s%s%s_%d.log", save_alt_path ? alt_path : path, strlen( save_alt_path ? alt_path : path ) > 0 ? "/" : "", save_alt_path ? clean_file( simname ) : simname, slot + 1 );
+		run_logs.push_back( log_file );
+	}
+
+	if ( dobar )
+		printf( "\n" );
+
+	fflush( stdout );
+	fflush( stderr );
+
+	for ( i = done = 0; done < runs; )
+	{
+		// start the next runs in the free processes
+		for ( slot = 0; slot < parruns && i < runs; ++slot )
+		{
+			if ( slot_pid[ slot ] != 0 )
+				continue;
+
+			pid = fork( );
+
+			if ( pid == 0 )			// child process: perform a single run
+			{
+				if ( ( f = fopen( run_logs[ slot ].c_str( ), slot_used[ slot ] ? "a" : "w" ) ) != NULL )
+				{
+					dup2( fileno( f ), STDOUT_FILENO );
+					dup2( fileno( f ), STDERR_FILENO );
+					fclose( f );
+				}
+
+				seed = fseed + i;
+				sim_num = 1;
+
+				if ( mc_aggr )			// save partial statistics for the parent
+				{
+					snprintf( log_file, MAX_PATH_LENGTH, "%s%s%s_%d.%s", save_alt_path ? alt_path : path, strlen( save_alt_path ? alt_path : path ) > 0 ? "/" : "", save_alt_path ? clean_file( simname ) : simname, seed, MC_AGG_EXT );
+					mc_part = new char[ strlen( log_file ) + 1 ];
+					strcpy( mc_part, log_file );
+				}
+				dobar = false;		// progress shown by parent process
+				run( );
+				myexit( 0 );
+			}
+
+			if ( pid < 0 )
+			{
+				fprintf( stderr, "\nCannot create process for run with seed %d.\n", fseed + i );
+				runs = i;			// wait for the started runs only
+				res = 12;
+				break;
+			}
+
+			slot_pid[ slot ] = pid;
+			slot_used[ slot ] = true;
+			++i;
+		}
+
+		if ( done >= runs )
+			break;
+
+		// wait for any run to end
+		pid = wait( & status );
+		if ( pid < 0 )
+			break;
+
+		for ( slot = 0; slot < parruns && slot_pid[ slot ] != pid; ++slot );
+		if ( slot < parruns )
+			slot_pid[ slot ] = 0;
+
+		if ( res == 0 )
+			res = WIFEXITED( status ) ? WEXITSTATUS( status ) : 128 + WTERMSIG( status );
+
+		++done;
+
+		if ( dobar )
+			update_bar( NULL, 100 * done / runs, last, 2 * BAR_DONE_SIZE );
+	}
+
+	if ( dobar )
+		printf( "\n" );
+
+	for ( slot = 0; slot < parruns; ++slot )
+		if ( ! slot_used[ slot ] )
+			run_logs[ slot ] = "";
+
+	run_logs.erase( remove( run_logs.begin( ), run_logs.end( ), string( "" ) ), run_logs.end( ) );
+	log_parallel( true );
+
+	if ( mc_aggr )
+		mc_parallel( simname, fseed, runs );
+
+	return res;
+}
+#endif
+
+
+/***************************************
+MC_PARALLEL
+Merge the partial Monte Carlo statistics
+of the parallel runs and save them
+***************************************/
+void mc_parallel( const char *simname, int fseed, int runs )
+{
+	char fname[ MAX_PATH_LENGTH ];
+	int i, n = 0;
+	const char *dir = save_alt_path ? alt_path : path, *name = save_alt_path ? clean_file( simname ) : simname;
+	mc_stats stats;
+
+	for ( i = fseed; i < fseed + runs; ++i )
+	{
+		snprintf( fname, MAX_PATH_LENGTH, "%s%s%s_%d.%s", dir, strlen( dir ) > 0 ? "/" : "", name, i, MC_AGG_EXT );
+
+		if ( stats.load( fname ) )
+			++n;
+
+		remove( fname );
+	}
+
+	snprintf( fname, MAX_PATH_LENGTH, "%s%s%s_%d_%d", dir, strlen( dir ) > 0 ? "/" : "", name, fseed, fseed + runs - 1 );
+
+	printf( "\nSaving Monte Carlo statistics of %d run%s to files %s_*.csv... ", n, n == 1 ? "" : "s", fname );
+
+	if ( stats.save_csv( fname ) )
+		printf( "Done\n" );
+	else
+		printf( "\nCannot save the Monte Carlo statistics.\n" );
+}
+
+
 /***************************************
 MONITOR_LOGS
+Return the overall progress of the parallel
+runs, negative if no run is left to perform,
+as reported in shared memory or, if not
+available, in the runs log files
 ***************************************/
 int monitor_logs( void )
 {
-	int i, j, k, last, len, thr, threads, n = 0, finished = 0, sum = 0;
+	int i, j, k, last, len, run, runs, finished = 0, sum = 0;
 	char *log = NULL, tok[ 4 ];
+	run_prg *prg;
 	FILE *f;
 
-	// check if threads are still running
-	threads = run_status.size( );
-	for ( thr = 0; thr < threads; ++thr )
-		if ( run_status[ thr ] != INISTAT )
+	// count the finished runs
+	runs = run_status.size( );
+	for ( run = 0; run < runs; ++run )
+		if ( run_status[ run ] != INISTAT )
 			++finished;
 
-	thr = 0;
+	// no run left to perform, signal it
+	if ( runs == 0 || finished == runs || parallel_abort )
+		return - ( runs == 0 ? 100 : 100 * finished / runs );
+
+	// progress of running runs reported in shared memory
+	if ( prg_mon != NULL && prg_mon->ok( ) )
+	{
+		for ( run = 0; run < runs; ++run )
+			if ( run_status[ run ] == INISTAT && ( prg = prg_mon->run( run ) ) != NULL && prg->run > 0 && prg->runs > 0 && prg->max_step > 0 )
+				sum += min( ( int ) ( 100 * ( prg->run - 1 + ( double ) prg->step / prg->max_step ) / prg->runs ), 99 );
+
+		return ( 100 * finished + sum ) / runs;
+	}
+
+	run = 0;
 	for ( string logn : run_logs )
 	{
-		// consider just running threads except if all threads are stopped
-		if ( run_status[ thr++ ] != INISTAT && finished < threads )
+		// consider just running runs (not yet started ones have no log)
+		if ( run >= runs || run_status[ run++ ] != INISTAT )
 			continue;
 
 		if ( ( f = fopen( logn.c_str( ), "rb" ) ) == NULL )
@@ -1738,18 +2485,7 @@ int monitor_logs( void )
 					strncpy( tok, log + i + j, min( last - j, 3 ) );
 					tok[ min( last - j, 3 ) ] = '\0';
 					if ( sscanf( tok, "%d", & k ) == 1 )
-					{
-						if ( finished < threads )
-						{
-							sum += k;
-							++n;
-						}
-						else		// all threads stopped, pick the more advanced
-						{
-							sum = max( sum, k );
-							n = 1;
-						}
-					}
+						sum += min( k, 99 );
 				}
 
 				break;				// just consider last bar in log
@@ -1758,11 +2494,7 @@ int monitor_logs( void )
 		delete [ ] log;
 	}
 
-	// no thread running, signal it
-	if ( finished == threads )
-		return n == 0 ? -1 : - sum / n;
-	else
-		return n == 0 ? 0 : sum / n;	// rounded-down average
+	return ( 100 * finished + sum ) / runs;	// rounded-down average
 }
 
 
@@ -1826,6 +2558,9 @@ void detach_parallel( void )
 
 	if ( run_monitor.joinable( ) )
 		run_monitor.detach( );
+
+	delete prg_mon;				// remove the shared memory name
+	prg_mon = NULL;
 }
 
 
@@ -1840,6 +2575,9 @@ void monitor_parallel( bool nw )
 		if ( thr.joinable( ) )
 			thr.join( );
 
+	delete prg_mon;
+	prg_mon = NULL;
+
 	log_parallel( nw );
 
 	parallel_monitor = false;
@@ -86,6 +86,7 @@ class vector2D
 		vector < T > data;
 };
 
+bool is_bin( const char *fname );
 void save_csv( const char *base, const char *suffix, vector < string > header, vector2D < double > data, int rows, int cols );
 
 // constant string arrays
@@ -93,13 +94,13 @@ const char *signal_names[ REG_SIG_NUM ] = REG_SIG_NAME;
 const int signals[ REG_SIG_NUM ] = REG_SIG_CODE;
 
 char nonavail[ ] = "NA";	// string for unavailable values (use R default)
-char **in_files = NULL;		// input .csv files
+char **in_files = NULL;		// input .csv/.lrb files
 char *out_file = NULL;		// output .csv file, if any
 
 // command line strings
 const char lsdCmdMsg[ ] = "This is the LSD Monte Carlo statistics generator.";
-const char lsdCmdDsc[ ] = "It reads a set of CSV (comma separated values) result files (.csv)\nfrom a Monte Carlo (MC) experiment and generates four new CSV files\ncontaining the means, standard errors, maximums and minimum values\nfor each variable and case (time step) considering all MC samples (runs).\n";
-const char lsdCmdHlp[ ] = "Command line options:\n'-o OUTPUT' base name for the comma separated output text files\n'-f FILENAME1.csv FILENAME2.csv ...' the MC experiment result files to use\n";
+const char lsdCmdDsc[ ] = "It reads a set of CSV (comma separated values) or binary columnar result\nfiles (.csv or .lrb) from a Monte Carlo (MC) experiment and generates four new CSV files\ncontaining the means, standard errors, maximums and minimum values\nfor each variable and case (time step) considering all MC samples (runs).\n";
+const char lsdCmdHlp[ ] = "Command line options:\n'-o OUTPUT' base name for the comma separated output text files\n'-f FILENAME1.csv FILENAME2.csv ...' the MC experiment result files to use\n(binary FILENAME.lrb files may be used instead of .csv ones)\n";
 
 
 /*********************************
@@ -109,8 +110,11 @@ int lsdmain( int argn, const char **argv )
 {
 	char ch, *linbuf, *tok;
 	double val, sum, sumsq, maxv, minv;
-	int i, j, k, n, sz, linsz = 0, rows = 0, cols = 0, files = 0;
+	int i, j, k, n, t, t0, sz, linsz = 0, rows = 0, cols = 0, files = 0;
+	vector < double > vals;
 	vector < string > vars, cur_vars;
+	const res_bin_ser *ser;
+	res_bin *rb;
 	FILE *f;
 
 	if ( argn < 2 )
@@ -170,16 +174,30 @@ int lsdmain( int argn, const char **argv )
 
 		// determine number of rows and columns from results file
 		j = 0;
-		while ( ! feof( f ) )
+		if ( is_bin( in_files[ i ] ) )
 		{
-			for ( ch = k = 0; ch != '\n' && ch != EOF; ++k )
-				ch = ( char ) fgetc( f );
+			res_bin rbf( in_files[ i ] );
 
-			if ( k > 0 && ch != EOF )
-				++j;
+			if ( ! rbf.ok( ) )
+			{
+				fprintf( stderr, "\nInvalid binary file (%s).\n%s.\nFiles must be created by LSD in binary columnar format.\n\n", in_files[ i ], lsdCmdMsg );
+				myexit( 5 );
+			}
 
-			linsz = max( linsz, k );
+			// header plus data rows, skipping initialization as in .csv
+			j = rbf.last( ) - max( rbf.first( ), 1 ) + 2;
 		}
+		else
+			while ( ! feof( f ) )
+			{
+				for ( ch = k = 0; ch != '\n' && ch != EOF; ++k )
+					ch = ( char ) fgetc( f );
+
+				if ( k > 0 && ch != EOF )
+					++j;
+
+				linsz = max( linsz, k );
+			}
 
 		fclose( f );
 
@@ -204,19 +222,32 @@ int lsdmain( int argn, const char **argv )
 
 	for ( i = 0; i < files; ++i )
 	{
-		f = fopen( in_files[ i ], "rt" );
-
-		// read header line
 		cur_vars.clear( );
-		fgets( linbuf, linsz + 1, f );
-		tok = strtok( linbuf, SEP ); // prepares parsing / get first variable name
-		for ( j = 0; tok != NULL; ++j )
+
+		if ( is_bin( in_files[ i ] ) )
 		{
-			sz = strlen( tok ) + 1;
-			char out[ sz ];
-			strtrim( out, tok, sz );
-			cur_vars.push_back( out );
-			tok = strtok( NULL, SEP );
+			// binary files are memory mapped, series named as in .csv
+			rb = new res_bin( in_files[ i ] );
+
+			for ( j = 0; j < rb->series( ); ++j )
+				cur_vars.push_back( string( rb->label( j ) ) + "_" + rb->tag( j ) );
+		}
+		else
+		{
+			rb = NULL;
+			f = fopen( in_files[ i ], "rt" );
+
+			// read header line
+			fgets( linbuf, linsz + 1, f );
+			tok = strtok( linbuf, SEP ); // prepares parsing / get first variable name
+			for ( j = 0; tok != NULL; ++j )
+			{
+				sz = strlen( tok ) + 1;
+				char out[ sz ];
+				strtrim( out, tok, sz );
+				cur_vars.push_back( out );
+				tok = strtok( NULL, SEP );
+			}
 		}
 
 		if ( i == 0 )
@@ -232,6 +263,32 @@ int lsdmain( int argn, const char **argv )
 			myexit( 7 );
 		}
 
+		if ( rb != NULL )
+		{
+			t0 = max( rb->first( ), 1 );
+
+			for ( k = 0; k < cols; ++k )
+			{
+				ser = rb->info( k );
+				vals.resize( max( ser->end - ser->start + 1, 1 ) );
+
+				if ( ! rb->read( k, vals.data( ) ) )
+				{
+					fprintf( stderr, "\nInvalid file values (%s).\n%s.\nFiles must have same number of rows (>1) and columns (>0).\n\n", in_files[ i ], lsdCmdMsg );
+					myexit( 8 );
+				}
+
+				for ( j = 0; j < rows - 1; ++j )
+				{
+					t = t0 + j;
+					mcdata( i, j, k ) = ( t >= ser->start && t <= ser->end ) ? vals[ t - ser->start ] : NAN;
+				}
+			}
+
+			delete rb;
+			continue;
+		}
+
 		// read data lines
 		for ( j = 0; j < rows - 1 && ! feof( f ); ++j )
 		{
@@ -320,13 +377,25 @@ int lsdmain( int argn, const char **argv )
 }
 
 
+/***************************************************
+ IS_BIN
+ check if file is a binary columnar results file
+ ***************************************************/
+bool is_bin( const char *fname )
+{
+	size_t len = strlen( fname ), ext = strlen( "." RES_BIN_EXT );
+
+	return len > ext && ! strcmp( fname + len - ext, "." RES_BIN_EXT );
+}
+
+
 /***************************************************
  SAVE_CSV
  save table to CSV file
  ***************************************************/
 void save_csv( const char *base, const char *suffix, vector < string > header, vector2D < double > data, int rows, int cols )
 {
-	char fn[ strlen( base ) + strlen( suffix ) + 6 ];
+	char fn[ strlen( base ) + strlen( suffix ) + 6 ], num[ MAX_ELEM_LENGTH ];
 	int i, j, k;
 	FILE *f;
 
@@ -347,7 +416,10 @@ void save_csv( const char *base, const char *suffix, vector < string > header, v
 	{
 		for ( k = 0; k < cols; ++k )
 			if ( isfinite( data( j, k ) ) )
-				fprintf( f, "%s%g", k > 0 ? "," : "", data( j, k ) );
+			{
+				strnum( num, data( j, k ), 6, 'g', sizeof( num ) );
+				fprintf( f, "%s%s", k > 0 ? "," : "", num );
+			}
 			else
 				fprintf( f, "%s%s", k > 0 ? "," : "", nonavail );
 
@@ -25,7 +25,13 @@ used to identify the object type and to insert it in a model.
 - char *label;
 Name of the object. The name is used indicate one specific type of object in the
 model. Two objects are always identical in their definition. Inheritance is not
-used in LSD, yet.
+used in LSD, yet. The name is not copied in each instance but shared by all the
+objects of the same type through its layout.
+
+- layout *lay;
+pointer to the data shared by all instances of the same object type: the name
+and the slot indexes used by the fast look-up vectors b_map and v_map, so each
+instance stores just the pointers to its own bridges and variables.
 
 - variable *v;
 the first element of a linked chain of variable. They are the computational content
@@ -271,8 +277,87 @@ see file.cpp
 char *qsort_lab;
 char *qsort_lab_secondary;
 int qsort_lag;
+l_mapT layouts;					// shared object type layouts
+atomic < int > arenas_num( 0 );		// number of compaction arenas in use
+map < char *, pair < size_t, int > > arenas;// compaction arenas (size, live variables)
 object *globalcur;
 
+#ifndef _NP_
+mutex lock_arenas;				// lock for arenas parallel manipulation
+mutex lock_layouts;				// lock for layouts parallel manipulation
+#endif
+
+
+/****************************************************
+LAYOUT
+Constructor
+****************************************************/
+layout::layout( const char *lab )
+{
+	label = new char[ strlen( lab ) + 1 ];
+	strcpy( label, lab );
+}
+
+
+/****************************************************
+GET_LAYOUT
+Find the shared layout of the object type lab,
+creating it if required. Layouts are kept for the
+entire session, as they are few and small.
+****************************************************/
+layout *get_layout( const char *lab )
+{
+	layout *lay;
+	l_mapT::iterator lit;
+
+#ifndef _NP_
+	// prevent concurrent update by more than one thread
+	lock_guard < mutex > lock( lock_layouts );
+#endif
+
+	if ( ( lit = layouts.find( lab ) ) != layouts.end( ) )
+		return lit->second;
+
+	lay = new layout( lab );
+	layouts.insert( make_pair( string( lab ), lay ) );
+
+	return lay;
+}
+
+
+/****************************************************
+GET_SLOT
+Find the slot index of element lab in a layout map,
+adding a new slot if required and add is true.
+New slots are only created when the model structure
+changes, so reading the maps requires no lock.
+****************************************************/
+int get_slot( s_mapT &slots, const char *lab, bool add )
+{
+	int i;
+	s_mapT::iterator sit;
+
+	if ( ( sit = slots.find( lab ) ) != slots.end( ) )
+		return sit->second;
+
+	if ( ! add )
+		return -1;
+
+#ifndef _NP_
+	// prevent concurrent update by more than one thread
+	lock_guard < mutex > lock( lock_layouts );
+
+	// recheck if not added during lock
+	if ( ( sit = slots.find( lab ) ) != slots.end( ) )
+		return sit->second;
+#endif
+
+	i = slots.size( );
+	slots.insert( make_pair( string( lab ), i ) );
+
+	return i;
+}
+
 
 /****************************************************
 BRIDGE
@@ -282,6 +367,7 @@ bridge::bridge( const char *lab )
 {
 	copy = false;
 	counter_updated = false;
+	col_num = 0;
 	next = NULL;
 	mn = NULL;
 	head = NULL;
@@ -296,12 +382,14 @@ bridge::bridge( const bridge &b )
 {
 	copy = true;
 	counter_updated = b.counter_updated;
+	col_num = b.col_num;
 	next = b.next;
 	blabel = b.blabel;
 	mn = b.mn;
 	head = b.head;
 	search_var = b.search_var;
 	o_map = b.o_map;
+	cols = b.cols;
 }
 
 bridge::~bridge( void )
@@ -325,6 +413,9 @@ bridge::~bridge( void )
 		delete cur;
 	}
 
+	for ( auto col : cols )		// release columns after instances
+		delete [ ] col;
+
 	delete [ ] search_var;
 
 	delete [ ] blabel;
@@ -339,13 +430,10 @@ void object::init( object *_up, const char *lab, bool _to_compute )
 {
 	up = _up;
 	v = NULL;
-	v_map.clear( );
 	next = NULL;
 	to_compute = _to_compute;
-	label = new char[ strlen( lab ) + 1 ];
-	strcpy( label, lab );
 	b = NULL;
-	b_map.clear( );
+	set_layout( lab );			// shared label and empty maps
 	hook = NULL;
 	hooks.clear( );
 	node = NULL;				// not part of a network yet
@@ -357,6 +445,18 @@ void object::init( object *_up, const char *lab, bool _to_compute )
 }
 
 
+/****************************************************
+SET_LAYOUT
+Set the object type, changing the shared layout
+****************************************************/
+void object::set_layout( const char *lab )
+{
+	lay = get_layout( lab );
+	label = lay->label;
+	recreate_maps( );
+}
+
+
 /****************************************************
 RECREATE_MAPS
 Recreate both fast look-up maps
@@ -370,10 +470,92 @@ void object::recreate_maps( void )
 	b_map.clear( );
 
 	for ( cv = v; cv != NULL; cv = cv->next )
-		v_map.insert( v_pairT( cv->label, cv ) );
+		map_var( cv->label, cv );
 
 	for ( cb = b; cb != NULL; cb = cb->next )
-		b_map.insert( b_pairT( cb->blabel, cb ) );
+		map_bridge( cb->blabel, cb );
+}
+
+
+/****************************************************
+MAP_BRIDGE
+Set (or remove, if cb is NULL) the bridge to the
+object lab in the fast look-up map
+****************************************************/
+void object::map_bridge( const char *lab, bridge *cb )
+{
+	int i = get_slot( lay->b_slot, lab, cb != NULL );
+
+	if ( i < 0 )
+		return;
+
+	if ( i >= ( int ) b_map.size( ) )
+	{
+		if ( cb == NULL )
+			return;
+
+		b_map.resize( lay->b_slot.size( ), NULL );
+	}
+
+	b_map[ i ] = cb;
+}
+
+
+/****************************************************
+MAP_VAR
+Set (or remove, if cv is NULL) the variable lab
+in the fast look-up map
+****************************************************/
+void object::map_var( const char *lab, variable *cv )
+{
+	int i = get_slot( lay->v_slot, lab, cv != NULL );
+
+	if ( i < 0 )
+		return;
+
+	if ( i >= ( int ) v_map.size( ) )
+	{
+		if ( cv == NULL )
+			return;
+
+		v_map.resize( lay->v_slot.size( ), NULL );
+	}
+
+	v_map[ i ] = cv;
+}
+
+
+/****************************************************
+LOOKUP_BRIDGE
+Find the bridge to the object lab using the fast
+look-up map, return NULL if not found
+****************************************************/
+bridge *object::lookup_bridge( const char *lab )
+{
+	s_mapT::iterator sit;
+
+	if ( ( sit = lay->b_slot.find( lab ) ) == lay->b_slot.end( ) ||
+		 sit->second >= ( int ) b_map.size( ) )
+		return NULL;
+
+	return b_map[ sit->second ];
+}
+
+
+/****************************************************
+LOOKUP_VAR
+Find the variable lab using the fast look-up map,
+return NULL if not found
+****************************************************/
+variable *object::lookup_var( const char *lab )
+{
+	s_mapT::iterator sit;
+
+	if ( ( sit = lay->v_slot.find( lab ) ) == lay->v_slot.end( ) ||
+		 sit->second >= ( int ) v_map.size( ) )
+		return NULL;
+
+	return v_map[ sit->second ];
 }
 
 
@@ -414,7 +596,10 @@ void object::update( bool recurse, bool user )
 		if ( ! deleted	)
 		{
 			if ( cv->save || cv->savei )
-				cv->data[ t - cv->start ] = cv->val[ 0 ];
+			{
+				cv->set_data( t, cv->val[ 0 ] );
+				cv->save_arr( t );
+			}
 #ifndef _NW_
 			if ( ! user && cv->plot == 1 )
 				plot_rt( cv );
@@ -556,11 +741,11 @@ Uses the fast bridge look-up map.
 ***************************************************/
 bridge *object::search_bridge( const char *lab, bool no_error )
 {
-	b_mapT::iterator bit;
+	bridge *cb;
 
 	// find the bridge which contains the object
-	if ( ( bit = b_map.find( lab ) ) != b_map.end( ) )
-		return bit->second;
+	if ( ( cb = lookup_bridge( lab ) ) != NULL )
+		return cb;
 
 	if ( ! no_error )
 		error_hard( "internal problem in LSD",
@@ -580,15 +765,14 @@ object *object::search( const char *lab, bool no_search )
 {
 	bridge *cb;
 	object *cur;
-	b_mapT::iterator bit;
 
 	// the current object?
 	if ( ! strcmp( label, lab ) )
 		return this;
 
 	// Search among the descendants of current object
-	if ( ( bit = b_map.find( lab ) ) != b_map.end( ) )
-		return bit->second->head;
+	if ( ( cb = lookup_bridge( lab ) ) != NULL )
+		return cb->head;
 
 	// stop if search is disabled
 	if ( no_search )
@@ -663,20 +847,445 @@ remove all turbo search nodes
 *****************************/
 void object::emptyturbo( void )
 {
-	bridge *cb;
-	object *cur;
+	bridge *cb;
+	object *cur;
+
+	for ( cb = this->b; cb != NULL; cb = cb->next )
+	{
+		if ( cb->mn != NULL )
+		{
+			cb->mn->empty( );
+			delete cb->mn;
+			cb->mn = NULL;
+		}
+		for ( cur = cb->head; cur != NULL; cur = cur->next )
+			cur->emptyturbo( );
+	}
+}
+
+
+/****************************
+INITCOLUMNS
+Pack the values (and lags) of all instances of
+object lab, descending from this, in contiguous
+per-variable columns kept by the bridge. Variables
+are views over the columns, so the existing code is
+unaffected. Columns get outdated when instances are
+added, deleted or sorted and are removed at the end
+of the simulation run. Must be called from a
+non-parallel equation.
+Returns the number of instances packed.
+*****************************/
+double object::initcolumns( const char *lab )
+{
+	double *col;
+	int i, j, k, n, stride;
+	bridge *cb;
+	object *cur;
+	variable *cv, *cv1;
+	vector < double * > old;
+
+	cb = search_bridge( lab, true );
+	if ( cb == NULL )
+	{
+		error_hard( "object not found",
+					"check your equation code to prevent this situation",
+					true,
+					"failure when initializing object '%s' for columnar storage", lab );
+		return 0;
+	}
+
+#ifndef _NP_
+	// prevent concurrent initialization by more than one thread
+	obj_lguardT lock( parallel_comp );
+#endif
+
+	for ( n = 0, cur = cb->head; cur != NULL; ++n, cur = cur->next );
+
+	old.swap( cb->cols );
+	cb->col_num = 0;
+
+	if ( n == 0 )
+		goto end;
+
+	cb->cols.assign( cb->head->lay->v_slot.size( ), NULL );
+
+	for ( cv = cb->head->v; cv != NULL; cv = cv->next )
+	{
+		if ( cv->val == NULL )
+			continue;
+
+		j = get_slot( cb->head->lay->v_slot, cv->label, false );
+		stride = cv->num_lag + 1;
+		col = cb->cols[ j ] = new double[ n * stride ];
+
+		for ( i = 0, cur = cb->head; cur != NULL; ++i, cur = cur->next )
+		{
+			cv1 = ( j < ( int ) cur->v_map.size( ) ) ? cur->v_map[ j ] : NULL;
+
+			if ( cv1 == NULL || cv1->num_lag != cv->num_lag )
+			{
+				error_hard( "internal problem in LSD",
+							"if error persists, please contact developers",
+							true,
+							"invalid data structure (instances of '%s' differ)", lab );
+				return 0;
+			}
+
+			for ( k = 0; k < stride; ++k )
+				col[ i * stride + k ] = cv1->val[ k ];
+
+			if ( ! cv1->in_column && ! cv1->in_arena )
+				delete [ ] cv1->val;
+
+			cv1->val = col + i * stride;
+			cv1->in_arena = false;
+			cv1->in_column = true;
+		}
+	}
+
+	cb->col_num = n;
+
+	end:
+	for ( auto c : old )		// all instances now use the new columns
+		delete [ ] c;
+
+	return n;
+}
+
+
+/****************************
+EMPTYCOLUMNS
+Return the variables in columns to individual
+storage and remove the columns in all the
+bridges below this
+*****************************/
+void object::emptycolumns( void )
+{
+	bridge *cb;
+	object *cur;
+	variable *cv;
+
+	for ( cb = this->b; cb != NULL; cb = cb->next )
+	{
+		for ( cur = cb->head; cur != NULL; cur = cur->next )
+		{
+			for ( cv = cur->v; cv != NULL; cv = cv->next )
+				uncolumn( cv );
+
+			cur->emptycolumns( );
+		}
+
+		for ( auto col : cb->cols )
+			delete [ ] col;
+
+		cb->cols.clear( );
+		cb->col_num = 0;
+	}
+}
+
+
+/****************************
+UNCOLUMN
+Move the variable values out of the bridge
+columns to its own storage
+*****************************/
+void uncolumn( variable *cv )
+{
+	double *val;
+
+	if ( ! cv->in_column )
+		return;
+
+	val = new double[ cv->num_lag + 1 ];
+	memcpy( val, cv->val, ( cv->num_lag + 1 ) * sizeof( double ) );
+	cv->val = val;
+	cv->in_column = false;
+}
+
+
+/****************************
+COLUMN
+Return the values column of variable cv if all
+instances of its object are packed and up to date,
+or NULL otherwise, setting the number of instances
+and the column stride
+*****************************/
+double *column( variable *cv, int *n, int *stride )
+{
+	bridge *cb;
+	int j;
+
+	if ( ! cv->in_column || cv->up->up == NULL )
+		return NULL;
+
+	cb = cv->up->up->lookup_bridge( cv->up->label );
+	j = get_slot( cv->up->lay->v_slot, cv->label, false );
+
+	if ( cb == NULL || cb->col_num <= 0 || j < 0 || j >= ( int ) cb->cols.size( ) )
+		return NULL;
+
+	*n = cb->col_num;
+	*stride = cv->num_lag + 1;
+
+	return cb->cols[ j ];
+}
+
+
+/****************************
+VARIABLE
+operator new
+Variables are allocated individually, unless
+relocated to a compaction arena, from the C heap,
+so the allocation always pairs with the class
+operator delete
+*****************************/
+void *variable::operator new( size_t sz )
+{
+	void *p = malloc( sz );
+
+	if ( p == NULL )
+		throw bad_alloc( );
+
+	return p;
+}
+
+
+/****************************
+VARIABLE
+operator delete
+Release the variable memory, freeing the
+compaction arena when its last variable is gone
+*****************************/
+void variable::operator delete( void *p )
+{
+	map < char *, pair < size_t, int > >::iterator it;
+
+	if ( p == NULL )
+		return;
+
+	if ( arenas_num > 0 )					// skip lookup if no compaction done
+	{
+#ifndef _NP_
+		lock_guard < mutex > lock( lock_arenas );
+#endif
+		it = arenas.upper_bound( ( char * ) p );
+
+		if ( it != arenas.begin( ) )
+		{
+			--it;
+			if ( ( char * ) p < it->first + it->second.first )
+			{
+				if ( --it->second.second == 0 )
+				{
+					delete [ ] it->first;
+					arenas.erase( it );
+					--arenas_num;
+				}
+
+				return;
+			}
+		}
+	}
+
+	free( p );
+}
+
+
+/****************************
+ARENA_MEMBER
+Check if the variable was relocated to a
+compaction arena
+*****************************/
+static bool arena_member( variable *cv )
+{
+	map < char *, pair < size_t, int > >::iterator it;
+
+#ifndef _NP_
+	lock_guard < mutex > lock( lock_arenas );
+#endif
+	it = arenas.upper_bound( ( char * ) cv );
+
+	return it != arenas.begin( ) && ( char * ) cv < ( --it )->first + it->second.first;
+}
+
+
+/****************************
+FRAGMENTATION
+Return the share of jumps, backwards or over
+FRAG_DIST bytes, when accessing the variables
+and their values in the tree below r in
+updating order
+*****************************/
+static void frag_count( object *r, char *&last, int *jumps, int *n )
+{
+	char *addr[ 2 ];
+	int i;
+	bridge *cb;
+	object *cur;
+	variable *cv;
+
+	for ( cv = r->v; cv != NULL; cv = cv->next )
+	{
+		addr[ 0 ] = ( char * ) cv;
+		addr[ 1 ] = ( char * ) cv->val;
+
+		for ( i = 0; i < 2 && addr[ i ] != NULL; ++i )
+		{
+			if ( last != NULL )
+			{
+				if ( addr[ i ] < last || addr[ i ] - last > FRAG_DIST )
+					++*jumps;
+
+				++*n;
+			}
+
+			last = addr[ i ];
+		}
+	}
+
+	for ( cb = r->b; cb != NULL; cb = cb->next )
+		for ( cur = cb->head; cur != NULL; cur = cur->next )
+			frag_count( cur, last, jumps, n );
+}
+
+double fragmentation( object *r )
+{
+	char *last = NULL;
+	int jumps = 0, n = 0;
+
+	frag_count( r, last, & jumps, & n );
+
+	return n > 0 ? ( double ) jumps / n : 0;
+}
+
+
+/****************************
+RELOCATE_VARS
+Move the variables in the tree below r, and
+their lagged values, into a single contiguous
+arena in updating order (compact true), or
+back from the arenas to individual storage
+(compact false), fixing the pointers to them.
+Objects are kept in place, as user code and the
+look-up structures hold pointers to them.
+Must be called only between time steps
+*****************************/
+static size_t arena_size( object *r, int *n )
+{
+	size_t sz = 0;
+	bridge *cb;
+	object *cur;
+	variable *cv;
+
+	for ( cv = r->v; cv != NULL; cv = cv->next, ++*n )
+	{
+		sz += sizeof( variable );
+
+		if ( ! cv->in_column && cv->val != NULL )
+			sz += ( cv->num_lag + 1 ) * sizeof( double );
+	}
+
+	for ( cb = r->b; cb != NULL; cb = cb->next )
+		for ( cur = cb->head; cur != NULL; cur = cur->next )
+			sz += arena_size( cur, n );
+
+	return sz;
+}
+
+static variable *relocate_var( variable *cv, char *&pos )
+{
+	bool own = ! cv->in_column && cv->val != NULL;
+	variable *nv;
+
+	if ( pos != NULL )
+	{
+		nv = ::new ( pos ) variable( *cv );
+		pos += sizeof( variable );
+
+		if ( own )
+		{
+			nv->val = ( double * ) pos;
+			nv->in_arena = true;
+			pos += ( cv->num_lag + 1 ) * sizeof( double );
+		}
+	}
+	else
+	{
+		nv = new variable( *cv );
+
+		if ( own )
+		{
+			nv->val = new double[ cv->num_lag + 1 ];
+			nv->in_arena = false;
+		}
+	}
+
+	if ( own )
+	{
+		memcpy( nv->val, cv->val, ( cv->num_lag + 1 ) * sizeof( double ) );
+
+		if ( ! cv->in_arena )
+			delete [ ] cv->val;
+	}
+
+	delete cv;					// just the old copy, contents moved
+
+	return nv;
+}
+
+static void relocate_obj( object *r, char *&pos, bool compact )
+{
+	bridge *cb;
+	object *cur;
+	variable *cv, **prev;
+
+	for ( prev = & r->v; *prev != NULL; prev = & ( *prev )->next )
+	{
+		cv = *prev;
+
+		if ( ! compact && ! arena_member( cv ) )
+			continue;
+
+		*prev = relocate_var( cv, pos );
+
+		if ( r->lookup_var( ( *prev )->label ) == cv )
+			r->map_var( ( *prev )->label, *prev );
+	}
+
+	for ( cb = r->b; cb != NULL; cb = cb->next )
+		for ( cur = cb->head; cur != NULL; cur = cur->next )
+			relocate_obj( cur, pos, compact );
+}
+
+void relocate_vars( object *r, bool compact )
+{
+	char *base, *pos = NULL;
+	int n = 0;
+	size_t sz;
 
-	for ( cb = this->b; cb != NULL; cb = cb->next )
+	if ( compact )
 	{
-		if ( cb->mn != NULL )
+		sz = arena_size( r, & n );
+
+		if ( n == 0 )
+			return;
+
+		pos = base = new char[ sz ];
+
 		{
-			cb->mn->empty( );
-			delete cb->mn;
-			cb->mn = NULL;
+#ifndef _NP_
+			lock_guard < mutex > lock( lock_arenas );
+#endif
+			arenas[ base ] = make_pair( sz, n );
+			++arenas_num;
 		}
-		for ( cur = cb->head; cur != NULL; cur = cur->next )
-			cur->emptyturbo( );
 	}
+	else
+		if ( arenas.empty( ) )
+			return;
+
+	relocate_obj( r, pos, compact );
 }
 
 
@@ -772,7 +1381,7 @@ double object::initturbo( const char *lab, double tot = 0 )
 
 #ifndef _NP_
 	// prevent concurrent initialization by more than one thread
-	lock_guard < mutex > lock( parallel_comp );
+	obj_lguardT lock( parallel_comp );
 #endif
 
 	if ( cb->mn != NULL )		// remove existing mnode
@@ -946,11 +1555,10 @@ variable *object::search_var( object *caller, const char *lab, bool no_error,
 {
 	bridge *cb;
 	variable *cv;
-	v_mapT::iterator vit;
 
 	// Search among the variables of current object
-	if ( ( vit = v_map.find( lab ) ) != v_map.end( ) )
-		return vit->second;
+	if ( ( cv = lookup_var( lab ) ) != NULL )
+		return cv;
 
 	// stop if search is disabled except if direct sons must still be searched
 	if ( no_search && ! search_sons )
@@ -1064,7 +1672,6 @@ double object::initturbo_cond( const char *lab )
 	bridge *cb;
 	object *cur, *cnext;
 	variable *cv;
-	b_mapT::iterator bit;
 
 	cv = search_var_err( this, lab, no_search, true, "turbo conditional searching" );
 	if ( cv == NULL )
@@ -1080,7 +1687,7 @@ double object::initturbo_cond( const char *lab )
 	}
 
 	// find the bridge which contains the object containing the variable
-	if ( ( bit = cv->up->up->b_map.find( cv->up->label ) ) == cv->up->up->b_map.end( ) )
+	if ( ( cb = cv->up->up->lookup_bridge( cv->up->label ) ) == NULL )
 	{
 		error_hard( "internal problem in LSD",
 					"if error persists, please contact developers",
@@ -1091,10 +1698,9 @@ double object::initturbo_cond( const char *lab )
 
 #ifndef _NP_
 	// prevent concurrent initialization by more than one thread
-	lock_guard < mutex > lock( parallel_comp );
+	obj_lguardT lock( parallel_comp );
 #endif
 
-	cb = bit->second;
 	cb->o_map.clear( );						// remove any existing mapping
 
 	// fill the map with the object values
@@ -1122,7 +1728,6 @@ object *object::turbosearch_cond( const char *lab, double value )
 {
 	bridge *cb;
 	variable *cv;
-	b_mapT::iterator bit;
 	o_mapT::iterator oit;
 
 	cv = search_var_err( this, lab, no_search, true, "turbo conditional searching" );
@@ -1139,7 +1744,7 @@ object *object::turbosearch_cond( const char *lab, double value )
 	}
 
 	// find the bridge which contains the object containing the variable
-	if ( ( bit = cv->up->up->b_map.find( cv->up->label ) ) == cv->up->up->b_map.end( ) )
+	if ( ( cb = cv->up->up->lookup_bridge( cv->up->label ) ) == NULL )
 	{
 		error_hard( "internal problem in LSD",
 					"if error persists, please contact developers",
@@ -1148,8 +1753,6 @@ object *object::turbosearch_cond( const char *lab, double value )
 		return NULL;
 	}
 
-	cb = bit->second;
-
 	if ( cb->o_map.size( ) == 0 || cb->search_var == NULL || strcmp( cb->search_var, lab ) )
 	{
 		error_hard( "invalid search operation",
@@ -1202,7 +1805,7 @@ variable *object::add_empty_var( const char *lab )
 	}
 
 	cv->init( this, lab, -1, NULL, 0 );
-	v_map.insert( v_pairT ( lab, cv ) );
+	map_var( lab, cv );
 
 	return cv;
 }
@@ -1236,6 +1839,11 @@ void object::add_var_from_example( variable *example )
 
 	cv->init( this, example->label, example->num_lag, example->val, example->save );
 	cv->savei = example->savei;
+	cv->save_fmt = example->save_fmt;
+	cv->save_every = example->save_every;
+	cv->save_from = example->save_from;
+	cv->save_to = example->save_to;
+	cv->save_last = example->save_last;
 	cv->last_update = example->last_update;
 	cv->delay = example->delay;
 	cv->delay_range = example->delay_range;
@@ -1250,7 +1858,13 @@ void object::add_var_from_example( variable *example )
 	cv->deb_cnd_val = example->deb_cnd_val;
 	cv->data_loaded = example->data_loaded;
 
-	v_map.insert( v_pairT ( example->label, cv ) );
+	if ( example->arr != NULL )
+	{
+		cv->set_dim( example->rows, example->cols );
+		memcpy( cv->arr, example->arr, ( cv->num_lag + 1 ) * cv->rows * cv->cols * sizeof( double ) );
+	}
+
+	map_var( example->label, cv );
 }
 
 
@@ -1296,7 +1910,7 @@ void object::add_obj( const char *lab, int num, int propagate )
 			cur1->init( cur, lab );
 		}
 
-		cur->b_map.insert( b_pairT ( lab, cb ) );
+		cur->map_bridge( lab, cb );
 	}
 }
 
@@ -1342,7 +1956,7 @@ void move_obj( const char *lab, const char *dest )
 			mb = cb;
 			mb->next = NULL;	// moved object bridge enters at the end of the new parent list
 
-			s->b_map.erase( lab );	// update speedup maps
+			s->map_bridge( lab, NULL );	// update speedup maps
 			s = s->hyper_next( );	// next source parent
 		}
 		else	// handle the case last object instance has to be cloned to fill
@@ -1390,7 +2004,7 @@ void move_obj( const char *lab, const char *dest )
 			for ( cur = mb->head; cur != NULL; cur = cur->next )
 				cur->up = d;
 
-			d->b_map.insert( b_pairT ( lab, mb ) );	// update speedup maps
+			d->map_bridge( lab, mb );	// update speedup maps
 			d = d->hyper_next( );					// next destination parent
 		}
 		else	// handle the case last object instances in source parent must be
@@ -1456,7 +2070,7 @@ void copy_descendant( object *from, object *to )
 	to->b = new bridge( from->b->blabel );
 
 	// add bridge to new object lookup map
-	to->b_map.insert( b_pairT ( to->b->blabel, to->b ) );
+	to->map_bridge( to->b->blabel, to->b );
 
 	// create the first (head) object
 	if ( from->b->head == NULL )
@@ -1479,7 +2093,7 @@ void copy_descendant( object *from, object *to )
 	{
 		cb->next = new bridge( cb1->blabel );
 		cb = cb->next;
-		to->b_map.insert( b_pairT ( cb1->blabel, cb ) );
+		to->map_bridge( cb1->blabel, cb );
 
 		if ( cb1->head == NULL )
 			cur = blueprint->search( cb1->blabel );
@@ -1550,10 +2164,11 @@ object *object::add_n_objects2( const char *lab, int n, object *ex, int t_update
 
 #ifndef _NP_
 	// prevent concurrent additions by more than one thread
-	lock_guard < mutex > lock( parallel_comp );
+	obj_lguardT lock( parallel_comp );
 #endif
 
 	cb2->counter_updated = false;
+	cb2->col_num = 0;
 
 	// check if the objects are nodes in a network (avoid using EX from blueprint)
 	cur = search( lab );
@@ -1623,7 +2238,7 @@ object *object::add_n_objects2( const char *lab, int n, object *ex, int t_update
 				cb1 = cb1->next = new bridge( cb->blabel );
 
 			// add bridge to new object lookup map
-			cur->b_map.insert( b_pairT ( cb->blabel, cb1 ) );
+			cur->map_bridge( cb->blabel, cb1 );
 
 			for ( cur1 = cb->head; cur1 != NULL; cur1 = cur1->next )
 				cur->add_n_objects2( cur1->label, 1, cur1, t_update );
@@ -1676,7 +2291,7 @@ void delete_bridge( object *d )
 	{	// first bridge in the bridge chain
 		cb = d->up->b;
 		d->up->b = d->up->b->next;
-		d->up->b_map.erase( cb->blabel );
+		d->up->map_bridge( cb->blabel, NULL );
 		delete cb;
 	}
 	else
@@ -1685,7 +2300,7 @@ void delete_bridge( object *d )
 			if ( cb->head == d && cb1 != NULL )
 			{
 				cb1->next = cb->next;			// previous bridge points to next
-				d->up->b_map.erase( cb->blabel );
+				d->up->map_bridge( cb->blabel, NULL );
 				delete cb;
 				break;
 			}
@@ -1710,7 +2325,7 @@ void object::delete_obj( variable *caller )
 	{							// create context for lock
 #ifndef _NP_
 		// prevent concurrent deletion by more than one thread
-		lock_guard < mutex > lock( parallel_comp );
+		obj_lguardT lock( parallel_comp );
 #endif
 
 		if ( deleting )			// ignore if deleting already going on
@@ -1786,6 +2401,7 @@ void object::delete_obj( variable *caller )
 		}
 
 		cb->counter_updated = false;
+		cb->col_num = 0;
 
 		if ( cb->search_var != NULL )						// indexed objects?
 			cb->o_map.erase( cal( cb->search_var, 0 ) );	// try to remove map entry
@@ -1836,15 +2452,15 @@ void object::empty( void )
 		node = NULL;
 	}
 
-	delete [ ] label;
-	label = NULL;
+	label = NULL;				// shared with layout, never deleted
+	lay = NULL;
 }
 
 
 /***************************************************
 COLLECT_CEMETERY
 Processes variables from an object required to go to cemetery
-Also destroy variables not requiring saving
+Also destroy variables, after moving the saved data
 ***************************************************/
 void object::collect_cemetery( variable *caller )
 {
@@ -1862,19 +2478,20 @@ void object::collect_cemetery( variable *caller )
 
 			set_lab_tit( cv );				// update last lab_tit
 
-			cv->end = t;					// define last period,
-			cv->data[ t - cv->start ] = cv->val[ 0 ];	// and last value
+			cv->set_data( t, cv->val[ 0 ] );	// save last value
+			cv->save_arr( t );
+			cv->end = cv->save_to > 0 ? min( cv->save_to, t ) : t;	// and define last period
 
-			// use C stdlib to be able to deallocate memory for deleted objects
-			cv->data = ( double * ) realloc( cv->data, ( t - cv->start + 1 ) * sizeof( double ) );
+			// trim unused memory (streamed data is released when written)
+			if ( stream_file == NULL )
+				cv->trim_data( );
 
-			add_cemetery( cv );				// transfer to cemetery
-		}
-		else
-		{
-			cv->empty( caller == NULL || cv == caller );// disable lock if emptying caller
-			delete cv;
+			uncolumn( cv );					// columns may be removed before
+			add_cemetery( cv );				// transfer data to cemetery
 		}
+
+		cv->empty( caller == NULL || cv == caller );// disable lock if emptying caller
+		delete cv;
 	}
 
 	v = NULL;
@@ -1884,39 +2501,339 @@ void object::collect_cemetery( variable *caller )
 
 /***************************************************
 ADD_CEMETERY
-Store the variable in a list of variables in objects deleted
-but to be used for analysis.
+Store the saved data of a variable in an object
+deleted but to be used for analysis.
 ***************************************************/
 void add_cemetery( variable *v )
 {
-	if ( cemetery == NULL )
-		cemetery = last_cemetery = v;
-	else
+	cemetery.bury( v );
+}
+
+
+/***************************************************
+EMPTY_CEMETERY
+***************************************************/
+void empty_cemetery( void )
+{
+	cemetery.clear( );
+}
+
+
+/***************************************************
+GRAVEYARD
+Methods for the deleted objects series store (class
+graveyard). The series of the variables in deleted
+objects are moved, together, into large memory
+blocks, in time order and without the variables
+structure, and indexed in the graves vector. If a
+spill file is in use, the series stay there. When
+streaming results, the series keep their circular
+buffers, released once written.
+***************************************************/
+
+/***************************************************
+CONSTRUCTOR
+***************************************************/
+graveyard::graveyard( void )
+{
+	next = NULL;
+	left = 0;
+}
+
+
+/***************************************************
+DESTRUCTOR
+***************************************************/
+graveyard::~graveyard( void )
+{
+	clear( );
+}
+
+
+/***************************************************
+ALLOC
+Reserve space in the current memory block, or in a
+new one, for series or strings (8-byte aligned)
+***************************************************/
+void *graveyard::alloc( size_t size )
+{
+	char *p;
+
+	size = ( size + 7 ) & ~ ( size_t ) 7;
+
+	if ( size > left )
 	{
-		last_cemetery->next = v;
-		last_cemetery = v;
+		if ( size > GRAVE_BLOCK / 4 )	// large series in own block
+		{
+			p = new ( nothrow ) char[ size ];
+
+			if ( p != NULL )
+				blks.push_back( p );
+
+			return p;
+		}
+
+		next = new ( nothrow ) char[ GRAVE_BLOCK ];
+
+		if ( next == NULL )
+		{
+			left = 0;
+			return NULL;
+		}
+
+		blks.push_back( next );
+		left = GRAVE_BLOCK;
 	}
 
-	last_cemetery->next = NULL;
+	p = next;
+	next += size;
+	left -= size;
+
+	return p;
 }
 
 
 /***************************************************
-EMPTY_CEMETERY
+COPY
+Store a string, returning its address in the store
 ***************************************************/
-void empty_cemetery( void )
+char *graveyard::copy( const char *text )
 {
-	variable *cv, *cv1;
+	char *p = ( char * ) alloc( strlen( text ) + 1 );
+
+	if ( p != NULL )
+		strcpy( p, text );
+
+	return p;
+}
+
+
+/***************************************************
+BURY
+Move the saved data of a variable to the store,
+detaching it from the variable, to be deleted next
+***************************************************/
+void graveyard::bury( variable *cv )
+{
+	size_t m, n;
+	double *vals, *arr_vals;
+	float *vals_flt;
+	grave cg;
+
+#ifndef _NP_
+	// prevent concurrent burials by more than one thread
+	lock_guard < mutex > guard( lock );
+#endif
 
-	for ( cv = cemetery; cv !=NULL ; )
+	auto it = labels.find( cv->label );
+	if ( it == labels.end( ) )
+		it = labels.insert( make_pair( string( cv->label ), copy( cv->label ) ) ).first;
+
+	cg.label = it->second;
+	cg.lab_tit = copy( cv->lab_tit != NULL ? cv->lab_tit : "" );
+	cg.in_store = cv->in_map;
+	cg.rows = cv->arr != NULL ? cv->rows : 0;
+	cg.cols = cv->arr != NULL ? cv->cols : 0;
+	cg.data_size = cv->data_size;
+	cg.data_step = cv->data_step;
+	cg.start = cv->start;
+	cg.end = cv->end;
+	cg.serial = cv->serial;
+	cg.data = cv->data;
+	cg.data_flt = cv->data_flt;
+	cg.data_zip = cv->data_zip;
+	cg.arr_data = cg.rows * cg.cols > 0 ? cv->arr_data : NULL;
+
+	if ( cg.arr_data == NULL && ! cv->in_map )
+		free( cv->arr_data );
+
+	// streamed series are released when written, spilled ones stay in file
+	if ( stream_file == NULL && ! cv->in_map )
 	{
-		cv1 = cv->next;
-		cv->empty( );
-		delete cv;
-		cv = cv1;
+		n = cv->data_size;
+		m = cg.rows * cg.cols;
+		vals = cg.data != NULL ? ( double * ) alloc( n * sizeof( double ) ) : NULL;
+		vals_flt = cg.data_flt != NULL ? ( float * ) alloc( n * sizeof( float ) ) : NULL;
+		arr_vals = cg.arr_data != NULL ? ( double * ) alloc( n * m * sizeof( double ) ) : NULL;
+
+		// keep the original storage if out of memory
+		if ( ( vals != NULL ) == ( cg.data != NULL ) && ( vals_flt != NULL ) == ( cg.data_flt != NULL ) && ( arr_vals != NULL ) == ( cg.arr_data != NULL ) )
+		{
+			if ( vals != NULL )
+				memcpy( vals, cg.data, n * sizeof( double ) );
+
+			if ( vals_flt != NULL )
+				memcpy( vals_flt, cg.data_flt, n * sizeof( float ) );
+
+			if ( arr_vals != NULL )
+				memcpy( arr_vals, cg.arr_data, n * m * sizeof( double ) );
+
+			free( cg.data );
+			free( cg.data_flt );
+			free( cg.arr_data );
+
+			cg.data = vals;
+			cg.data_flt = vals_flt;
+			cg.arr_data = arr_vals;
+			cg.in_store = true;
+		}
+	}
+
+	// the variable no longer owns the saved data
+	cv->data = cv->arr_data = NULL;
+	cv->data_flt = NULL;
+	cv->data_zip = NULL;
+	cv->in_map = false;
+
+	graves.push_back( cg );
+}
+
+
+/***************************************************
+CLEAR
+Release all the series and the store memory
+***************************************************/
+void graveyard::clear( void )
+{
+	for ( auto &cg : graves )
+		cg.free_data( );
+
+	for ( auto blk : blks )
+		delete [ ] blk;
+
+	graves.clear( );
+	blks.clear( );
+	labels.clear( );
+	next = NULL;
+	left = 0;
+}
+
+
+/***************************************************
+GRAVE
+Methods for the series of deleted objects variables
+(struct grave), stored in time order, except when
+streaming results (circular buffers)
+***************************************************/
+
+/***************************************************
+DATA_POS
+Position of a time step in the saved data
+***************************************************/
+int grave::data_pos( int time )
+{
+	return ( time - start ) / data_step % data_size;
+}
+
+
+/***************************************************
+IN_DATA
+Check if a time step is in the saved data
+***************************************************/
+bool grave::in_data( int time )
+{
+	return time >= start && time <= end && ( time - start ) % data_step == 0 && time > end - data_size * data_step;
+}
+
+
+/***************************************************
+GET_DATA
+Read the saved value in a time step (NAN if none)
+***************************************************/
+double grave::get_data( int time )
+{
+	if ( ! in_data( time ) )
+		return NAN;
+
+	if ( data != NULL )
+		return data[ data_pos( time ) ];
+
+	if ( data_flt != NULL )
+		return data_flt[ data_pos( time ) ];
+
+	if ( data_zip != NULL )
+		return data_zip->get( data_pos( time ) );
+
+	return NAN;
+}
+
+
+/***************************************************
+GET_ARR
+Read the saved array element k in a time step
+***************************************************/
+double grave::get_arr( int time, int k )
+{
+	if ( arr_data == NULL || ! in_data( time ) )
+		return NAN;
+
+	return arr_data[ ( size_t ) data_pos( time ) * rows * cols + k ];
+}
+
+
+/***************************************************
+DATA_PTR
+Pointer to the saved data in every time step from
+start, expanded in the store if needed
+***************************************************/
+double *grave::data_ptr( void )
+{
+	int i, k, m, n, time;
+	double *vals, *arr_vals;
+
+	if ( data_step == 1 && data != NULL && data_size > end - start )
+		return data;
+
+	if ( data == NULL && data_flt == NULL && data_zip == NULL )
+		return NULL;
+
+	n = end - start + 1;
+	m = arr_data != NULL ? rows * cols : 0;
+
+	vals = ( double * ) cemetery.alloc( n * sizeof( double ) );
+	arr_vals = m > 0 ? ( double * ) cemetery.alloc( ( size_t ) n * m * sizeof( double ) ) : NULL;
+
+	if ( vals == NULL || ( m > 0 && arr_vals == NULL ) )
+		return NULL;
+
+	for ( time = start; time <= end; ++time )
+	{
+		i = time - start;
+		vals[ i ] = get_data( time );
+
+		for ( k = 0; k < m; ++k )
+			arr_vals[ ( size_t ) i * m + k ] = get_arr( time, k );
+	}
+
+	free_data( );
+
+	data = vals;
+	arr_data = arr_vals;
+	data_step = 1;
+	data_size = n;
+	in_store = true;
+
+	return data;
+}
+
+
+/***************************************************
+FREE_DATA
+Release the saved data not in the store
+***************************************************/
+void grave::free_data( void )
+{
+	if ( ! in_store )
+	{
+		free( data );
+		free( data_flt );
+		free( arr_data );
 	}
 
-	cemetery = last_cemetery = NULL;
+	delete data_zip;
+	data = arr_data = NULL;
+	data_flt = NULL;
+	data_zip = NULL;
 }
 
 
@@ -1942,7 +2859,7 @@ void object::delete_var( const char *lab )
 
 	if ( ! strcmp( v->label, lab ) )
 	{	// first variable in the chain
-		v_map.erase( lab );
+		map_var( lab, NULL );
 		cv = v->next;
 		v->empty( );
 		delete v;
@@ -1952,7 +2869,7 @@ void object::delete_var( const char *lab )
 		for ( cv = v; cv->next != NULL; cv = cv->next)
 			if ( ! strcmp( cv->next->label, lab ) )
 			{
-				v_map.erase( lab );
+				map_var( lab, NULL );
 				cv1 = cv->next->next;
 				cv->next->empty( );
 				delete cv->next;
@@ -1983,18 +2900,14 @@ void object::chg_lab( const char *lab )
 
 	cb = up->search_bridge( label );
 
-	up->b_map.erase( cb->blabel );
+	up->map_bridge( cb->blabel, NULL );
 	delete [ ] cb->blabel;
 	cb->blabel = new char[ strlen( lab ) + 1 ];
 	strcpy( cb->blabel, lab );
-	up->b_map.insert( b_pairT ( lab, cb ) );
+	up->map_bridge( lab, cb );
 
 	for ( cur = this; cur != NULL; cur = cur->next )
-	{
-		delete [ ] cur->label;
-		cur->label = new char[ strlen( lab ) + 1 ];
-		strcpy( cur->label, lab );
-	}
+		cur->set_layout( lab );
 }
 
 
@@ -2009,11 +2922,11 @@ void object::chg_var_lab( const char *old, const char *newname )
 	for ( cv = v; cv != NULL; cv = cv->next)
 		if ( ! strcmp( cv->label, old ) )
 		{
-			v_map.erase( old );
+			map_var( old, NULL );
 			delete [ ] cv->label;
 			cv->label = new char[ strlen( newname ) + 1 ];
 			strcpy( cv->label, newname );
-			v_map.insert( v_pairT ( newname, cv ) );
+			map_var( newname, cv );
 			break;
 		}
 }
@@ -2110,6 +3023,92 @@ double object::cal( const char *lab, int lag )
 }
 
 
+/****************************************************
+CAL_ARR (*)
+Return the array of Variable or Parameter with label lab with lag lag,
+optionally providing its dimensions. Arrays are stored contiguously in
+column-major order.
+***************************************************/
+double *object::cal_arr( object *caller, const char *lab, int lag, int *rows, int *cols )
+{
+	variable *cv;
+
+	if ( rows != NULL )
+		*rows = 0;
+	if ( cols != NULL )
+		*cols = 0;
+
+	cv = search_var_err( this, lab, no_search, false, "retrieving array" );
+	if ( cv == NULL )
+		return NULL;
+
+	if ( rows != NULL )
+		*rows = cv->rows;
+	if ( cols != NULL )
+		*cols = cv->cols;
+
+#ifndef _NP_
+	if ( lag == 0 && parallel_ready && cv->parallel && cv->last_update < t && ! cv->dummy )
+		parallel_update( cv, this, caller );
+#endif
+	return cv->cal_arr( caller, lag );
+}
+
+
+/****************************************************
+ARR_DIM (*)
+Return the number of rows (or columns) of the array of Variable or
+Parameter with label lab, zero if not an array
+***************************************************/
+double object::arr_dim( const char *lab, bool cols )
+{
+	variable *cv;
+
+	cv = search_var_err( this, lab, no_search, false, "retrieving array dimensions" );
+	if ( cv == NULL )
+		return NAN;
+
+	return cols ? cv->cols : cv->rows;
+}
+
+
+/****************************************************
+SET_DIM (*)
+Change the dimensions of the array of Variable or Parameter with label
+lab, keeping the values in the overlapping positions. Zero dimensions
+make the element scalar. Saved elements cannot be changed during a run
+****************************************************/
+double object::set_dim( const char *lab, int rows, int cols )
+{
+	variable *cv;
+
+	cv = search_var_err( this, lab, no_search, false, "dimensioning array" );
+	if ( cv == NULL )
+		return NAN;
+
+	if ( rows == cv->rows && cols == cv->cols )
+		return rows * cols;
+
+	if ( running && ( cv->save || cv->savei ) )
+	{
+		error_hard( "invalid array dimensioning",
+					"check your code to prevent this situation or\ndon't save the element",
+					true,
+					"cannot change dimensions of saved element '%s' (object '%s')", lab, label );
+		return NAN;
+	}
+
+#ifndef _NP_
+	// prevent concurrent use by more than one thread
+	rec_lguardT lock( cv->parallel_comp );
+#endif
+
+	cv->set_dim( rows, cols );
+
+	return cv->rows * cv->cols;
+}
+
+
 /****************************************************
 LAST_CAL (*)
 Return the last time the variable was calculated
@@ -2133,7 +3132,7 @@ forcing recalculation if already calculated
 ****************************************************/
 double object::recal( const char *lab )
 {
-	int i;
+	int i, j, n;
 	double app;
 	variable *cv;
 
@@ -2150,11 +3149,23 @@ double object::recal( const char *lab )
 	for ( i = 0; i < cv->num_lag; ++i )		// scale up the past values
 		cv->val[ i ] = cv->val[ i + 1 ];
 
-	if ( ( cv->save || cv->savei ) && i + 1 <= t - cv->start )
-		cv->val[ i ] = cv->data[ t - i - 1 - cv->start ];
+	if ( ( cv->save || cv->savei ) && cv->in_data( t - i - 1 ) )
+		cv->val[ i ] = cv->get_data( t - i - 1 );
 	else
 		cv->val[ i ] = NAN;
 
+	if ( cv->arr != NULL )					// scale up the past arrays
+	{
+		n = cv->rows * cv->cols;
+		memmove( cv->arr, cv->arr + n, i * n * sizeof( double ) );
+
+		if ( cv->arr_data != NULL && cv->in_data( t - i - 1 ) )
+			memcpy( cv->arr + i * n, cv->arr_data + cv->data_pos( t - i - 1 ) * n, n * sizeof( double ) );
+		else
+			for ( j = 0; j < n; ++j )
+				cv->arr[ i * n + j ] = NAN;
+	}
+
 	cv->last_update = t - 1;
 	cv->next_update = t;
 
@@ -2171,8 +3182,8 @@ The sum is computed over the elements in a single branch of the model.
 ****************************************************/
 double object::sum( const char *lab1, int lag, bool cond, const char *lab2, const char *lop, double value )
 {
-	int n, lopc;
-	double tot;
+	int i, n, lopc, stride;
+	double tot, *col;
 	object *cur, *cnext;
 	variable *cv;
 
@@ -2189,6 +3200,15 @@ double object::sum( const char *lab1, int lag, bool cond, const char *lab2, cons
 	else
 		lopc = -1;
 
+	// parameters packed in columns don't require computation
+	if ( ! cond && cv->param == 1 && lag <= 1 && quit != 2 && ( col = column( cv, &n, &stride ) ) != NULL )
+	{
+		for ( tot = 0, i = 0; i < n; ++i )
+			tot += col[ i * stride ];
+
+		return tot;
+	}
+
 	cur = cv->up;
 	if ( cur->up != NULL )
 		cur = ( cur->up )->search( cur->label );
@@ -2217,8 +3237,8 @@ is true before considering each instance of the object.
 ****************************************************/
 double object::overall_max( const char *lab1, int lag, bool cond, const char *lab2, const char *lop, double value )
 {
-	int n, lopc;
-	double tot, temp;
+	int i, n, lopc, stride;
+	double tot, temp, *col;
 	object *cur, *cnext;
 	variable *cv;
 
@@ -2235,6 +3255,16 @@ double object::overall_max( const char *lab1, int lag, bool cond, const char *la
 	else
 		lopc = -1;
 
+	// parameters packed in columns don't require computation
+	if ( ! cond && cv->param == 1 && lag <= 1 && quit != 2 && ( col = column( cv, &n, &stride ) ) != NULL )
+	{
+		for ( tot = -DBL_MAX, i = 0; i < n; ++i )
+			if ( tot < col[ i * stride ] )
+				tot = col[ i * stride ];
+
+		return tot;
+	}
+
 	cur = cv->up;
 	if ( cur->up != NULL )
 		cur = ( cur->up )->search( cur->label );
@@ -2267,8 +3297,8 @@ is true before considering each instance of the object.
 ****************************************************/
 double object::overall_min( const char *lab1, int lag, bool cond, const char *lab2, const char *lop, double value )
 {
-	int n, lopc;
-	double tot, temp;
+	int i, n, lopc, stride;
+	double tot, temp, *col;
 	object *cur, *cnext;
 	variable *cv;
 
@@ -2285,6 +3315,16 @@ double object::overall_min( const char *lab1, int lag, bool cond, const char *la
 	else
 		lopc = -1;
 
+	// parameters packed in columns don't require computation
+	if ( ! cond && cv->param == 1 && lag <= 1 && quit != 2 && ( col = column( cv, &n, &stride ) ) != NULL )
+	{
+		for ( tot = DBL_MAX, i = 0; i < n; ++i )
+			if ( tot > col[ i * stride ] )
+				tot = col[ i * stride ];
+
+		return tot;
+	}
+
 	cur = cv->up;
 	if ( cur->up != NULL )
 		cur = ( cur->up )->search( cur->label );
@@ -2316,8 +3356,8 @@ is true before considering each instance of the object.
 ****************************************************/
 double object::av( const char *lab1, int lag, bool cond, const char *lab2, const char *lop, double value )
 {
-	int n, lopc;
-	double tot;
+	int i, n, lopc, stride;
+	double tot, *col;
 	object *cur, *cnext;
 	variable *cv;
 
@@ -2334,6 +3374,15 @@ double object::av( const char *lab1, int lag, bool cond, const char *lab2, const
 	else
 		lopc = -1;
 
+	// parameters packed in columns don't require computation
+	if ( ! cond && cv->param == 1 && lag <= 1 && quit != 2 && ( col = column( cv, &n, &stride ) ) != NULL )
+	{
+		for ( tot = 0, i = 0; i < n; ++i )
+			tot += col[ i * stride ];
+
+		return tot / n;
+	}
+
 	cur = cv->up;
 	if ( cur->up != NULL )
 		cur = ( cur->up )->search( cur->label );
@@ -2821,10 +3870,11 @@ object *object::lsdqsort( const char *obj, const char *var, const char *directio
 
 #ifndef _NP_
 	// prevent concurrent sorting by more than one thread
-	lock_guard < mutex > lock( parallel_comp );
+	obj_lguardT lock( parallel_comp );
 #endif
 
 	cb->counter_updated = false;
+	cb->col_num = 0;
 	cur = cb->head;
 
 	skip_next_obj( cur, &num );
@@ -2964,10 +4014,11 @@ object *object::lsdqsort( const char *obj, const char *var1, const char *var2, c
 
 #ifndef _NP_
 	// prevent concurrent sorting by more than one thread
-	lock_guard < mutex > lock( parallel_comp );
+	obj_lguardT lock( parallel_comp );
 #endif
 
 	cb->counter_updated = false;
+	cb->col_num = 0;
 	cur = cb->head;
 
 	skip_next_obj( cur, &num );
@@ -3239,7 +4290,7 @@ double object::write( const char *lab, double value, int time, int lag )
 		cv->last_update = 0;	// force new updating
 
 		if ( time == -1 && ( cv->save || cv->savei ) )
-			cv->data[ 0 ] = value;
+			cv->set_data( cv->start, value );
 
 		// choose next update step for special updating variables
 		if ( cv->delay > 0 || cv->delay_range > 0 )
@@ -3269,9 +4320,14 @@ double object::write( const char *lab, double value, int time, int lag )
 		{
 			// if not yet calculated this time step, adjust lagged values
 			if ( time >= t && lag == 0 && cv->last_update < t )
+			{
 				for ( i = 0; i < cv->num_lag; ++i )
 					cv->val[ cv->num_lag - i ] = cv->val[ cv->num_lag - i - 1 ];
 
+				if ( cv->arr != NULL )
+					cv->shift_arr( cv->arr );
+			}
+
 			if ( lag == 0 )
 			{
 				eff_lag = 0;
@@ -3315,12 +4371,13 @@ double object::write( const char *lab, double value, int time, int lag )
 
 		if ( cv->save || cv->savei )
 		{
-			if ( eff_time >= cv->start && eff_time <= cv->end )
-				cv->data[ eff_time - cv->start ] = value;
+			// future values are saved when updated and streamed ones cannot change
+			if ( eff_time >= cv->start && eff_time <= min( cv->end, t ) && eff_time > stream_done )
+				cv->set_data( eff_time, value );
 			else
 				// handle special initial case
 				if ( time == 0 && cv->start == 0 )
-					cv->data[ 0 ] = value;
+					cv->set_data( 0, value );
 		}
 	}
 
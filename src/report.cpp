@@ -741,7 +741,7 @@ void write_var( variable *v, FILE *frep )
 
 						fprintf( frep, "</TT>\n" );
 
-						if ( ! strncmp( c3_lab, "RESULT(", 7 ) && macro )
+						if ( ( ! strncmp( c3_lab, "RESULT(", 7 ) || ! strncmp( c3_lab, "RESULT_VECTOR", 13 ) ) && macro )
 							done = 0; 		// force it to stop
 					}
 
@@ -895,7 +895,7 @@ bool contains( FILE *f, const char *lab, int len )
 		strcpyn( pot, c1_lab, MAX_LINE_SIZE );
 		clean_spaces( pot );
 
-		if ( ! strncmp( pot, "RESULT(", 7 ) )
+		if ( ! strncmp( pot, "RESULT(", 7 ) || ! strncmp( pot, "RESULT_VECTOR", 13 ) )
 			bra--;
 
 		for ( i = 0; c1_lab[ i ] != 0; ++i ) // scans each character
@@ -1426,7 +1426,7 @@ bool is_equation_header( const char *raw_line, char *var, char *updt_in )
 	strcpy( line, raw_line );
 	clean_spaces( line );
 
-	if ( ! strncmp( line, "if(!strcmp(label,", 17 ) || ! strncmp( line, "EQUATION(", 9 ) || ! strncmp( line, "EQUATION_DUMMY(", 9 ) || ! strncmp( line, "FUNCTION(", 9 ) )
+	if ( ! strncmp( line, "if(!strcmp(label,", 17 ) || ! strncmp( line, "EQUATION(", 9 ) || ! strncmp( line, "EQUATION_DUMMY(", 9 ) || ! strncmp( line, "EQUATION_VECTOR(", 16 ) || ! strncmp( line, "FUNCTION(", 9 ) )
 	{
 		header = true;
 
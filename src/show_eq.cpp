@@ -231,7 +231,7 @@ void show_eq( const char *lab, const char *parWnd )
 			break;
 		}
 
-		if ( ! strncmp( c2_lab,"RESULT(", 7 ) )
+		if ( ! strncmp( c2_lab,"RESULT(", 7 ) || ! strncmp( c2_lab, "RESULT_VECTOR", 13 ) )
 			bra--;
 
 		for ( i = 0; c1_lab[ i ] != 0; ++i )
@@ -417,7 +417,7 @@ void scan_used_lab( const char *lab, const char *parWnd )
 
 				c2_lab[ i ] = '\0';				// close the string
 
-				if ( ! strcmp( c2_lab, "if(!strcmp(label," ) || ! strcmp( c2_lab, "EQUATION(" ) || ! strcmp( c2_lab, "EQUATION_DUMMY(" ) || ! strcmp( c2_lab, "FUNCTION(" ) )
+				if ( ! strcmp( c2_lab, "if(!strcmp(label," ) || ! strcmp( c2_lab, "EQUATION(" ) || ! strcmp( c2_lab, "EQUATION_DUMMY(" ) || ! strcmp( c2_lab, "EQUATION_VECTOR(" ) || ! strcmp( c2_lab, "FUNCTION(" ) )
 				{
 					if ( ! strcmp( c2_lab, "if(!strcmp(label," ) )
 						macro = false;
@@ -348,6 +348,7 @@ void error_hard( const char *boxTitle, const char *boxText, bool defQuit, const
 		user_exception = false;
 
 		reset_end( root );
+		single_close( );				// write individually saved series
 		root->emptyturbo( );
 		uncover_browser( );
 
@@ -602,6 +603,19 @@ void set_lab_tit( variable *var )
 }
 
 
+/***************************************************
+SINGLE_LAB_TIT
+Check if the object containing the variable is the
+only instance of its type, so the lab_tit suffix is
+not added to the .csv column names (lab_tit must be
+already written)
+***************************************************/
+bool single_lab_tit( variable *var )
+{
+	return ( ! strcmp( var->lab_tit, "1" ) || ! strcmp( var->lab_tit, "1_1" ) || ! strcmp( var->lab_tit, "1_1_1" ) || ! strcmp( var->lab_tit, "1_1_1_1" ) ) && var->up->hyper_next( ) == NULL;
+}
+
+
 /*****************************************************************************
 SET_BLUEPRINT
 copy the naked structure of the model into another object, called blueprint,
@@ -619,10 +633,7 @@ void set_blueprint( object *container, object *r )
 	for ( cv = r->v; cv != NULL; cv = cv->next )
 		container->add_var_from_example( cv );
 
-	delete [ ] container->label;
-
-	container->label = new char[ strlen( r->label ) + 1 ];
-	strcpy( container->label, r->label );
+	container->set_layout( r->label );
 
 	for ( cb = r->b; cb != NULL; cb = cb->next )
 	{
@@ -1116,6 +1127,12 @@ void get_var_descr( const char *lab, char *desc, int descr_len )
 		f = search_all_sources( str );
 	}
 
+	if ( f == NULL )
+	{
+		snprintf( str, 2 * MAX_ELEM_LENGTH, "EQUATION_VECTOR(\"%s\")", lab );
+		f = search_all_sources( str );
+	}
+
 	if ( f == NULL )
 	{
 		snprintf( str, 2 * MAX_ELEM_LENGTH, "FUNCTION(\"%s\")", lab );
@@ -2209,6 +2226,40 @@ void *set_random( int gen )
 }
 
 
+/***************************************************
+GET_RANDOM_STATE
+Return the state of all the generators as text,
+to be restored by set_random_state
+***************************************************/
+string get_random_state( void )
+{
+	ostringstream state;
+
+	state << ran_gen_id << ' ' << idum << ' ' << lc1 << ' ' << lc2 << ' ' << mt32 << ' ' << mt64 << ' ' << lf24 << ' ' << lf48;
+
+	return state.str( );
+}
+
+
+/***************************************************
+SET_RANDOM_STATE
+Restore the state of all the generators from text
+***************************************************/
+bool set_random_state( const string &state )
+{
+	int gen;
+	istringstream in( state );
+
+	// generators read their state without skipping the separators
+	in >> gen >> idum >> ws >> lc1 >> ws >> lc2 >> ws >> mt32 >> ws >> mt64 >> ws >> lf24 >> ws >> lf48;
+
+	if ( in.fail( ) || set_random( gen ) == NULL )
+		return false;
+
+	return true;
+}
+
+
 /****************************************************
 RND_INT
 ****************************************************/
@@ -49,9 +49,23 @@ at time last_update - 1; val[2] at time last_update - 2 and so on.
 - int num_lag;
 number of lagged values stored for the variable
 
+- double *arr;
+array (or matrix) values for array elements, NULL otherwise. Holds num_lag + 2
+contiguous blocks of rows x cols values in column-major order: block 0 is the
+current array, block i the lag i array and the last block is the output
+buffer written by the equation, which is shifted into block 0 after computing.
+
 - int save;
 flag identifying whether the variable has to be saved or not in the result file
 
+- int save_fmt;
+storage of the saved values: double precision (0), single precision (SAVE_FLT),
+compressed in blocks (SAVE_ZIP) or both, accessed using get_data/set_data
+
+- int save_every, save_from, save_to, save_last;
+saving policy: save just every save_every time steps, from step save_from (0=first)
+to step save_to (0=last), keeping only the last save_last saved values (0=all)
+
 - int plot;
 Flag used to indicate variables that are plotted in the run time graph.
 
@@ -134,6 +148,9 @@ constructor
 variable::variable( void )
 {
 	dummy = false;
+	in_arena = false;
+	in_column = false;
+	in_map = false;
 	observe = false;
 	parallel = false;
 	plot = false;
@@ -144,16 +161,32 @@ variable::variable( void )
 	label = NULL;
 	data_loaded = '-';
 	debug = 'n';
+	arr = NULL;
+	arr_data = NULL;
 	data = NULL;
+	data_flt = NULL;
+	data_zip = NULL;
 	val = NULL;
 	deb_cnd_val = 0;
 	deb_cond = 0;
+	cols = 0;
+	data_size = 0;
+	data_step = 1;
 	end = 0;
 	last_update = 0;
 	next_update = 0;
 	num_lag = 0;
 	param = 0;
+	rows = 0;
+	save_every = 1;
+	save_fmt = 0;
+	save_from = 0;
+	save_last = 0;
+	save_to = 0;
+	serial = 0;
 	start = 0;
+	vec_time = -1;
+	vec_res = 0;
 	delay = 0;
 	delay_range = 0;
 	period = 1;
@@ -171,6 +204,9 @@ copy constructor
 variable::variable( const variable &v )
 {
 	dummy = v.dummy;
+	in_arena = v.in_arena;
+	in_column = v.in_column;
+	in_map = v.in_map;
 	observe = v.observe;
 	parallel = v.parallel;
 	plot = v.plot;
@@ -181,16 +217,32 @@ variable::variable( const variable &v )
 	label = v.label;
 	data_loaded = v.data_loaded;
 	debug = v.debug;
+	arr = v.arr;
+	arr_data = v.arr_data;
 	data = v.data;
+	data_flt = v.data_flt;
+	data_zip = v.data_zip;
 	val = v.val;
 	deb_cnd_val = v.deb_cnd_val;
 	deb_cond = v.deb_cond;
+	cols = v.cols;
+	data_size = v.data_size;
+	data_step = v.data_step;
 	end = v.end;
 	last_update = v.last_update;
 	next_update = v.next_update;
 	num_lag = v.num_lag;
 	param = v.param;
+	rows = v.rows;
+	save_every = v.save_every;
+	save_fmt = v.save_fmt;
+	save_from = v.save_from;
+	save_last = v.save_last;
+	save_to = v.save_to;
+	serial = v.serial;
 	start = v.start;
+	vec_time = v.vec_time;
+	vec_res = v.vec_res;
 	delay = v.delay;
 	delay_range = v.delay_range;
 	period = v.period;
@@ -258,9 +310,11 @@ void variable::empty( bool no_lock )
 	}
 
 	delete [ ] label;
-	delete [ ] val;
+	if ( ! in_column && ! in_arena )	// columns/arenas own their values
+		delete [ ] val;
 	delete [ ] lab_tit;
-	free( data );		// use C stdlib to be able to deallocate memory for deleted objects
+	delete [ ] arr;
+	free_data( );
 }
 
 
@@ -305,10 +359,10 @@ double variable::cal( object *caller, int lag )
 				if ( no_saved || ! ( save || savei ) )	// and not saved
 					goto error;
 				else
-					if ( lag > t - start )	// or before there are saved values
+					if ( ! in_data( t - lag ) )	// or not saved (anymore)
 						goto error;
 
-				return data[ t - lag - start ];	// use saved past value
+				return get_data( t - lag );	// use saved past value
 			}
 			else
 				return val[ eff_lag ];	// use regular past value
@@ -401,6 +455,9 @@ double variable::cal( object *caller, int lag )
 #endif
 
 	// Compute the Variable's equation
+	if ( arr != NULL )				// array output starts from the last array
+		memcpy( arr_out( ), arr, rows * cols * sizeof( double ) );
+
 	user_exception = true;			// allow distinguishing among internal & user exceptions
 	try								// do it while catching exceptions to avoid obscure aborts
 	{
@@ -437,6 +494,9 @@ double variable::cal( object *caller, int lag )
 
 	val[ 0 ] = app;
 
+	if ( arr != NULL )
+		shift_arr( arr_out( ) );
+
 	last_update = t;
 
 	// choose next update step for special updating variables
@@ -563,6 +623,488 @@ double variable::cal( object *caller, int lag )
 }
 
 
+/***************************************************
+FUN_VEC
+Compute a vector equation. The kernel computes
+the variable for all the instances of the object
+still to be updated in the time step at once, and
+the results for the other instances are kept
+pending until each one is requested by cal().
+Note that any variable used by the kernel is
+updated for all the instances on the first call,
+changing the update and random draw order from
+per-instance equations.
+Falls back to computing only this instance when
+running in parallel mode or for functions.
+****************************************************/
+double variable::fun_vec( object *caller, eq_vec_funcT kernel )
+{
+	bool batch;
+	int i, me;
+	bridge *cb;
+	object *cur;
+	variable *cv = NULL;
+	eq_vec vec;
+	vector < double > res;
+	vector < object * > obj;
+	vector < variable * > vars;
+
+	if ( vec_time == t )				// already computed by another instance
+	{
+		vec_time = -1;
+		return vec_res;
+	}
+
+	// collect the instances still to be computed in this time step
+	cb = ( up->up != NULL ) ? up->up->lookup_bridge( up->label ) : NULL;
+	batch = ( cb != NULL && ! parallel_mode && param == 0 );
+
+	for ( me = -1, i = 0, cur = batch ? cb->head : up; cur != NULL; cur = batch ? cur->next : NULL, ++i )
+	{
+		if ( cur == up )
+			me = obj.size( );
+		else
+		{
+			cv = cur->lookup_var( label );
+			if ( cv == NULL || cv->last_update >= t || t < cv->next_update ||
+				 cv->under_computation || cv->vec_time == t )
+				continue;
+		}
+
+		obj.push_back( cur );
+		vars.push_back( cur == up ? this : cv );
+	}
+
+	if ( me < 0 )
+	{
+		error_hard( "internal problem in LSD",
+					"if error persists, please contact developers",
+					true,
+					"invalid data structure (instance of '%s' not found)", up->label );
+		return NAN;
+	}
+
+	res.resize( obj.size( ), NAN );		// kernel must set all results
+	vec.full = ( ( int ) obj.size( ) == i );
+	vec.n = obj.size( );
+	vec.res = res.data( );
+	vec.obj = obj.data( );
+	vec.caller = caller;
+
+	kernel( vec );
+
+	for ( i = 0; i < vec.n; ++i )
+		if ( i != me )
+		{
+			vars[ i ]->vec_res = res[ i ];
+			vars[ i ]->vec_time = t;
+		}
+
+	return res[ me ];
+}
+
+
+/***************************************************
+EQ_VEC::IN
+Return the values of the element lab for all the
+instances in a vector equation, computing them if
+required. Parameters packed in columns are used
+directly when all instances are being computed.
+****************************************************/
+const double *eq_vec::in( const char *lab, int lag )
+{
+	int i, num, stride;
+	double *col;
+	variable *cv;
+
+	if ( full && ( cv = obj[ 0 ]->lookup_var( lab ) ) != NULL && cv->param == 1 && lag <= 1 &&
+		 ( col = column( cv, &num, &stride ) ) != NULL && num == n && stride == 1 )
+		return col;
+
+	vals.push_back( vector < double > ( n ) );
+
+	for ( i = 0; i < n; ++i )
+		vals.back( )[ i ] = obj[ i ]->cal( obj[ i ], lab, lag );
+
+	return vals.back( ).data( );
+}
+
+
+
+/***************************************************
+CAL_ARR
+Return the array of the element with lag lag, in
+the same way cal() does for its value, computing it
+if required.
+****************************************************/
+double *variable::cal_arr( object *caller, int lag )
+{
+	int eff_lag, n;
+
+	if ( arr == NULL )
+		return arr_out( );				// report error
+
+	cal( caller, lag );					// compute or check lag, if required
+
+	if ( quit == 2 || param == 1 || lag == 0 )
+		return arr;
+
+	n = rows * cols;
+
+	if ( param == 2 )
+		return arr + ( lag - 1 ) * n;
+
+	eff_lag = ( last_update < t ) ? lag - 1 : lag;
+
+	if ( eff_lag <= num_lag )
+		return arr + eff_lag * n;
+
+	return arr_data + data_pos( t - lag ) * n;	// use saved past array
+}
+
+
+/***************************************************
+ARR_OUT
+Return the array output buffer to be written by the
+element equation.
+****************************************************/
+double *variable::arr_out( void )
+{
+	if ( arr == NULL )
+	{
+		error_hard( "invalid array access",
+					"check the element dimensions in the model configuration",
+					true,
+					"element '%s' (object '%s') is not an array", label, up->label );
+		return NULL;
+	}
+
+	return arr + ( num_lag + 1 ) * rows * cols;
+}
+
+
+/***************************************************
+SHIFT_ARR
+Shift the past arrays one lag and set the current
+one from cur.
+****************************************************/
+void variable::shift_arr( const double *cur )
+{
+	int n = rows * cols;
+
+	memmove( arr + n, arr, num_lag * n * sizeof( double ) );
+
+	if ( cur != arr )
+		memcpy( arr, cur, n * sizeof( double ) );
+}
+
+
+/***************************************************
+SAVE_ARR
+Store the current array in the saved data at time.
+****************************************************/
+void variable::save_arr( int time )
+{
+	int n = rows * cols;
+
+	if ( arr != NULL && arr_data != NULL && in_data( time ) )
+		memcpy( arr_data + data_pos( time ) * n, arr, n * sizeof( double ) );
+}
+
+
+/***************************************************
+DATA_POS
+Return the position of the saved value at time in
+data, which holds the values every data_step time
+steps and is a circular buffer when streaming the
+results or keeping only the last values, holding
+just the last data_size saved steps.
+****************************************************/
+int variable::data_pos( int time )
+{
+	int pos = data_step > 1 ? ( time - start ) / data_step : time - start;
+
+	return pos < data_size ? pos : pos % data_size;
+}
+
+
+/***************************************************
+IN_DATA
+Check if the value at time is in the saved data:
+inside the saved period, in a saved time step and
+not yet overwritten in the circular buffer, if so
+****************************************************/
+bool variable::in_data( int time )
+{
+	if ( time < start || time > end || ( data_step > 1 && ( time - start ) % data_step != 0 ) )
+		return false;
+
+	return ( end - start ) / data_step < data_size || time > t - data_size * data_step;
+}
+
+
+/***************************************************
+DATA_ALLOC
+Allocate saved data storage in the spill file or
+in the heap
+****************************************************/
+static void *data_alloc( bool map, size_t size )
+{
+	// use C stdlib to be able to deallocate memory for deleted objects
+	return map ? spill_map->alloc( size ) : malloc( size );
+}
+
+
+/***************************************************
+ALLOC_DATA
+Allocate the storage for data_size saved values,
+in the format fmt (SAVE_FLT and SAVE_ZIP flags),
+and for the saved array values, if any. If there
+is a spill file, uncompressed values are stored
+in it and are only released with the file
+****************************************************/
+bool variable::alloc_data( int fmt )
+{
+	size_t n = ( size_t ) data_size * ( arr != NULL ? rows * cols : 0 );
+
+	in_map = spill_map != NULL;
+
+	if ( fmt & SAVE_ZIP )
+		data_zip = new ( nothrow ) save_zip( data_size, fmt & SAVE_FLT );
+	else
+		if ( fmt & SAVE_FLT )
+			data_flt = ( float * ) data_alloc( in_map, data_size * sizeof( float ) );
+		else
+			data = ( double * ) data_alloc( in_map, data_size * sizeof( double ) );
+
+	if ( n > 0 )
+		arr_data = ( double * ) data_alloc( in_map, n * sizeof( double ) );
+
+	return ( data != NULL || data_flt != NULL || data_zip != NULL ) && ( n == 0 || arr_data != NULL );
+}
+
+
+/***************************************************
+FREE_DATA
+Release the saved values, in any format
+****************************************************/
+void variable::free_data( void )
+{
+	if ( ! in_map )				// spill file space is not reused
+	{
+		free( data );
+		free( data_flt );
+		free( arr_data );
+	}
+
+	delete data_zip;
+
+	data = arr_data = NULL;
+	data_flt = NULL;
+	data_zip = NULL;
+	in_map = false;
+}
+
+
+/***************************************************
+GET_DATA
+Return the saved value at time, in any format,
+or NaN if not saved
+****************************************************/
+double variable::get_data( int time )
+{
+	if ( ! in_data( time ) )
+		return NAN;
+
+	if ( data != NULL )
+		return data[ data_pos( time ) ];
+
+	if ( data_flt != NULL )
+		return data_flt[ data_pos( time ) ];
+
+	if ( data_zip != NULL )
+		return data_zip->get( data_pos( time ) );
+
+	return NAN;
+}
+
+
+/***************************************************
+SET_DATA
+Store the saved value at time, in any format,
+if time is saved
+****************************************************/
+void variable::set_data( int time, double value )
+{
+	if ( ! in_data( time ) )
+		return;
+
+	if ( data != NULL )
+		data[ data_pos( time ) ] = value;
+	else
+		if ( data_flt != NULL )
+			data_flt[ data_pos( time ) ] = value;
+		else
+			if ( data_zip != NULL )
+				data_zip->set( data_pos( time ), value );
+}
+
+
+/***************************************************
+DATA_PTR
+Return the saved values as a plain double vector
+of all time steps, expanding single precision,
+compressed or interval storage (NaN if not saved)
+****************************************************/
+double *variable::data_ptr( void )
+{
+	int i, m, n, time;
+	double *vals, *arr_vals;
+
+	if ( data_step == 1 && ( data != NULL || ( data_flt == NULL && data_zip == NULL ) ) )
+		return data;
+
+	// the same time span, if a circular buffer
+	n = data_size * data_step;
+	m = arr_data != NULL && data_step > 1 ? rows * cols : 0;
+
+	vals = ( double * ) data_alloc( in_map, n * sizeof( double ) );
+	arr_vals = m > 0 ? ( double * ) data_alloc( in_map, ( size_t ) n * m * sizeof( double ) ) : NULL;
+
+	if ( vals == NULL || ( m > 0 && arr_vals == NULL ) )
+	{
+		if ( ! in_map )
+		{
+			free( vals );
+			free( arr_vals );
+		}
+
+		return NULL;
+	}
+
+	fill( vals, vals + n, NAN );
+	fill( arr_vals, arr_vals + ( size_t ) n * m, NAN );
+
+	for ( time = start; time <= end; time += data_step )
+		if ( in_data( time ) )
+		{
+			i = ( time - start ) % n;
+			vals[ i ] = get_data( time );
+
+			if ( m > 0 )
+				memcpy( arr_vals + i * m, arr_data + data_pos( time ) * m, m * sizeof( double ) );
+		}
+
+	if ( ! in_map )
+	{
+		free( data );
+		free( data_flt );
+
+		if ( m > 0 )
+			free( arr_data );
+	}
+
+	if ( m > 0 )
+		arr_data = arr_vals;
+
+	delete data_zip;
+	data_flt = NULL;
+	data_zip = NULL;
+	data_step = 1;
+	data_size = n;
+
+	return data = vals;
+}
+
+
+/***************************************************
+TRIM_DATA
+Release the saved data storage beyond the series
+end and, if just the last values were kept in the
+circular buffer, rearrange them in time order
+****************************************************/
+void variable::trim_data( void )
+{
+	int k, m, n = max( ( end - start ) / data_step + 1, 1 );
+
+	if ( n > data_size )		// circular buffer, oldest value first
+	{
+		k = ( n - data_size ) % data_size;
+		m = rows * cols;
+
+		if ( data != NULL )
+			rotate( data, data + k, data + data_size );
+
+		if ( data_flt != NULL )
+			rotate( data_flt, data_flt + k, data_flt + data_size );
+
+		if ( arr_data != NULL )
+			rotate( arr_data, arr_data + k * m, arr_data + data_size * m );
+
+		start += ( n - data_size ) * data_step;
+		return;
+	}
+
+	data_size = n;
+
+	if ( data_zip != NULL )
+		data_zip->shrink( );
+
+	if ( in_map )				// spill file space cannot shrink
+		return;
+
+	// use C stdlib to be able to deallocate memory for deleted objects
+	if ( data != NULL )
+		data = ( double * ) realloc( data, data_size * sizeof( double ) );
+
+	if ( data_flt != NULL )
+		data_flt = ( float * ) realloc( data_flt, data_size * sizeof( float ) );
+
+	if ( arr_data != NULL )
+		arr_data = ( double * ) realloc( arr_data, data_size * rows * cols * sizeof( double ) );
+}
+
+
+/***************************************************
+SET_DIM
+(Re)dimension the element array for _num_lag lags,
+keeping the existing values in the overlapping
+positions. Zero dimensions make the element scalar.
+****************************************************/
+void variable::set_dim( int _rows, int _cols, int _num_lag )
+{
+	int i, j, k, n, old_n;
+	double *old_arr = arr;
+
+	if ( _rows <= 0 || _cols <= 0 )
+	{
+		delete [ ] arr;
+		if ( ! in_map )
+			free( arr_data );
+		arr = arr_data = NULL;
+		rows = cols = 0;
+		return;
+	}
+
+	_num_lag = max( _num_lag < 0 ? num_lag : _num_lag, 0 );
+	n = _rows * _cols;
+	old_n = rows * cols;
+
+	arr = new double[ ( _num_lag + 2 ) * n ];
+	for ( i = 0; i < ( _num_lag + 2 ) * n; ++i )
+		arr[ i ] = 0;
+
+	if ( old_arr != NULL )
+		for ( k = 0; k <= min( num_lag, _num_lag ); ++k )
+			for ( j = 0; j < min( cols, _cols ); ++j )
+				for ( i = 0; i < min( rows, _rows ); ++i )
+					arr[ k * n + j * _rows + i ] = old_arr[ k * old_n + j * rows + i ];
+
+	delete [ ] old_arr;
+	rows = _rows;
+	cols = _cols;
+}
+
 #ifndef _NP_
 /***************************************************
 CAL_WORKER
@@ -1088,3 +1630,190 @@ int worker_errors( void )
 
 #endif
 }
+
+
+/***************************************************
+SAVE_ZIP
+Saved data compressed in blocks of SAVE_BLOCK values:
+each value is XORed with the previous one and just
+the non-zero bytes in the middle are stored, after a
+byte with the number of leading (high nibble) and
+trailing (low nibble) zero bytes; the block being
+written is kept uncompressed, and the last read
+block is cached per thread
+****************************************************/
+static atomic < uint64_t > save_zip_ids( 0 );
+
+save_zip::save_zip( int _size, bool _flt )
+{
+	size = max( _size, 0 );
+	flt = _flt;
+	wblk = -1;
+	version = 0;
+	id = ++save_zip_ids;
+
+	// all blocks exist from start, so they never move
+	blks.resize( ( size + SAVE_BLOCK - 1 ) / SAVE_BLOCK );
+}
+
+double save_zip::get( int pos )
+{
+	static thread_local uint64_t c_id = 0;
+	static thread_local int c_blk, c_ver;
+	static thread_local double c_buf[ SAVE_BLOCK ];
+	int blk = pos / SAVE_BLOCK;
+
+	if ( pos < 0 || pos >= size )
+		return NAN;
+
+	if ( blk == wblk )
+		return wbuf[ pos - blk * SAVE_BLOCK ];
+
+	if ( c_id != id || c_blk != blk || c_ver != version )
+	{
+		unpack( blk, c_buf, min( SAVE_BLOCK, size - blk * SAVE_BLOCK ) );
+		c_id = id;
+		c_blk = blk;
+		c_ver = version;
+	}
+
+	return c_buf[ pos - blk * SAVE_BLOCK ];
+}
+
+void save_zip::set( int pos, double val )
+{
+	double vals[ SAVE_BLOCK ];
+	int blk = pos / SAVE_BLOCK, n = min( SAVE_BLOCK, size - blk * SAVE_BLOCK );
+
+	if ( pos < 0 || pos >= size )
+		return;
+
+	if ( flt )
+		val = ( float ) val;
+
+	if ( blk != wblk )
+	{
+		if ( blk < wblk )				// rewrite a past block
+		{
+			unpack( blk, vals, n );
+			vals[ pos - blk * SAVE_BLOCK ] = val;
+			pack( blk, vals, n );
+			return;
+		}
+
+		if ( wblk >= 0 )
+			pack( wblk, wbuf.data( ), min( SAVE_BLOCK, size - wblk * SAVE_BLOCK ) );
+
+		wbuf.resize( min( SAVE_BLOCK, size ) );
+		unpack( blk, wbuf.data( ), n );
+		wblk = blk;
+	}
+
+	wbuf[ pos - blk * SAVE_BLOCK ] = val;
+}
+
+void save_zip::shrink( void )
+{
+	if ( wblk >= 0 )
+		pack( wblk, wbuf.data( ), min( SAVE_BLOCK, size - wblk * SAVE_BLOCK ) );
+
+	wblk = -1;
+	vector < double > ( ).swap( wbuf );
+}
+
+void save_zip::pack( int blk, const double *vals, int n )
+{
+	int i, k, lz, tz;
+	float f;
+	uint64_t u, x, prev = 0;
+	string out;
+
+	out.reserve( 1 + n * sizeof( double ) );
+	out.push_back( 0 );					// XOR coded block
+
+	for ( i = 0; i < n; ++i, prev = u )
+	{
+		memcpy( & u, vals + i, sizeof( double ) );
+		x = u ^ prev;
+
+		if ( x == 0 )
+		{
+			out.push_back( ( char ) 0x80 );
+			continue;
+		}
+
+		for ( lz = 0; ( ( x >> ( 56 - 8 * lz ) ) & 0xFF ) == 0; ++lz );
+		for ( tz = 0; ( ( x >> ( 8 * tz ) ) & 0xFF ) == 0; ++tz );
+
+		out.push_back( ( char ) ( lz << 4 | tz ) );
+
+		for ( k = 7 - lz; k >= tz; --k )
+			out.push_back( ( char ) ( x >> ( 8 * k ) ) );
+	}
+
+	// store incompressible blocks as plain values
+	if ( flt && out.size( ) > 1 + n * sizeof( float ) )
+	{
+		out.assign( 1, ( char ) 2 );
+		for ( i = 0; i < n; ++i )
+		{
+			f = vals[ i ];
+			out.append( ( const char * ) & f, sizeof( float ) );
+		}
+	}
+	else
+		if ( out.size( ) > 1 + n * sizeof( double ) )
+		{
+			out.assign( 1, ( char ) 1 );
+			out.append( ( const char * ) vals, n * sizeof( double ) );
+		}
+
+	out.shrink_to_fit( );
+	blks[ blk ].swap( out );
+	++version;
+}
+
+void save_zip::unpack( int blk, double *vals, int n ) const
+{
+	int i, k, lz, tz;
+	float f;
+	uint64_t u = 0, x;
+	const unsigned char *p;
+
+	if ( blk >= ( int ) blks.size( ) || blks[ blk ].empty( ) )
+	{
+		for ( i = 0; i < n; ++i )
+			vals[ i ] = NAN;
+		return;
+	}
+
+	p = ( const unsigned char * ) blks[ blk ].data( );
+
+	switch ( *p++ )
+	{
+		case 1:
+			memcpy( vals, p, n * sizeof( double ) );
+			break;
+
+		case 2:
+			for ( i = 0; i < n; ++i, p += sizeof( float ) )
+			{
+				memcpy( & f, p, sizeof( float ) );
+				vals[ i ] = f;
+			}
+			break;
+
+		default:
+			for ( i = 0; i < n; ++i )
+			{
+				lz = *p >> 4;
+				tz = *p++ & 0x0F;
+
+				for ( x = 0, k = 7 - lz; k >= tz; --k )
+					x |= ( uint64_t ) *p++ << ( 8 * k );
+
+				u ^= x;
+				memcpy( vals + i, & u, sizeof( double ) );
+			}
+	}
+}